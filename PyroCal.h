@@ -0,0 +1,115 @@
+/*
+  YamuraLog Recording Tire Pyrometer
+  probe calibration (py_cal.txt) - correction curve per probe applied to every reading
+  plain C++, no Arduino dependencies - also builds on the host
+
+  a probe's curve is up to CAL_MAX_POINTS (raw, reference) pairs in degrees C, the correction
+  (reference - raw) is linear between points and held at the end values outside them
+  Cal_Build samples the curve into a table on a uniform raw temp grid once, so Cal_Apply is an
+  index and one interpolation per sample however many points the curve has
+  bends in the curve are rounded over one grid step (CAL_TABLE_STEP)
+*/
+#ifndef PYRO_CAL_H
+#define PYRO_CAL_H
+
+#include <stdint.h>
+
+#define CAL_MAX_POINTS   8                        // reference points per probe
+#define CAL_TABLE_MIN    -20.0f                   // degrees C, table range
+#define CAL_TABLE_MAX    300.0f
+#define CAL_TABLE_SIZE   129                      // entries, 2.5C steps
+#define CAL_TABLE_STEP   ((CAL_TABLE_MAX - CAL_TABLE_MIN) / (CAL_TABLE_SIZE - 1))
+
+// reference point, degrees C
+struct CalPoint
+{
+  float rawC;                                 // amplifier reading
+  float refC;                                 // reference temp
+};
+// precomputed correction table
+struct CalTable
+{
+  bool active;                                // false passes readings through
+  float offset[CAL_TABLE_SIZE];               // reference - raw at each grid temp
+};
+
+//
+// sort points by raw temp (insertion sort, a handful of points)
+//
+static inline void Cal_Sort(CalPoint* points, int count)
+{
+  for(int idx = 1; idx < count; idx++)
+  {
+    CalPoint point = points[idx];
+    int insertIdx = idx;
+    while((insertIdx > 0) && (points[insertIdx - 1].rawC > point.rawC))
+    {
+      points[insertIdx] = points[insertIdx - 1];
+      insertIdx--;
+    }
+    points[insertIdx] = point;
+  }
+}
+//
+// correction at rawC from sorted points, piecewise linear and held flat past the end points
+//
+static inline float Cal_Offset(const CalPoint* points, int count, float rawC)
+{
+  if(rawC <= points[0].rawC)
+  {
+    return points[0].refC - points[0].rawC;
+  }
+  for(int idx = 1; idx < count; idx++)
+  {
+    if(rawC <= points[idx].rawC)
+    {
+      float span = points[idx].rawC - points[idx - 1].rawC;
+      float lowOffset = points[idx - 1].refC - points[idx - 1].rawC;
+      float highOffset = points[idx].refC - points[idx].rawC;
+      float frac = span > 0.0f ? (rawC - points[idx - 1].rawC) / span : 1.0f;
+      return lowOffset + ((highOffset - lowOffset) * frac);
+    }
+  }
+  return points[count - 1].refC - points[count - 1].rawC;
+}
+//
+// build the table from a probe's points (sorted in place), no points turns correction off
+//
+static inline void Cal_Build(CalTable& table, CalPoint* points, int count)
+{
+  table.active = count > 0;
+  if(!table.active)
+  {
+    return;
+  }
+  Cal_Sort(points, count);
+  for(int idx = 0; idx < CAL_TABLE_SIZE; idx++)
+  {
+    table.offset[idx] = Cal_Offset(points, count, CAL_TABLE_MIN + (idx * CAL_TABLE_STEP));
+  }
+}
+//
+// corrected temp for a raw reading, degrees C, constant time
+//
+static inline float Cal_Apply(const CalTable& table, float rawC)
+{
+  if(!table.active)
+  {
+    return rawC;
+  }
+  float pos = (rawC - CAL_TABLE_MIN) * (1.0f / CAL_TABLE_STEP);
+  if(!(pos > 0.0f))
+  {
+    // below the table (or NaN, which passes through unchanged)
+    return pos == pos ? rawC + table.offset[0] : rawC;
+  }
+  if(pos >= CAL_TABLE_SIZE - 1)
+  {
+    return rawC + table.offset[CAL_TABLE_SIZE - 1];
+  }
+  int idx = (int)pos;
+  float frac = pos - idx;
+  return rawC + table.offset[idx] + ((table.offset[idx + 1] - table.offset[idx]) * frac);
+}
+
+#endif
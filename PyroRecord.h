@@ -0,0 +1,436 @@
+/*
+  YamuraLog Recording Tire Pyrometer
+  measurement record codec (py_temps_N.txt lines)
+  plain C++, no Arduino dependencies - also builds on the host (see tools/record_bench.cpp)
+
+  record layout, ';' separated:
+    time;car name;tire count;position count;temps (tires x positions);tire names;position names;max temps
+    [;reading times (tires x positions);settle times (tires x positions)[;reading flags (tires x positions)]]
+  time is epoch milliseconds, or preformatted "HH:MMam MM/DD/YYYY" text in older records
+  reading times are milliseconds relative to the record time, settle times are milliseconds
+  from arming to stable temp, empty fields are positions that were not measured
+  the optional time fields are missing in older records
+  reading flags (RECORD_FLAG_*) are only written when a reading has one, empty fields are 0
+  temps and max temps are whole hundredths of a degree C (TempCenti), older records have decimal
+  temps in the display units of the time (legacyTemps, see Record_LegacyToC)
+*/
+#ifndef PYRO_RECORD_H
+#define PYRO_RECORD_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "PyroTemp.h"
+
+#define RECORD_MAX_TIRES      8                   // matches CarSettings name arrays (CAR_MAX_TIRES)
+#define RECORD_MAX_POSITIONS  7                   // CAR_MAX_POSITIONS
+#define RECORD_MAX_TEMPS      (RECORD_MAX_TIRES * RECORD_MAX_POSITIONS)
+#define RECORD_LINE_SIZE      2048                // longest record line written
+#define RECORD_FLAG_ESTIMATE  0x01                // temp did not stabilize, best estimate at timeout
+
+// one measurement record, text fields point into the parsed line (or into the car name pool when formatting)
+struct MeasureRecord
+{
+  const char* dateTime;                       // time field text as stored
+  uint64_t epochMs;                           // record time, 0 for older text time records
+  const char* carName;
+  int tireCount;
+  int positionCount;
+  TempCenti temps[RECORD_MAX_TEMPS];
+  const char* tireNames[RECORD_MAX_TIRES];
+  const char* positionNames[RECORD_MAX_POSITIONS];
+  TempCenti maxTemps[RECORD_MAX_TIRES];
+  bool legacyTemps;                           // temps are hundredths of the older record's display units
+  bool hasReadingTimes;                       // readingMs/settleMs are valid
+  uint64_t readingMs[RECORD_MAX_TEMPS];       // epoch ms each position went stable, 0 if not measured
+  uint32_t settleMs[RECORD_MAX_TEMPS];        // ms from arming to stable temp
+  bool hasFlags;                              // flags are valid (needs reading times)
+  uint8_t flags[RECORD_MAX_TEMPS];            // RECORD_FLAG_* per reading
+};
+
+static const float recordPow10[] = {1.0f, 10.0f, 100.0f, 1000.0f, 10000.0f, 100000.0f, 1000000.0f, 10000000.0f, 100000000.0f};
+
+//
+// parse a decimal number ([-+]digits[.digits])
+// exact for up to 8 significant digits, anything else (exponent, nan, inf, long numbers) falls back to strtod
+//
+static inline float Record_ParseFloat(const char* text)
+{
+  const char* pos = text;
+  bool negative = false;
+  if((*pos == '-') || (*pos == '+'))
+  {
+    negative = (*pos == '-');
+    pos++;
+  }
+  uint32_t mantissa = 0;
+  int digits = 0;
+  int fracDigits = 0;
+  bool anyDigit = false;
+  while((*pos >= '0') && (*pos <= '9'))
+  {
+    if(digits >= 8)
+    {
+      return (float)strtod(text, NULL);
+    }
+    mantissa = (mantissa * 10) + (*pos - '0');
+    if(mantissa != 0)
+    {
+      digits++;
+    }
+    anyDigit = true;
+    pos++;
+  }
+  if(*pos == '.')
+  {
+    pos++;
+    while((*pos >= '0') && (*pos <= '9'))
+    {
+      if(digits >= 8)
+      {
+        return (float)strtod(text, NULL);
+      }
+      mantissa = (mantissa * 10) + (*pos - '0');
+      if(mantissa != 0)
+      {
+        digits++;
+      }
+      fracDigits++;
+      anyDigit = true;
+      pos++;
+    }
+  }
+  if(!anyDigit || (*pos == 'e') || (*pos == 'E') || (fracDigits > 8))
+  {
+    return (float)strtod(text, NULL);
+  }
+  // mantissa below 2^24 is exact as a float, one divide gives a correctly rounded result
+  float value;
+  if(mantissa <= 16777216)
+  {
+    value = (float)mantissa / recordPow10[fracDigits];
+  }
+  else
+  {
+    value = (float)((double)mantissa / (double)recordPow10[fracDigits]);
+  }
+  return negative ? -value : value;
+}
+//
+// parse an unsigned decimal integer, returns false if text is empty or not all digits
+//
+static inline bool Record_ParseUInt(const char* text, uint64_t& value)
+{
+  value = 0;
+  if(*text == '\0')
+  {
+    return false;
+  }
+  while(*text != '\0')
+  {
+    if((*text < '0') || (*text > '9'))
+    {
+      return false;
+    }
+    value = (value * 10) + (*text - '0');
+    text++;
+  }
+  return true;
+}
+//
+// parse a temp field, whole hundredths of a degree C
+// returns false for a decimal (older record) temp, value is then hundredths of its display units
+//
+static inline bool Record_ParseTemp(const char* text, TempCenti& value)
+{
+  const char* pos = (*text == '-') ? text + 1 : text;
+  uint64_t magnitude;
+  if(Record_ParseUInt(pos, magnitude) && (magnitude <= INT32_MAX))
+  {
+    value = (pos != text) ? -(TempCenti)magnitude : (TempCenti)magnitude;
+    return true;
+  }
+  float legacy = Record_ParseFloat(text);
+  value = isfinite(legacy) && (fabsf(legacy) < 1.0e7f) ? (TempCenti)lroundf(legacy * 100.0f) : 0;
+  return false;
+}
+//
+// convert an older record's temps to TempCenti, celsius is the display units it was written in
+// not measured (0) stays 0
+//
+static inline void Record_LegacyToC(MeasureRecord& record, bool celsius)
+{
+  if(!record.legacyTemps)
+  {
+    return;
+  }
+  record.legacyTemps = false;
+  if(celsius)
+  {
+    return;
+  }
+  for(int tempIdx = 0; tempIdx < record.tireCount * record.positionCount; tempIdx++)
+  {
+    record.temps[tempIdx] = record.temps[tempIdx] != 0 ? Temp_FromCentiF(record.temps[tempIdx]) : 0;
+  }
+  for(int tireIdx = 0; tireIdx < record.tireCount; tireIdx++)
+  {
+    record.maxTemps[tireIdx] = record.maxTemps[tireIdx] != 0 ? Temp_FromCentiF(record.maxTemps[tireIdx]) : 0;
+  }
+}
+//
+// split a record line in place, ';' separators are replaced by NUL and the record points into the line
+// returns false if the line is not a complete record or does not fit the record limits
+//
+static inline bool Record_Parse(char* line, MeasureRecord& record)
+{
+  char* fields[4 + RECORD_MAX_TEMPS + RECORD_MAX_TIRES + RECORD_MAX_POSITIONS + RECORD_MAX_TIRES + (3 * RECORD_MAX_TEMPS)];
+  const int maxFields = sizeof(fields) / sizeof(fields[0]);
+  int fieldCount = 0;
+  char* pos = line;
+  // early returns leave an empty record, safe for Record_LegacyToC and loops over the counts
+  record.legacyTemps = false;
+  record.tireCount = 0;
+  record.positionCount = 0;
+  fields[fieldCount++] = pos;
+  while(*pos != '\0')
+  {
+    if(*pos == ';')
+    {
+      *pos = '\0';
+      if(fieldCount == maxFields)
+      {
+        return false;
+      }
+      fields[fieldCount++] = pos + 1;
+    }
+    pos++;
+  }
+  if(fieldCount < 4)
+  {
+    return false;
+  }
+  record.dateTime = fields[0];
+  if(!Record_ParseUInt(fields[0], record.epochMs))
+  {
+    record.epochMs = 0;
+  }
+  record.carName = fields[1];
+  record.tireCount = atoi(fields[2]);
+  record.positionCount = atoi(fields[3]);
+  int tireCount = record.tireCount;
+  int positionCount = record.positionCount;
+  int tempCount = tireCount * positionCount;
+  if((tireCount < 0) || (tireCount > RECORD_MAX_TIRES) ||
+     (positionCount < 0) || (positionCount > RECORD_MAX_POSITIONS) ||
+     (tempCount > RECORD_MAX_TEMPS) ||
+     (fieldCount < 4 + tempCount + tireCount + positionCount + tireCount))
+  {
+    record.tireCount = 0;
+    record.positionCount = 0;
+    return false;
+  }
+  int fieldIdx = 4;
+  bool isCenti = true;
+  for(int tempIdx = 0; tempIdx < tempCount; tempIdx++)
+  {
+    isCenti = Record_ParseTemp(fields[fieldIdx++], record.temps[tempIdx]) && isCenti;
+  }
+  for(int tireIdx = 0; tireIdx < tireCount; tireIdx++)
+  {
+    record.tireNames[tireIdx] = fields[fieldIdx++];
+  }
+  for(int positionIdx = 0; positionIdx < positionCount; positionIdx++)
+  {
+    record.positionNames[positionIdx] = fields[fieldIdx++];
+  }
+  for(int tireIdx = 0; tireIdx < tireCount; tireIdx++)
+  {
+    isCenti = Record_ParseTemp(fields[fieldIdx++], record.maxTemps[tireIdx]) && isCenti;
+  }
+  record.legacyTemps = !isCenti;
+  // optional reading and settle times
+  record.hasReadingTimes = (record.epochMs != 0) && (fieldCount >= fieldIdx + (2 * tempCount));
+  if(record.hasReadingTimes)
+  {
+    for(int tempIdx = 0; tempIdx < tempCount; tempIdx++)
+    {
+      const char* offsetText = fields[fieldIdx++];
+      bool negative = (*offsetText == '-');
+      uint64_t offsetMs;
+      if(!Record_ParseUInt(negative ? offsetText + 1 : offsetText, offsetMs))
+      {
+        record.readingMs[tempIdx] = 0;
+        continue;
+      }
+      record.readingMs[tempIdx] = negative ? record.epochMs - offsetMs : record.epochMs + offsetMs;
+    }
+    for(int tempIdx = 0; tempIdx < tempCount; tempIdx++)
+    {
+      uint64_t settle;
+      record.settleMs[tempIdx] = Record_ParseUInt(fields[fieldIdx++], settle) ? (uint32_t)settle : 0;
+    }
+  }
+  // optional reading flags
+  record.hasFlags = record.hasReadingTimes && (fieldCount >= fieldIdx + tempCount);
+  for(int tempIdx = 0; tempIdx < tempCount; tempIdx++)
+  {
+    uint64_t flags;
+    record.flags[tempIdx] = record.hasFlags && Record_ParseUInt(fields[fieldIdx++], flags) ? (uint8_t)flags : 0;
+  }
+  return true;
+}
+//
+// write a signed integer into out, returns characters written or -1 if out is too small
+//
+static inline int Record_FormatInt(char* out, int outSize, int64_t value)
+{
+  char digits[24];
+  int digitCount = 0;
+  int outIdx = 0;
+  uint64_t magnitude = value < 0 ? (uint64_t)(-value) : (uint64_t)value;
+  do
+  {
+    digits[digitCount++] = '0' + (magnitude % 10);
+    magnitude /= 10;
+  } while(magnitude != 0);
+  if(digitCount + (value < 0 ? 1 : 0) >= outSize)
+  {
+    return -1;
+  }
+  if(value < 0)
+  {
+    out[outIdx++] = '-';
+  }
+  while(digitCount > 0)
+  {
+    out[outIdx++] = digits[--digitCount];
+  }
+  out[outIdx] = '\0';
+  return outIdx;
+}
+//
+// append ';' and text to a record line, returns new length or -1 if out is too small
+//
+static inline int Record_AppendText(char* out, int outSize, int len, const char* text, bool separator)
+{
+  if(len < 0)
+  {
+    return -1;
+  }
+  if(separator)
+  {
+    if(len + 1 >= outSize)
+    {
+      return -1;
+    }
+    out[len++] = ';';
+  }
+  int textLen = strlen(text);
+  if(len + textLen >= outSize)
+  {
+    return -1;
+  }
+  memcpy(&out[len], text, textLen + 1);
+  return len + textLen;
+}
+//
+// append ';' and a temperature (whole hundredths of a degree C) to a record line
+//
+static inline int Record_AppendTemp(char* out, int outSize, int len, TempCenti value)
+{
+  if((len < 0) || (len + 1 >= outSize))
+  {
+    return -1;
+  }
+  out[len++] = ';';
+  int tempLen = Record_FormatInt(&out[len], outSize - len, value);
+  return tempLen < 0 ? -1 : len + tempLen;
+}
+//
+// format a record line into out (no trailing newline)
+// returns line length, or -1 if the record does not fit in outSize
+//
+static inline int Record_Format(const MeasureRecord& record, char* out, int outSize)
+{
+  if((record.tireCount < 0) || (record.tireCount > RECORD_MAX_TIRES) ||
+     (record.positionCount < 0) || (record.positionCount > RECORD_MAX_POSITIONS) ||
+     (record.tireCount * record.positionCount > RECORD_MAX_TEMPS))
+  {
+    return -1;
+  }
+  char number[24];
+  int len;
+  if(record.epochMs != 0)
+  {
+    Record_FormatInt(number, sizeof(number), (int64_t)record.epochMs);
+    len = Record_AppendText(out, outSize, 0, number, false);
+  }
+  else
+  {
+    len = Record_AppendText(out, outSize, 0, record.dateTime, false);
+  }
+  len = Record_AppendText(out, outSize, len, record.carName, true);
+  Record_FormatInt(number, sizeof(number), record.tireCount);
+  len = Record_AppendText(out, outSize, len, number, true);
+  Record_FormatInt(number, sizeof(number), record.positionCount);
+  len = Record_AppendText(out, outSize, len, number, true);
+  int tempCount = record.tireCount * record.positionCount;
+  for(int tempIdx = 0; tempIdx < tempCount; tempIdx++)
+  {
+    len = Record_AppendTemp(out, outSize, len, record.temps[tempIdx]);
+  }
+  for(int tireIdx = 0; tireIdx < record.tireCount; tireIdx++)
+  {
+    len = Record_AppendText(out, outSize, len, record.tireNames[tireIdx], true);
+  }
+  for(int positionIdx = 0; positionIdx < record.positionCount; positionIdx++)
+  {
+    len = Record_AppendText(out, outSize, len, record.positionNames[positionIdx], true);
+  }
+  for(int tireIdx = 0; tireIdx < record.tireCount; tireIdx++)
+  {
+    len = Record_AppendTemp(out, outSize, len, record.maxTemps[tireIdx]);
+  }
+  if(record.hasReadingTimes && (record.epochMs != 0))
+  {
+    for(int tempIdx = 0; tempIdx < tempCount; tempIdx++)
+    {
+      number[0] = '\0';
+      if(record.readingMs[tempIdx] != 0)
+      {
+        Record_FormatInt(number, sizeof(number), (int64_t)(record.readingMs[tempIdx] - record.epochMs));
+      }
+      len = Record_AppendText(out, outSize, len, number, true);
+    }
+    for(int tempIdx = 0; tempIdx < tempCount; tempIdx++)
+    {
+      number[0] = '\0';
+      if(record.readingMs[tempIdx] != 0)
+      {
+        Record_FormatInt(number, sizeof(number), record.settleMs[tempIdx]);
+      }
+      len = Record_AppendText(out, outSize, len, number, true);
+    }
+    // flags only when a reading has one, keeps unflagged records the same as before
+    bool anyFlag = false;
+    for(int tempIdx = 0; record.hasFlags && (tempIdx < tempCount); tempIdx++)
+    {
+      anyFlag = anyFlag || (record.flags[tempIdx] != 0);
+    }
+    for(int tempIdx = 0; anyFlag && (tempIdx < tempCount); tempIdx++)
+    {
+      number[0] = '\0';
+      if(record.flags[tempIdx] != 0)
+      {
+        Record_FormatInt(number, sizeof(number), record.flags[tempIdx]);
+      }
+      len = Record_AppendText(out, outSize, len, number, true);
+    }
+  }
+  return len;
+}
+
+#endif
@@ -0,0 +1,339 @@
+/*
+  YamuraLog Recording Tire Pyrometer
+  stable temperature detectors used by GetStableTemp
+  plain C++, no Arduino dependencies - also builds on the host (see tools/stable_replay.cpp)
+
+  band  - max minus min deviation from the window mean inside the stable band (original method)
+  slope - least squares line over the window, stable when |dT/dt| stays under a limit
+  kalman - temp and rate estimate per sample, stable when the temp standard deviation is
+           inside the stable band and the rate is under the slope limit
+*/
+#ifndef PYRO_STABLE_H
+#define PYRO_STABLE_H
+
+#include <stdint.h>
+#include <math.h>
+
+#define STABLE_BAND        0                      // deviceSettings.stableMethod
+#define STABLE_SLOPE       1
+#define STABLE_KALMAN      2
+#define STABLE_METHOD_COUNT 3
+#define STABLE_WINDOW_MAX  100                    // most samples in a window
+#define STABLE_SLOPE_HOLD  3                      // consecutive fits under the slope limit before stable
+#define STABLE_KALMAN_SETTLED 0.9f                // rate variance falling by less than this per update is converged
+#define STABLE_TIMEOUT_MS  30000                  // longest wait for a stable temp, then the best estimate
+
+// circular buffer of the last size samples, seeded so the window starts full
+struct BandDetector
+{
+  int size;                                   // window length in samples
+  int next;                                   // ring index of the next sample
+  int count;                                  // samples added, up to size (the rest are seed)
+  float values[STABLE_WINDOW_MAX];
+};
+
+//
+// start a new window of size samples, all set to seed (15C or 60F on the device)
+//
+static inline void Stable_BandBegin(BandDetector& detector, int size, float seed)
+{
+  detector.size = size < 1 ? 1 : (size > STABLE_WINDOW_MAX ? STABLE_WINDOW_MAX : size);
+  detector.next = 0;
+  detector.count = 0;
+  for(int idx = 0; idx < detector.size; idx++)
+  {
+    detector.values[idx] = seed;
+  }
+}
+//
+// add a sample and check for stable - spread of the deviations from the window mean
+// between bandLow and bandHigh, value is the mean of the samples added (not the seed)
+//
+static inline bool Stable_BandCheck(BandDetector& detector, float temp, float bandLow, float bandHigh, float& value)
+{
+  detector.values[detector.next] = temp;
+  detector.next = (detector.next + 1) % detector.size;
+  detector.count += detector.count < detector.size ? 1 : 0;
+  float averageTemp = 0.0f;
+  float filledTemp = 0.0f;
+  for(int idx = 0; idx < detector.size; idx++)
+  {
+    averageTemp += detector.values[idx];
+    // the ring fills from index 0, so the first count entries are samples
+    filledTemp += idx < detector.count ? detector.values[idx] : 0.0f;
+  }
+  averageTemp = averageTemp / (float)detector.size;
+  filledTemp = filledTemp / (float)detector.count;
+  float minMax[2] = {5000.0f, -5000.0f};
+  for(int idx = 0; idx < detector.size; idx++)
+  {
+    float deviation = averageTemp - detector.values[idx];
+    minMax[0] = deviation < minMax[0] ? deviation : minMax[0];
+    minMax[1] = deviation > minMax[1] ? deviation : minMax[1];
+  }
+  value = filledTemp;
+  return ((minMax[1] - minMax[0]) >= bandLow) && ((minMax[1] - minMax[0]) <= bandHigh);
+}
+
+// windowed least squares fit of temp against time
+// running sums are updated as samples enter and leave the window, constant time per sample
+struct SlopeDetector
+{
+  int size;                                   // window length in samples
+  int count;                                  // samples in the window
+  int next;                                   // ring index of the next sample
+  int holdCount;                              // consecutive fits under the slope limit
+  float times[STABLE_WINDOW_MAX];             // seconds since the detector started
+  float temps[STABLE_WINDOW_MAX];
+  double sumT;
+  double sumTT;
+  double sumY;
+  double sumTY;
+};
+
+//
+// start a new fit with a window of size samples
+//
+static inline void Stable_SlopeBegin(SlopeDetector& detector, int size)
+{
+  detector.size = size < 3 ? 3 : (size > STABLE_WINDOW_MAX ? STABLE_WINDOW_MAX : size);
+  detector.count = 0;
+  detector.next = 0;
+  detector.holdCount = 0;
+  detector.sumT = 0.0;
+  detector.sumTT = 0.0;
+  detector.sumY = 0.0;
+  detector.sumTY = 0.0;
+}
+//
+// add a sample, the oldest drops out once the window is full
+//
+static inline void Stable_SlopeAdd(SlopeDetector& detector, float timeSec, float temp)
+{
+  if(detector.count == detector.size)
+  {
+    double oldT = detector.times[detector.next];
+    double oldY = detector.temps[detector.next];
+    detector.sumT -= oldT;
+    detector.sumTT -= oldT * oldT;
+    detector.sumY -= oldY;
+    detector.sumTY -= oldT * oldY;
+  }
+  else
+  {
+    detector.count++;
+  }
+  detector.times[detector.next] = timeSec;
+  detector.temps[detector.next] = temp;
+  detector.sumT += timeSec;
+  detector.sumTT += (double)timeSec * timeSec;
+  detector.sumY += temp;
+  detector.sumTY += (double)timeSec * temp;
+  detector.next = (detector.next + 1) % detector.size;
+}
+//
+// fit the window, slope in degrees/second and the fitted temp at the newest sample
+// returns false until there are 2 samples at different times
+//
+static inline bool Stable_SlopeFit(const SlopeDetector& detector, float& slope, float& value)
+{
+  double count = detector.count;
+  double denom = (count * detector.sumTT) - (detector.sumT * detector.sumT);
+  if((detector.count < 2) || (denom <= 1.0e-9))
+  {
+    slope = 0.0f;
+    value = detector.count > 0 ? (float)(detector.sumY / count) : 0.0f;
+    return false;
+  }
+  double fitSlope = ((count * detector.sumTY) - (detector.sumT * detector.sumY)) / denom;
+  double intercept = (detector.sumY - (fitSlope * detector.sumT)) / count;
+  int newest = (detector.next + detector.size - 1) % detector.size;
+  slope = (float)fitSlope;
+  value = (float)(intercept + (fitSlope * detector.times[newest]));
+  return true;
+}
+//
+// add a sample and check for stable - window full and |slope| under slopeLimit
+// for STABLE_SLOPE_HOLD fits in a row, so a short flat spot on a rising probe is not taken
+//
+static inline bool Stable_SlopeCheck(SlopeDetector& detector, float timeSec, float temp, float slopeLimit, float& value)
+{
+  float slope;
+  Stable_SlopeAdd(detector, timeSec, temp);
+  bool isFit = Stable_SlopeFit(detector, slope, value);
+  if(!isFit || (detector.count < detector.size) || (fabsf(slope) > slopeLimit))
+  {
+    detector.holdCount = 0;
+    return false;
+  }
+  detector.holdCount++;
+  return detector.holdCount >= STABLE_SLOPE_HOLD;
+}
+
+// constant rate (temp, dT/dt) Kalman filter, measurement noise r and rate noise q
+// covariance is symmetric so p10 == p01
+struct KalmanEstimator
+{
+  bool started;
+  int updates;                                // readings after the first (predict/update steps)
+  int holdCount;                              // consecutive samples meeting the stable test
+  float lastTime;                             // seconds, time of the last sample
+  float temp;                                 // estimated temp
+  float rate;                                 // estimated degrees/second
+  float p00;                                  // temp variance
+  float p01;                                  // temp/rate covariance
+  float p11;                                  // rate variance
+  float lastP11;                              // rate variance before the last update
+  float innovation;                           // last reading minus the predicted temp
+  float r;                                    // measurement variance (sensor noise sigma squared)
+  float q;                                    // rate random walk, (degrees/second)^2 per second
+};
+
+//
+// start a new estimate, noiseSigma is the probe reading noise and rateNoise how fast the rate can change
+// both in display units
+//
+static inline void Stable_KalmanBegin(KalmanEstimator& filter, float noiseSigma, float rateNoise)
+{
+  filter.started = false;
+  filter.updates = 0;
+  filter.holdCount = 0;
+  filter.lastTime = 0.0f;
+  filter.temp = 0.0f;
+  filter.rate = 0.0f;
+  filter.r = noiseSigma * noiseSigma;
+  filter.q = rateNoise * rateNoise;
+  filter.p00 = filter.r;
+  filter.p01 = 0.0f;
+  filter.p11 = 0.0f;
+  filter.lastP11 = 0.0f;
+  filter.innovation = 0.0f;
+}
+//
+// predict to timeSec and update with a reading, constant time
+//
+static inline void Stable_KalmanAdd(KalmanEstimator& filter, float timeSec, float temp)
+{
+  if(!filter.started)
+  {
+    // first reading sets the temp, rate unknown (+/- 100 degrees/second)
+    filter.started = true;
+    filter.lastTime = timeSec;
+    filter.temp = temp;
+    filter.rate = 0.0f;
+    filter.p00 = filter.r;
+    filter.p01 = 0.0f;
+    filter.p11 = 10000.0f;
+    return;
+  }
+  float dt = timeSec - filter.lastTime;
+  dt = dt > 0.0f ? dt : 0.0f;
+  filter.lastTime = timeSec;
+  // predict, temp moves at the estimated rate, rate noise integrates into both
+  filter.temp += filter.rate * dt;
+  float p00 = filter.p00 + (dt * (2.0f * filter.p01 + dt * filter.p11)) + (filter.q * dt * dt * dt / 3.0f);
+  float p01 = filter.p01 + (dt * filter.p11) + (filter.q * dt * dt / 2.0f);
+  float p11 = filter.p11 + (filter.q * dt);
+  // update with the reading
+  float innovation = temp - filter.temp;
+  float s = p00 + filter.r;
+  float k0 = p00 / s;
+  float k1 = p01 / s;
+  filter.temp += k0 * innovation;
+  filter.rate += k1 * innovation;
+  filter.lastP11 = filter.p11;
+  filter.innovation = innovation;
+  filter.p00 = (1.0f - k0) * p00;
+  filter.p01 = (1.0f - k0) * p01;
+  filter.p11 = p11 - (k1 * p01);
+  filter.updates++;
+}
+//
+// add a reading and check for stable - the reading within sigmaLimit of the predicted temp and
+// |rate| under slopeLimit for STABLE_SLOPE_HOLD samples in a row, value and variance are the current estimate
+// the covariance does not depend on the readings, so it only gates when the rate estimate can be trusted:
+// at least 2 updates and the rate variance under slopeLimit squared or no longer falling (STABLE_KALMAN_SETTLED)
+//
+static inline bool Stable_KalmanCheck(KalmanEstimator& filter, float timeSec, float temp, float sigmaLimit, float slopeLimit,
+                                      float& value, float& variance)
+{
+  Stable_KalmanAdd(filter, timeSec, temp);
+  value = filter.temp;
+  variance = filter.p00;
+  bool converged = (filter.updates >= 2) &&
+                   ((filter.p11 <= slopeLimit * slopeLimit) || (filter.p11 >= STABLE_KALMAN_SETTLED * filter.lastP11));
+  if(!converged || (fabsf(filter.innovation) > sigmaLimit) || (fabsf(filter.rate) > slopeLimit))
+  {
+    filter.holdCount = 0;
+    return false;
+  }
+  filter.holdCount++;
+  return filter.holdCount >= STABLE_SLOPE_HOLD;
+}
+
+#define REPLAY_STABLE   0
+#define REPLAY_TIMEOUT  1                         // best estimate at STABLE_TIMEOUT_MS
+#define REPLAY_ENDED    2                         // samples ran out first
+
+// detector settings for Stable_Replay, same meaning as the DeviceSettings fields
+struct StableParams
+{
+  int method;
+  int buffer;                                 // stableBuffer
+  float bandLow;                              // stableBand[0]
+  float bandHigh;                             // stableBand[1]
+  float slope;                                // stableSlope
+  float kalmanNoise;
+  float kalmanRate;
+  float seed;                                 // band window start value (15C or 60F)
+};
+
+//
+// run recorded samples through a detector the way GetStableTemp does - sample, timeout check,
+// detector check - using every step'th sample, times are seconds from arming
+// returns REPLAY_*, value is the reported temp and lastIdx the index of the last sample used
+//
+static inline int Stable_Replay(const float* times, const float* temps, int count, int step, const StableParams& params,
+                                float& value, int& lastIdx)
+{
+  // large windows, kept off the stack
+  static BandDetector bandDetector;
+  static SlopeDetector slopeDetector;
+  static KalmanEstimator kalmanEstimator;
+  float variance = 0.0f;
+  value = params.seed;
+  lastIdx = 0;
+  Stable_BandBegin(bandDetector, params.buffer, params.seed);
+  Stable_SlopeBegin(slopeDetector, params.buffer);
+  Stable_KalmanBegin(kalmanEstimator, params.kalmanNoise, params.kalmanRate);
+  step = step < 1 ? 1 : step;
+  for(int idx = 0; idx < count; idx += step)
+  {
+    lastIdx = idx;
+    float timeSec = times[idx] - times[0];
+    if(timeSec * 1000.0f >= STABLE_TIMEOUT_MS - 1.0f)
+    {
+      return REPLAY_TIMEOUT;
+    }
+    bool isStable;
+    if(params.method == STABLE_SLOPE)
+    {
+      isStable = Stable_SlopeCheck(slopeDetector, timeSec, temps[idx], params.slope, value);
+    }
+    else if(params.method == STABLE_KALMAN)
+    {
+      isStable = Stable_KalmanCheck(kalmanEstimator, timeSec, temps[idx], params.bandHigh, params.slope, value, variance);
+    }
+    else
+    {
+      isStable = Stable_BandCheck(bandDetector, temps[idx], params.bandLow, params.bandHigh, value);
+    }
+    if(isStable)
+    {
+      return REPLAY_STABLE;
+    }
+  }
+  return REPLAY_ENDED;
+}
+
+#endif
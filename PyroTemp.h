@@ -0,0 +1,74 @@
+/*
+  YamuraLog Recording Tire Pyrometer
+  fixed point temperatures - hundredths of a degree C (TempCenti)
+  plain C++, no Arduino dependencies - also builds on the host
+
+  stored readings, the journal, measurement records and /api/results all carry TempCenti
+  conversion to F and formatting happen only where a temp is shown (Temp_Format)
+  0 is a position that was not measured
+*/
+#ifndef PYRO_TEMP_H
+#define PYRO_TEMP_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+typedef int32_t TempCenti;                        // hundredths of a degree C
+#define TEMP_CENTI_MAX   INT32_MAX                // above any reading, starts a minimum search
+
+//
+// num / den rounded half away from zero, den > 0
+//
+static inline int32_t Temp_DivRound(int64_t num, int64_t den)
+{
+  return (int32_t)(num >= 0 ? (num + (den / 2)) / den : -((-num + (den / 2)) / den));
+}
+//
+// degrees C to TempCenti, NaN reads as not measured
+//
+static inline TempCenti Temp_FromC(float tempC)
+{
+  return isnan(tempC) ? 0 : (TempCenti)lroundf(tempC * 100.0f);
+}
+//
+// display units (celsius false for F) to TempCenti
+//
+static inline TempCenti Temp_FromDisplay(float value, bool celsius)
+{
+  return Temp_FromC(celsius ? value : (value - 32.0f) / 1.8f);
+}
+//
+// TempCenti to hundredths of a degree in display units, integer math
+//
+static inline int32_t Temp_ToUnits(TempCenti temp, bool celsius)
+{
+  return celsius ? temp : Temp_DivRound((int64_t)temp * 9, 5) + 3200;
+}
+//
+// hundredths of a degree F to TempCenti, integer math
+//
+static inline TempCenti Temp_FromCentiF(int32_t centiF)
+{
+  return Temp_DivRound((int64_t)(centiF - 3200) * 5, 9);
+}
+//
+// TempCenti in display units with 0-2 decimals, rounded, no float printf
+// returns characters written (snprintf)
+//
+static inline int Temp_Format(char* out, int outSize, TempCenti temp, bool celsius, int decimals)
+{
+  static const int32_t scales[] = {100, 10, 1};
+  decimals = decimals < 0 ? 0 : decimals > 2 ? 2 : decimals;
+  int32_t rounded = Temp_DivRound(Temp_ToUnits(temp, celsius), scales[decimals]);
+  unsigned long magnitude = rounded < 0 ? (unsigned long)(-(int64_t)rounded) : (unsigned long)rounded;
+  const char* sign = rounded < 0 ? "-" : "";
+  if(decimals == 0)
+  {
+    return snprintf(out, outSize, "%s%lu", sign, magnitude);
+  }
+  unsigned long unit = decimals == 1 ? 10 : 100;
+  return snprintf(out, outSize, "%s%lu.%0*lu", sign, magnitude / unit, decimals, magnitude % unit);
+}
+
+#endif
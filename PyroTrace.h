@@ -0,0 +1,156 @@
+/*
+  YamuraLog Recording Tire Pyrometer
+  raw sample trace (py_trace.bin) - every probe sample GetStableTemp takes, per position
+  plain C++, no Arduino dependencies - also builds on the host (see tools/trace_decode.cpp)
+
+  file layout, little endian, records packed back to back:
+    TraceHeader once when the file is created, a file with another version is replaced
+    per position: TraceStart, TraceSample for each sample, TraceEnd
+  each record starts with its type byte, the type gives the record size (Trace_RecordSize)
+  samples go into a fixed size ring (TraceBuffer) while measuring and are written out between
+  positions, if the ring fills later samples are dropped and counted in TraceEnd
+*/
+#ifndef PYRO_TRACE_H
+#define PYRO_TRACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define TRACE_MAGIC     0x52545950                // "PYTR"
+#define TRACE_VERSION   2                         // 2: TraceStart.stableDelay widened to 32 bits
+#define TRACE_START     1
+#define TRACE_SAMPLE    2
+#define TRACE_END       3
+
+// file header
+struct TraceHeader
+{
+  uint32_t magic;                             // TRACE_MAGIC
+  uint16_t version;                           // TRACE_VERSION
+  uint16_t reserved;
+};
+// start of a position, stable temp settings in use
+struct TraceStart
+{
+  uint8_t type;                               // TRACE_START
+  uint8_t method;                             // STABLE_BAND, STABLE_SLOPE or STABLE_KALMAN
+  uint8_t tempIdx;                            // reading index, tire * positionCount + position
+  uint8_t positionCount;
+  int32_t carID;
+  uint64_t epochMs;                           // time the position was armed
+  float stableBand[2];                        // display units
+  float stableSlope;
+  float kalmanNoise;
+  float kalmanRate;
+  uint32_t stableDelay;                       // ms between samples
+  uint8_t stableBuffer;                       // window samples
+  uint8_t tempUnits;                          // deviceSettings.tempUnits, 1 = C
+  uint8_t reserved[6];
+};
+// one probe sample, raw amplifier values in degrees C
+struct TraceSample
+{
+  uint8_t type;                               // TRACE_SAMPLE
+  uint8_t status;                             // amplifier status register (0 on MCP9600)
+  int16_t coldCenti;                          // cold junction, hundredths of a degree C
+  uint32_t timeMs;                            // ms since TraceStart epochMs
+  float hot;                                  // hot junction, NaN if the read failed
+};
+// end of a position
+struct TraceEnd
+{
+  uint8_t type;                               // TRACE_END
+  uint8_t result;                             // READING_STABLE, READING_ESTIMATE or READING_FAULT
+  uint8_t fault;                              // THERMO_* fault
+  uint8_t reserved;
+  uint32_t timeMs;                            // ms since TraceStart epochMs
+  float temp;                                 // reported temp, display units
+  uint32_t dropped;                           // samples lost to a full ring
+};
+
+static_assert(sizeof(TraceHeader) == 8, "TraceHeader layout");
+static_assert(sizeof(TraceStart) == 48, "TraceStart layout");
+static_assert(sizeof(TraceSample) == 12, "TraceSample layout");
+static_assert(sizeof(TraceEnd) == 16, "TraceEnd layout");
+
+// bounded byte ring, records are only added whole
+struct TraceBuffer
+{
+  uint8_t* data;
+  uint32_t size;
+  uint32_t head;                              // next byte written
+  uint32_t tail;                              // next byte read
+  uint32_t used;
+  uint32_t dropped;                           // records not added since Trace_BufferBegin
+};
+
+//
+// record size for a type byte, 0 if unknown
+//
+static inline int Trace_RecordSize(uint8_t type)
+{
+  switch(type)
+  {
+    case TRACE_START:
+      return sizeof(TraceStart);
+    case TRACE_SAMPLE:
+      return sizeof(TraceSample);
+    case TRACE_END:
+      return sizeof(TraceEnd);
+    default:
+      return 0;
+  }
+}
+//
+// use size bytes at data for the ring
+//
+static inline void Trace_BufferBegin(TraceBuffer& buffer, uint8_t* data, uint32_t size)
+{
+  buffer.data = data;
+  buffer.size = data != NULL ? size : 0;
+  buffer.head = 0;
+  buffer.tail = 0;
+  buffer.used = 0;
+  buffer.dropped = 0;
+}
+//
+// add a record, never waits - returns false (and counts it) if the ring is full
+//
+static inline bool Trace_Put(TraceBuffer& buffer, const void* record, uint32_t length)
+{
+  if(buffer.size - buffer.used < length)
+  {
+    buffer.dropped++;
+    return false;
+  }
+  const uint8_t* bytes = (const uint8_t*)record;
+  uint32_t first = buffer.size - buffer.head < length ? buffer.size - buffer.head : length;
+  memcpy(&buffer.data[buffer.head], bytes, first);
+  memcpy(buffer.data, bytes + first, length - first);
+  buffer.head = (buffer.head + length) % buffer.size;
+  buffer.used += length;
+  return true;
+}
+//
+// oldest unread bytes that are contiguous in the ring, returns the count (0 if empty)
+//
+static inline uint32_t Trace_Peek(const TraceBuffer& buffer, const uint8_t*& bytes)
+{
+  bytes = &buffer.data[buffer.tail];
+  if(buffer.used == 0)
+  {
+    return 0;
+  }
+  return buffer.size - buffer.tail < buffer.used ? buffer.size - buffer.tail : buffer.used;
+}
+//
+// mark count bytes from Trace_Peek as written
+//
+static inline void Trace_Consume(TraceBuffer& buffer, uint32_t count)
+{
+  count = count < buffer.used ? count : buffer.used;
+  buffer.tail = (buffer.tail + count) % buffer.size;
+  buffer.used -= count;
+}
+
+#endif
@@ -10,6 +10,10 @@
 #define HAS_RTC
 //#define RTC_8563   // using 8563 RTC
 #define RTC_3231 // using 3231 RTC
+// DS3231 SQW output wired to a GPIO disciplines the millis() clock to the RTC second (optional)
+//#define RTC_SQW_PIN 27
+// thermocouple amp alert output wired to a GPIO, an armed position sleeps until the probe touches the tire (optional)
+//#define THERMO_ALERT_PIN 25
 // select 1 Thermocouple amp library. Modify Thermo_ functions as needed
 //#define THERMO_MCP9600 // using MPC9600 thermocouple amp
 #define THERMO_MCP9601 // using MPC9601 thermocouple amp
@@ -20,10 +24,19 @@
 #include <ESPAsyncWebServer.h>
 #include <TFT_eSPI.h>            // https://github.com/Bodmer/TFT_eSPI Graphics and font library for ST7735 driver chip
 #include "Free_Fonts.h"          // Include the header file attached to this sketch
+#include "PyroTemp.h"            // fixed point temperatures
+#include "PyroRecord.h"          // measurement record parse/format
+#include "PyroStable.h"          // stable temp detectors
+#include "PyroTrace.h"           // raw sample trace records
+#include "PyroCal.h"             // probe calibration tables
 #include "FS.h"
 #include "LittleFS.h"
 #include "SD.h"
 #include "SPI.h" 
+#include "driver/gpio.h"
+#include <memory>
+#include "esp_sleep.h"
+#include "freertos/event_groups.h"
 // install correct thermocouple library
 #ifdef THERMO_MCP9600
 //#include <SparkFun_MCP9600.h>    // MPC9600 Thermocouple library https://github.com/sparkfun/SparkFun_MCP9600_Arduino_Library
@@ -40,6 +53,8 @@
 //#define DEBUG_EXTRA_VERBOSE
 //#define DEBUG_HTML
 //#define SET_TO_SYSTEM_TIME
+// light sleep between button presses and temperature samples while no web clients are connected
+#define POWER_SAVE
 // microSD chip reader select
 #define SD_CS 5
 // I2C pins
@@ -48,6 +63,12 @@
 
 // max menu item count
 #define MAX_MENU_ITEMS 100
+#define POOL_BLOCK_SIZE 256  // string pool growth step
+#define POOL_NAME_MAX 63     // longest name stored in a string pool
+#define MENU_TEXT_SIZE 64   // longest menu line, longer text is truncated
+#define RTC_STRING_SIZE 16  // time or date text from RTC_GetStringTime/RTC_GetStringDate
+#define RECORD_TIME_SIZE 32 // record time text from Clock_FormatEpoch/Results_TimeText
+#define RESULTS_JSON_MAX 200 // most records returned by /api/results
 // main menu
 #define DISPLAY_MENU            0
 #define SELECT_CAR              1
@@ -57,6 +78,9 @@
 #define CHANGE_SETTINGS         5
 #define INSTANT_TEMP            6
 #define TEST_MENU               7
+#define RESUME_TIRES            8
+#define MEASURE_RUN_GROUP       9
+#define DEVICE_BOOT            10   // setup still running, not a menu choice
 // settings menu
 #define SET_DATETIME 0
 #define SET_TEMPUNITS 1
@@ -66,11 +90,19 @@
 #define SET_STABLEBAND 5
 #define SET_STABLEDELAY 6
 #define SET_STABLEBUFFER 7
-#define SET_DELETEDATA 8
-#define SET_IPADDRESS 9
-#define SET_PASS 10
-#define SET_SAVESETTINGS 11
-#define SET_EXIT 12
+#define SET_STABLEMETHOD 8
+#define SET_STABLESLOPE 9
+#define SET_TRACE 10
+#define SET_AUTOTUNE 11
+#define SET_CALIBRATE 12
+#define SET_DELETEDATA 13
+#define SET_IPADDRESS 14
+#define SET_PASS 15
+#define SET_BATTERY 16
+#define SET_DIAGNOSTICS 17
+#define SET_SAVESETTINGS 18
+#define SET_EXIT 19
+#define SET_MENU_COUNT 20
 // font size menu
 #define FONTSIZE_9 0
 #define FONTSIZE_12 1
@@ -93,31 +125,203 @@
 #define BUTTON_1     0
 #define BUTTON_2     1
 #define BUTTON_3     2
-#define BUTTON_RELEASED 0
+#define BUTTON_RELEASED 0             // debounced button state (UserButton.buttonLast)
 #define BUTTON_PRESSED  1
+#define BUTTON_ACTIVE_LEVEL LOW       // pin level while pressed, switches to GND on INPUT_PULLUP pins
 #define BUTTON_DEBOUNCE_DELAY   20   // ms
+#define BUTTON_LONGPRESS_DELAY 600   // ms held before long press (and auto-repeat on up/down)
+#define BUTTON_REPEAT_DELAY    150   // ms between auto-repeat events while held
+#define BUTTON_QUEUE_SIZE       32   // button edges buffered between interrupt and CheckButtons
 #define FORMAT_LITTLEFS_IF_FAILED true
 //#define TEMP_BUFFER 15
+// boot stages (bootEvents bits)
+#define BOOT_I2C_DONE       0x01   // RTC and thermocouple amp
+#define BOOT_SETTINGS_DONE  0x02   // SD mounted, device settings read
+#define BOOT_SD_DONE        0x04   // car settings read
+#define BOOT_WIFI_DONE      0x08   // soft-AP and web server started
+#define BOOT_ALL            0x0F
+#define BOOT_LOG_SIZE       16     // progress lines queued for boot screen
+// HTML pages waiting to be regenerated (htmlPending bits)
+#define HTML_DEVICE   0x01
+#define HTML_CARS     0x02
+#define HTML_RESULTS  0x04
+#define HTML_RECORDS  0x08   // staged run group records to copy to SD, done before HTML_RESULTS
+#define RESULTS_HTML_STEP_ROWS  8            // records written per idle step (Results_HTMLStep)
+#define RESULTS_HTML_TEMP  "/py_res.tmp"     // results page being written, renamed to /py_res.html when done
+// web page forms (WebForm), parsed by the web server and applied on the loop task
+#define WEB_FORM_QUEUE_SIZE  4   // posted forms waiting for the main menu
+#define WEB_REFRESH_SECONDS  2   // reply page reloads the form page after this
+#define WEB_SPI_WAIT_MS    2000   // web handler wait for spiMutex before replying busy
+#define WEB_CHUNK_WAIT_MS    50   // chunk wait for spiMutex before asking to be called again
+#define WEB_PAGE_NONE        0   // WebForm.pageSource
+#define WEB_PAGE_CARS        1
+#define WEB_PAGE_DEVICE      2
+#define WEB_FORM_NONE        0   // WebForm.action, button that posted the form
+#define WEB_FORM_UPDATE      1
+#define WEB_FORM_NEW         2
+#define WEB_FORM_DELETE      3
+#define WEB_FORM_NEXT        4
+#define WEB_FORM_PRIOR       5
+// timing probes (timingProbes index)
+#define PROBE_BOOT           0
+#define PROBE_RTC_SETUP      1
+#define PROBE_THERMO_SETUP   2
+#define PROBE_SD_MOUNT       3
+#define PROBE_READ_DEVICE    4
+#define PROBE_READ_CARS      5
+#define PROBE_WIFI_START     6
+#define PROBE_HTML_DEVICE    7
+#define PROBE_HTML_CARS      8
+#define PROBE_HTML_RESULTS   9
+#define PROBE_THERMO_READ   10
+#define PROBE_STABLE_TEMP   11
+#define PROBE_MENU_DRAW     12
+#define PROBE_DISPLAY_TEMPS 13
+#define PROBE_WRITE_MEASURE 14
+#define PROBE_READ_MEASURE  15
+#define PROBE_COUNT         16
+// power management
+#define CLOCK_CHECK_MS      600000   // compare cached clock against RTC every 10 minutes
+#define IDLE_SLEEP_MIN          20   // ms, shorter waits stay awake
+#define IDLE_SLEEP_MAX         100   // ms, cap on one light sleep
+// light sleep stops soft-AP beacons and association, so a phone can only join while the CPU is awake -
+// stay awake this long after boot, after any button press and after the last station leaves
+// (press a button to give a phone time to join once the device has gone quiet)
+#define AP_AWAKE_MS         120000
+#define BATTERY_CAPACITY_MAH  2000   // 4xAA alkaline
+#define CURRENT_ACTIVE_MA      150   // ESP32, soft-AP and TFT awake
+#define CURRENT_SLEEP_MA        40   // light sleep, TFT backlight still on
+// tire measure/display grid layout
+#define GRID_MAX_TIRES     8                      // most tires the layout engine will place
+#define GRID_MAX_POSITIONS 7                      // most positions per tire
+#define GRID_MAX_ROWS      GRID_MAX_TIRES         // tire rows (1 tire per row worst case)
+#define GRID_LAYOUT_CACHE  6                      // cached layouts, one per car tire/position shape
+// measurement journal (LittleFS) so a reset mid-car can resume
+#define JOURNAL_PATH    "/py_journal.bin"
+#define JOURNAL_MAGIC   0x505A                    // 0x5059 journals held float display unit temps
+#define JOURNAL_START   1
+#define JOURNAL_READING 2
+// run group - cars measured back to back, records staged on LittleFS until idle
+#define RUN_GROUP_MAX   16
+#define PENDING_PATH    "/py_pending.txt"
+#define PENDING_DONE_PATH "/py_pending.cnt"   // staged records already copied to SD (Results_Flush)
+// buffered line reader
+// probe faults (thermoFault), reported by Thermo_GetTemp
+#define THERMO_OK       0
+#define THERMO_NO_AMP   1   // amplifier did not acknowledge
+#define THERMO_OPEN     2   // thermocouple open circuit (MCP9601 status)
+#define THERMO_SHORT    3   // thermocouple shorted (MCP9601 status)
+#define THERMO_NO_READ  4   // reading was not a number
+#define THERMO_BEGIN_TRIES  3       // amplifier begin attempts at boot
+#define THERMO_RETRY_MS     5000    // ms between amplifier begin attempts after boot
+// probe contact alert (THERMO_ALERT_PIN)
+#define THERMO_ALERT_NUM    1       // amplifier alert output used
+#define THERMO_CONTACT_RISE 3.0     // degrees C above the cold junction (ambient) that means contact
+#define THERMO_CONTACT_POLL 1000    // ms between pin checks while waiting, the alert wakes it sooner
+#define THERMO_LIFT_POLL    100     // ms between pin checks while waiting for a hot probe to leave the tire
+#define RTC_SETUP_TRIES     5       // RTC begin attempts at boot, then run on millis()
+#define SD_MOUNT_TRIES      100     // microSD mount attempts at boot, then run without card
+// GetStableTemp result
+#define READING_STABLE    0
+#define READING_ESTIMATE  1   // timed out, best estimate (RECORD_FLAG_ESTIMATE)
+#define READING_FAULT     2   // probe fault, no reading
+#define FAULT_SHOW_MS     2000      // probe fault message time
+// stable temp auto-tune (AutoTuneMenu)
+#define TUNE_INSERTIONS   3         // probe insertions recorded on the reference surface
+#define TUNE_PERIOD_MS    250       // recording sample period, candidate delays are multiples of it
+#define TUNE_RECORD_MS    20000     // recording per insertion, slower settings are rejected
+#define TUNE_PLATEAU      8         // last samples of an insertion averaged for its reference temp
+#define TUNE_ACCURACY     0.5       // degrees, every insertion must read this close to its reference
+#define TUNE_TRANSIENT    2.0       // degrees, reference must read this far above the contact sample
+#define TUNE_NO_TRANSIENT -2        // Tune_Record result, insertion was already settled at contact
+// raw sample trace (deviceSettings.traceSamples)
+#define TRACE_PATH        "/py_trace.bin"
+#define TRACE_BUFFER_SIZE 8192      // bytes, about 680 samples - longer positions drop samples
+// probe calibration (CalibrationMenu), curves for every probe in CAL_PATH, the one matching
+// deviceSettings.probeID is applied to each reading
+#define CAL_PATH          "/py_cal.txt"
+#define CAL_MAX_PROBES    8
+#define CAL_ID_MAX        99        // probe IDs 1..CAL_ID_MAX
+#define CAL_CAPTURE_MS    250       // raw sample period while capturing a point
+#define CAL_CAPTURE_AVG   8         // last samples averaged for the captured raw temp
 
-// car info structure
+#define LINE_BLOCK_SIZE   512                          // bytes read from file per refill
+#define LINE_BUFFER_SIZE  (LINE_BLOCK_SIZE + RECORD_LINE_SIZE)  // block plus carried-over partial line
+#define LINE_MAX_LENGTH   (LINE_BUFFER_SIZE - LINE_BLOCK_SIZE - 1)  // longer lines are truncated
+
+// car layout limits, tire/position counts in py_cars.txt are clamped to these
+#define CAR_MAX_TIRES      RECORD_MAX_TIRES       // 8, trucks and trailers
+#define CAR_MAX_POSITIONS  RECORD_MAX_POSITIONS   // 7, multi-point tread scans
+#define CAR_LIST_SIZE      32                     // "walk=" / "reverse=" tire number list text
+// car info structure, names are offsets into the carNames string pool (Pool_Get)
 struct CarSettings
 {
   int carID;
-  char carName[64];
-  char dateTime[32];
-  int tireCount;
-  char tireShortName[6][16];
-  char tireLongName[6][32];
-  int positionCount;
-  char positionShortName[6][16];
-  char positionLongName[3][32];
-  float maxTemp[6];
+  uint16_t carName;
+  uint8_t tireCount;
+  uint8_t positionCount;
+  uint16_t tireShortName[CAR_MAX_TIRES];
+  uint16_t tireLongName[CAR_MAX_TIRES];
+  uint16_t positionShortName[CAR_MAX_POSITIONS];
+  uint16_t positionLongName[CAR_MAX_POSITIONS];
+  float maxTemp[CAR_MAX_TIRES];
+  uint8_t walkOrder[CAR_MAX_TIRES];           // tire indexes in the order they are measured
+  uint8_t reverseMask;                        // bit per tire, positions measured last to first
+};
+// NUL terminated strings packed back to back, offset 0 is always ""
+struct StringPool
+{
+  char* text = NULL;
+  int used = 0;
+  int size = 0;
+};
+// fixed capacity string, no heap - all zero bytes is an empty string so it is safe in calloc'd arrays
+template <size_t N>
+struct InlineString
+{
+  char text[N];
+  InlineString()
+  {
+    text[0] = '\0';
+  }
+  InlineString& operator=(const char* value)
+  {
+    strlcpy(text, value, N);
+    return *this;
+  }
+  InlineString& operator+=(const char* value)
+  {
+    size_t len = strnlen(text, N - 1);
+    strlcpy(&text[len], value, N - len);
+    return *this;
+  }
+  InlineString& operator+=(int value)
+  {
+    char number[12];
+    snprintf(number, sizeof(number), "%d", value);
+    return *this += number;
+  }
+  const char* c_str() const
+  {
+    return text;
+  }
+  size_t length() const
+  {
+    return strnlen(text, N);
+  }
 };
 struct MenuChoice
 {
-  String description;
+  InlineString<MENU_TEXT_SIZE> description;
   int result;
 };
+// calibration reference points for one probe, degrees C
+struct CalProbe
+{
+  int probeID;
+  int pointCount;
+  CalPoint points[CAL_MAX_POINTS];
+};
 // device settings structure
 struct DeviceSettings
 {
@@ -130,6 +334,47 @@ struct DeviceSettings
   float stableBand[2] = {-0.25, 0.25};
   unsigned long stableDelay = 500;
   int stableBuffer = 10;
+  int stableMethod = STABLE_BAND;   // STABLE_BAND, STABLE_SLOPE or STABLE_KALMAN
+  float stableSlope = 0.05;         // slope and kalman method limit, degrees/second
+  float kalmanNoise = 0.25;         // kalman probe reading noise (sigma, degrees)
+  float kalmanRate = 0.05;          // kalman rate noise, how fast dT/dt can change
+  bool traceSamples = false;        // write every probe sample to TRACE_PATH
+  int probeID = 1;                  // calibration curve in CAL_PATH for the fitted probe
+  bool legacyUnits = false;         // units older decimal temp records were written in (true for C)
+};
+// form posted to the web server, queued whole (webFormQueue) for the loop task
+// car names are offsets into its own names pool so the web task never touches carNames
+struct WebForm
+{
+  int pageSource = WEB_PAGE_NONE;
+  int action = WEB_FORM_NONE;
+  CarSettings car = {};
+  StringPool names;                           // freed by whoever drops the form
+  char walkText[CAR_LIST_SIZE] = "";
+  char reverseText[CAR_LIST_SIZE] = "";
+  DeviceSettings device;
+};
+// computed grid for tire measure/display (see ComputeGridLayout)
+struct GridLayout
+{
+  bool valid = false;
+  // values the layout was computed for
+  int tireCount = 0;
+  int positionCount = 0;
+  int requestedFont = 0;
+  int screenWidth = 0;
+  int screenHeight = 0;
+  // results
+  int fontPoints = 12;                        // font used for grid text
+  int cellHeight = 0;                         // height of one line of grid text
+  int cellWidth = 0;                          // width of widest temp text
+  int tiresPerRow = 2;                        // 2 tires side by side, 1 for wide tires
+  int rowCount = 0;                           // rows of tires
+  int lineH[GRID_MAX_ROWS + 1];               // y of horizontal lines
+  int lineV[3];                               // x of vertical lines
+  int lineVCount = 0;
+  int cellX[2 * GRID_MAX_POSITIONS];          // x of text columns, right hand tire columns reversed
+  int cellY[2 * GRID_MAX_ROWS + 1];           // y of text rows, 2 per tire row, last row below grid
 };
 // button debounce structure
 struct UserButton
@@ -138,19 +383,170 @@ struct UserButton
   bool buttonReleased = false;
   bool buttonPressed =  false;
   byte buttonLast =     BUTTON_RELEASED;
+  bool buttonLongPress = false;              // held past BUTTON_LONGPRESS_DELAY
+  bool autoRepeat =     false;               // repeat buttonReleased while held (up/down)
+  int repeatCount = 0;                        // auto-repeat events sent for current press
   unsigned long pressDuration = 0;
   unsigned long releaseDuration = 0;
   unsigned long lastChange = 0;
+  unsigned long lastRepeat = 0;
+};
+// button edge captured by interrupt, debounced in CheckButtons
+struct ButtonEdge
+{
+  uint8_t buttonPin;
+  uint8_t level;
+  unsigned long edgeTime;
+};
+// time spent in light sleep, for battery estimate
+struct PowerStats
+{
+  unsigned long sleepMs = 0;
+  unsigned long sleepCount = 0;
+  int apClients = -1;                         // soft-AP stations at last check
+  unsigned long awakeMs = 0;                  // millis() of last station or button activity (AP_AWAKE_MS)
+};
+// fixed rate sampling in GetStableTemp, absolute deadlines so render time does not stretch the period
+struct SampleSchedule
+{
+  unsigned long periodMs = 0;
+  unsigned long startMs = 0;
+  unsigned long nextMs = 0;                   // next sample deadline
+  unsigned long firstMs = 0;                  // time of the first sample (Sched_Sample)
+  unsigned long lastMs = 0;                   // time of the last sample
+  unsigned long samples = 0;
+  unsigned long overruns = 0;                 // samples that finished after their next deadline
+};
+// timing probe, all times in microseconds
+struct TimingProbe
+{
+  const char* name;
+  uint32_t count;
+  uint32_t lastUs;
+  uint32_t maxUs;
+  uint64_t totalUs;
+};
+// RTC time cached at a seconds boundary and extrapolated with millis() (see Clock_EpochMs)
+struct ClockState
+{
+  bool synced = false;
+  uint32_t syncEpoch = 0;                     // RTC unix time when seconds ticked
+  unsigned long syncMs = 0;                   // millis() at that tick
+  unsigned long checkMs = 0;                  // millis() at last RTC comparison
+  volatile unsigned long edgeMs = 0;          // millis() at last SQW edge, 0 if none seen
+};
+// in-progress measurement journal entry (JOURNAL_PATH), one per stable reading
+struct JournalEntry
+{
+  uint16_t magic;                             // JOURNAL_MAGIC
+  uint8_t type;                               // JOURNAL_START or JOURNAL_READING
+  uint8_t tempIdx;                            // reading index, tire * positionCount + position
+  int32_t carID;
+  uint8_t tireCount;
+  uint8_t positionCount;
+  uint8_t flags;                              // RECORD_FLAG_* for the reading
+  uint8_t reserved;
+  TempCenti temp;
+  uint32_t settleMs;
+  uint64_t epochMs;
+  uint32_t checksum;                          // Journal_Checksum of the bytes above
+};
+// block-buffered file reader, lines are returned in place (see Line_Read)
+struct LineReader
+{
+  File* file = NULL;
+  char buf[LINE_BUFFER_SIZE + 1];
+  int start = 0;                              // first unread byte in buf
+  int end = 0;                                // one past last valid byte in buf
+  bool eof = false;                           // file fully read into buf
+  bool skip = false;                          // discarding rest of an over-long line
+};
+// /api/results chunked response, kept between chunks so spiMutex is only held for one chunk
+struct ResultsStream
+{
+  int carID;                                  // -1 for all cars
+  uint64_t fromMs;
+  uint64_t toMs;
+  int carIdx;                                 // car whose results file is being read
+  uint32_t fileOffset;                        // next line in that file
+  int recordCount;
+  bool started;                               // opening text formatted
+  bool finished;                              // closing text formatted
+  char text[RECORD_LINE_SIZE];                // formatted JSON not yet sent
+  int textLen;
+  int textSent;
+  LineReader reader;
+};
+// results page written a few records per idle step, kept between steps (Results_HTMLStep)
+struct ResultsHTMLWriter
+{
+  bool active = false;
+  fs::FS* fs = NULL;                          // page file system, results files are on SD
+  int pass = 0;                               // 0 table rows, 1 raw text
+  int fileIdx = 0;                            // py_temps_N being read
+  int rowCount = 0;
+  bool subHeader = false;                     // next record starts a results file
+  File fileIn;
+  File fileOut;
+  LineReader reader;
+};
+// Print into a fixed buffer, output that does not fit sets overflow
+struct BufferPrint : public Print
+{
+  char* buf;
+  size_t size;
+  size_t len = 0;
+  bool overflow = false;
+  BufferPrint(char* outBuf, size_t outSize) : buf(outBuf), size(outSize) {}
+  size_t write(uint8_t chr)
+  {
+    if(len >= size)
+    {
+      overflow = true;
+      return 0;
+    }
+    buf[len++] = chr;
+    return 1;
+  }
+  size_t write(const uint8_t* data, size_t count)
+  {
+    size_t written = 0;
+    while((written < count) && (write(data[written]) == 1))
+    {
+      written++;
+    }
+    return written;
+  }
+};
+// progress line from boot tasks
+struct BootMessage
+{
+  char text[64];
 };
 // button structure list
 UserButton buttons[BUTTON_COUNT];
+// button edges from interrupt
+QueueHandle_t buttonQueue = NULL;
 // car list from setup file
 CarSettings* cars;
+// car, tire and position names for cars
+StringPool carNames;
+// time of last measurement (tireTemps), epoch ms
+uint64_t measureEpochMs = 0;
 // device settings from file
 DeviceSettings deviceSettings;
-// tire temp array - max of 6 tires, 3 readings per tire
-float tireTemps[18];
-float currentTemps[18];
+// light sleep statistics
+PowerStats powerStats;
+// cached RTC time
+ClockState clockState;
+// tire temp matrix (tires x positions), sized for the largest car when cars load (Measure_Resize)
+TempCenti* tireTemps = NULL;
+// epoch ms each tire temp went stable (0 = not measured) and ms it took to settle
+uint64_t* tireTimes = NULL;
+uint32_t* tireSettleMs = NULL;
+// RECORD_FLAG_* for each tire temp
+uint8_t* tireFlags = NULL;
+int measureCapacity = 0;
 
 // devices
 // thermocouple amplifier
@@ -162,8 +558,41 @@ Adafruit_MCP9600 tempSensor;
 Adafruit_MCP9601 tempSensor;
 #define I2C_ADDRESS_THERMO 0x67
 #endif
-// temp values for stabilization calculation
-float tempValues[100];
+// amplifier filter coefficient, off for the kalman method (it does its own filtering)
+#define THERMO_FILTER_DEFAULT 3
+#define THERMO_FILTER_KALMAN  0
+int thermoFilter = -1;
+// amplifier state, THERMO_* fault from the last reading
+bool thermoPresent = false;
+int thermoFault = THERMO_NO_AMP;
+unsigned long thermoRetryMs = 0;
+// raw values from the last reading, degrees C and amplifier status
+float thermoHotC = 0.0F;
+uint8_t thermoStatus = 0;
+const char* thermoFaultNames[] = {"OK", "No amplifier", "Probe open", "Probe shorted", "No reading"};
+// contact alert armed (wakes light sleep) and millis() of its last edge
+bool thermoAlertArmed = false;
+int thermoAlertWake = LOW;          // alert level that wakes light sleep, HIGH while waiting for the probe to lift
+volatile unsigned long thermoAlertMs = 0;
+// band method window
+BandDetector bandDetector;
+// slope method window
+SlopeDetector slopeDetector;
+// kalman method estimate
+KalmanEstimator kalmanEstimator;
+// sample timing of the last stable temp measurement
+SampleSchedule sampleSchedule;
+const char* stableMethodNames[STABLE_METHOD_COUNT] = {"Band", "Slope", "Kalman"};
+// raw sample trace ring, allocated on first use
+TraceBuffer traceBuffer;
+uint8_t* traceData = NULL;
+TraceStart traceStart;
+bool traceActive = false;
+bool traceFileChecked = false;     // TRACE_PATH header version checked since boot
+// calibration curves from CAL_PATH and the table for deviceSettings.probeID (Cal_Select)
+CalProbe calProbes[CAL_MAX_PROBES];
+int calProbeCount = 0;
+CalTable calTable;
 
 #ifdef RTC_8563
 RTC_PCF8563 rtc;
@@ -175,8 +604,8 @@ RTC_DS3231 rtc;
 bool century = false;
 bool h12Flag;
 bool pmFlag;
-String days[7] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri","Sat"};
-String ampmStr[3] = {"am", "pm", "\0"};
+const char* days[7] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri","Sat"};
+const char* ampmStr[3] = {"am", "pm", ""};
 
 // TFT display
 TFT_eSPI tftDisplay = TFT_eSPI();
@@ -192,25 +621,67 @@ int tireIdx = 0;
 int measIdx = 0;
 float tempRes = 1.0;
 // initial state of pyrometer (show main menu)
-int deviceState = 0;
+int deviceState = DEVICE_BOOT;
 
 IPAddress IP;
 AsyncWebServer server(80);
+// boot task sync and progress
+EventGroupHandle_t bootEvents = NULL;
+QueueHandle_t bootLogQueue = NULL;
+// SD and TFT share the SPI bus
+SemaphoreHandle_t spiMutex = NULL;
+// HTML pages to regenerate when idle
+uint8_t htmlPending = 0;
+// results page part written (HTML_RESULTS restarts it)
+ResultsHTMLWriter resultsHTML;
+// web forms waiting to be applied (Web_ApplyForms)
+QueueHandle_t webFormQueue = NULL;
+// run group car indexes in measure order, idle updates wait while a run group is active
+int runGroup[RUN_GROUP_MAX];
+int runGroupCount = 0;
+bool runGroupActive = false;
+// init stage and hot path timing, shown on diagnostics screen and /api/diag
+TimingProbe timingProbes[PROBE_COUNT] = 
+{
+  {"Boot total"},
+  {"RTC_Setup"},
+  {"Thermo_Setup"},
+  {"SD.begin"},
+  {"ReadDeviceSetupFile"},
+  {"ReadCarSetupFile"},
+  {"WiFi/web start"},
+  {"WriteDeviceSetupHTML"},
+  {"WriteCarSetupHTML"},
+  {"WriteResultsHTML"},
+  {"Thermo_GetTemp"},
+  {"GetStableTemp"},
+  {"MenuSelect draw"},
+  {"DisplayAllTireTemps draw"},
+  {"WriteMeasurementFile"},
+  {"ReadMeasurementFile"}
+};
 //
-// grid lines for temp measure/display
+// grid layouts for temp measure/display, computed on first use for each tire/position shape
 //
-int gridLineH[4][2][2];   //  4 vertical lines, 2 points per line, 2 values per point (X and Y)
-int gridLineV[3][2][2];   //  3 vertical lines, 2 points per line, 2 values per point (X and Y)
-int cellPoint[7][6][2];   //  6 max rows, 6 points per cell, 2 values per point (X and Y)
+GridLayout gridLayouts[GRID_LAYOUT_CACHE];
+int gridLayoutNext = 0;
 
 // FUNCTION PROTOTYPES
 // required
 void setup();
 void loop();
+// boot tasks and web server
+void BootI2CTask(void* param);
+void BootSDTask(void* param);
+void BootWiFiTask(void* param);
+void BootLog(const char* text);
+void WebServerSetup();
 // user interface
 // menu generators call MenuSelect with the list of selections and returned state
 void MainMenu();
 void SelectCarMenu();
+void RunGroupMenu();
+void MeasureRunGroup();
 void SelectedResultsMenu(fs::FS &fs, const char * path);
 void ChangeSettingsMenu();
 void Select12or24Menu();
@@ -218,10 +689,54 @@ void SelectFontSizeMenu();
 void SetUnitsMenu();
 void SetStableBandwidthMenu();
 void SetStableDelayMenu();
+void SetStableMethodMenu();
+void SetStableSlopeMenu();
+void AutoTuneMenu();
+int Tune_Record(float* times, float* temps, int maxSamples, int insertion);
+bool Tune_Search(const float* times, const float* temps, const int* counts, int maxSamples, StableParams& best,
+                 unsigned long& bestDelay, float& bestSec);
+void CalibrationMenu();
+void SetProbeIDMenu();
+bool Cal_Capture(float& rawC);
+float Cal_EnterReference(float startTemp);
+int Cal_FindProbe(int probeID, bool add);
+void Cal_Select(int probeID);
 void DeleteDataFilesMenu(bool verify = true);
+void DiagnosticsMenu();
 int MenuSelect(int fontSize, MenuChoice choices[], int menuCount, int initialSelect);
 // set date/time values
 void SetDateTime();
+// car name string pool
+uint16_t Pool_Add(StringPool& pool, const char* value);
+const char* Pool_Get(const StringPool& pool, uint16_t offset);
+void Pool_Reset(StringPool& pool);
+void Car_CompactNames();
+void Car_GetRecord(const CarSettings& car, uint64_t epochMs, MeasureRecord& record);
+int Car_ClampCount(int count, int maxCount);
+void Car_DefaultWalk(CarSettings& car);
+int Car_ParseTireList(const char* text, int tires[], int maxCount);
+bool Car_SetWalk(CarSettings& car, const char* text);
+void Car_SetReverse(CarSettings& car, const char* text);
+char* Car_FormatWalk(const CarSettings& car, char* buf, int bufSize);
+char* Car_FormatReverse(const CarSettings& car, char* buf, int bufSize);
+int Car_WalkStep(const CarSettings& car, int tireIdx);
+int Car_PositionAt(const CarSettings& car, int tireIdx, int step);
+bool Measure_Resize();
+void Measure_Clear();
+char* Results_TimeText(const MeasureRecord& record, char* buf, int bufSize);
+void Results_PrintJSONString(Print& out, const char* text);
+void Results_WriteJSONRecord(Print& out, int carID, MeasureRecord& record, bool first);
+size_t Results_FillJSON(ResultsStream& stream, uint8_t* buffer, size_t maxLen);
+void Web_SendFile(AsyncWebServerRequest* request, const char* path, const char* contentType);
+const char* Web_ContentType(const char* path);
+// in-progress measurement journal
+uint32_t Journal_Checksum(const JournalEntry& entry);
+bool Journal_Write(JournalEntry& entry, const char* mode);
+void Journal_Start(int carID, int tireCount, int positionCount);
+void Journal_Append(int tempIdx, TempCenti temp, uint32_t settleMs, uint64_t epochMs, uint8_t flags);
+void Journal_Clear();
+bool Journal_Load(int& carIdx, int& readingCount);
+bool Journal_Resume();
 // read, write, generate HTML for setup files and results
 void ReadCarSetupFile(fs::FS &fs, const char * path);
 void WriteCarSetupFile(fs::FS &fs, const char * path);
@@ -229,23 +744,42 @@ void WriteCarSetupHTML(fs::FS &fs, const char * path, int carIdx);
 void ReadDeviceSetupFile(fs::FS &fs, const char * path);
 void WriteDeviceSetupFile(fs::FS &fs, const char * path);
 void WriteDeviceSetupHTML(fs::FS &fs, const char * path);
+void ReadCalibrationFile(fs::FS &fs, const char * path);
+void WriteCalibrationFile(fs::FS &fs, const char * path);
 void WriteResultsHTML(fs::FS &fs);
-void ReadMeasurementFile(char buf[], CarSettings &currentResultCar);
-void WriteMeasurementFile();
+bool Results_HTMLBegin(fs::FS &fs);
+bool Results_HTMLStep();
+void Results_HTMLCancel();
+void Results_HTMLTableRow(ResultsHTMLWriter& writer, MeasureRecord& record);
+void Results_HTMLTextRow(ResultsHTMLWriter& writer, MeasureRecord& record);
+void Results_HTMLTableEnd(ResultsHTMLWriter& writer);
+void Results_HTMLEnd(ResultsHTMLWriter& writer);
+void UpdatePendingHTML();
+bool Web_ApplyForms();
+void Web_ApplyForm(WebForm& form);
+bool ReadMeasurementFile(char buf[], MeasureRecord& record);
+void WriteMeasurementFile(bool staged = false);
+void Results_Stage(const char* fileName, const char* record);
+int Results_FlushedCount();
+void Results_SetFlushedCount(int count);
+bool Results_EndsWith(fs::FS &fs, const char* path, const char* line);
+bool Results_Flush();
 
 // measure and display tire temps, TFT specific functions
 // single tire version of tire temp measure
-void MeasureAllTireTemps();
+void MeasureAllTireTemps(bool resume = false, bool inRunGroup = false);
 int MeasureTireTemps(int tire); // measure single tire temps full screen
-float GetStableTemp(int row, int col);
+int GetStableTemp(int positionIdx, int row, int col, float& stableTemp);
 int GetNextTire(int selTire, int nextDirection);
 // current probe temp
 void InstantTemp();
 // display results
-void DrawTireMeasureGrid(int tireCount);
-void SetupTireMeasureGrid(int fontHeight);
-void DisplayAllTireTemps(CarSettings currentResultCar);
-void DrawCellText(int row, int col, char* text, uint16_t textColor, uint16_t backColor);
+void DrawTireMeasureGrid(const GridLayout& layout);
+void SetupTireMeasureGrid();
+GridLayout* GetGridLayout(int tireCount, int positionCount);
+void ComputeGridLayout(GridLayout& layout, int tireCount, int positionCount);
+void DisplayAllTireTemps(const MeasureRecord& record);
+void DrawCellText(const GridLayout& layout, int row, int col, char* text, uint16_t textColor, uint16_t backColor);
 // rotate display (right/left hand orientation)
 void RotateDisplay(bool rotateButtons);
 // set font size
@@ -261,17 +795,54 @@ float FtoCAbsolute(float tempF);
 float FtoCRelative(float tempF);
 // date, time, RTC
 bool RTC_IsPM();
-String RTC_GetStringTime();
-String RTC_GetStringDate();
+char* RTC_GetStringTime(char* buf, int bufSize);
+char* RTC_GetStringDate(char* buf, int bufSize);
 DateTime RTC_DateTime();
 void RTC_SetDateTime(DateTime timeVal);
 void RTC_SetDateTime(int year, int month, int date, int hour, int minute, int second);
+void Clock_Sync();
+void Clock_Check();
+uint64_t Clock_EpochMs();
+DateTime Clock_Now();
+char* Clock_FormatEpoch(uint64_t epochMs, char* buf, int bufSize);
+void IRAM_ATTR Clock_SqwISR();
 void Thermo_Setup();
+bool Thermo_Begin();
 float Thermo_GetTemp();
+void Thermo_SetFilter(int coefficient);
+void Thermo_AlertArm(bool arm);
+bool Thermo_AlertActive();
+bool Thermo_WaitContact(int row);
+void IRAM_ATTR Thermo_AlertISR();
 // user input (button presses)
+void ButtonSetup();
+void IRAM_ATTR ButtonISR(void* arg);
 void CheckButtons(unsigned long curTime);
+void UpdateButton(int btnIdx, byte curState, unsigned long curTime);
+byte ButtonState(int level);
+bool WaitButtonEvent(unsigned long timeout);
+// power management
+bool Power_CanSleep(unsigned long timeout);
+bool Power_LightSleep(unsigned long timeout, bool wakeOnButtons);
+void Power_IdleDelay(unsigned long timeout);
+void Sched_Begin(SampleSchedule& schedule, unsigned long periodMs);
+void Sched_Sample(SampleSchedule& schedule);
+void Sched_WaitNext(SampleSchedule& schedule);
+float Sched_RateHz(const SampleSchedule& schedule);
+// raw sample trace
+void Trace_Start(int tempIdx);
+void Trace_Sample();
+void Trace_End(int result, float temp);
+void Trace_Flush();
+void Power_UpdateWiFi();
+float Power_BatteryHours();
+// timing probes
+uint32_t Probe_Start();
+void Probe_Stop(int probeIdx, uint32_t startUs);
+void Probe_WriteJSON(Print& out);
 // SD and LittleFS file handling
-void ReadLine(File file, char* buf);
-void AppendFile(fs::FS &fs, const char * path, const char * message);
+void Line_Begin(LineReader& reader, File& file);
+char* Line_Read(LineReader& reader);
+bool AppendFile(fs::FS &fs, const char * path, const char * message);
 void DeleteFile(fs::FS &fs, const char * path);
 void ListDirectory(fs::FS &fs, const char * dirname, uint8_t levels);
@@ -33,6 +33,7 @@ void setup()
 {
   char outStr[128];
   Serial.begin(115200);
+  uint32_t bootStart = Probe_Start();
   // location of text
   textPosition[0] = 5;
   textPosition[1] = 0;
@@ -64,7 +65,70 @@ void setup()
   tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
   tftDisplay.drawString("Yamura Motors LLC Recording Pyrometer", textPosition[0], textPosition[1], GFXFF);
   textPosition[1] += fontHeight;
-  //
+
+  // user buttons setup
+  ButtonSetup();
+
+  // bring up RTC/thermocouple (I2C), SD/settings and WiFi in parallel
+  // tasks report progress through BootLog, only this task draws on the TFT
+  bootEvents = xEventGroupCreate();
+  bootLogQueue = xQueueCreate(BOOT_LOG_SIZE, sizeof(BootMessage));
+  webFormQueue = xQueueCreate(WEB_FORM_QUEUE_SIZE, sizeof(WebForm));
+  spiMutex = xSemaphoreCreateMutex();
+  xTaskCreatePinnedToCore(BootI2CTask,  "bootI2C",  4096, NULL, 1, NULL, 0);
+  xTaskCreatePinnedToCore(BootSDTask,   "bootSD",   8192, NULL, 1, NULL, 0);
+  xTaskCreatePinnedToCore(BootWiFiTask, "bootWiFi", 4096, NULL, 1, NULL, 0);
+  BootMessage message;
+  while(true)
+  {
+    while(xQueueReceive(bootLogQueue, &message, 0) == pdTRUE)
+    {
+      xSemaphoreTake(spiMutex, portMAX_DELAY);
+      tftDisplay.drawString(message.text, textPosition[0], textPosition[1], GFXFF);
+      xSemaphoreGive(spiMutex);
+      textPosition[1] += fontHeight;
+    }
+    if((xEventGroupGetBits(bootEvents) & BOOT_ALL) == BOOT_ALL)
+    {
+      break;
+    }
+    // wait for next message or stage
+    xQueuePeek(bootLogQueue, &message, pdMS_TO_TICKS(20));
+  }
+  // from here the loop task owns the SPI bus, WaitButtonEvent lends it to the web server while waiting
+  xSemaphoreTake(spiMutex, portMAX_DELAY);
+  // HTML pages regenerate when idle in the menus
+  htmlPending = HTML_DEVICE | HTML_CARS | HTML_RESULTS;
+  // run group records staged before a reset still need copying to SD
+  if(LittleFS.exists(PENDING_PATH))
+  {
+    htmlPending |= HTML_RECORDS;
+  }
+
+  sprintf(outStr, "IP %d.%d.%d.%d", IP[0], IP[1], IP[2], IP[3]);
+  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+  textPosition[1] += fontHeight;
+  sprintf(outStr, "Password %s", deviceSettings.pass);
+  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+  textPosition[1] += fontHeight;
+  SetupTireMeasureGrid();
+  Probe_Stop(PROBE_BOOT, bootStart);
+  #ifdef DEBUG_VERBOSE
+  Serial.printf("boot complete %lu ms\n", timingProbes[PROBE_BOOT].lastUs / 1000);
+  #endif
+
+  RotateDisplay(deviceSettings.screenRotation != 0);
+  // interrupted measurement from before the reset
+  // state leaves DEVICE_BOOT only after the prompt, so web edits wait for it
+  deviceState = Journal_Resume() ? RESUME_TIRES : DISPLAY_MENU;
+}
+//
+// boot task - I2C bus, RTC and thermocouple amp
+//
+void BootI2CTask(void* param)
+{
+  char outStr[128];
+  unsigned long stageStart = millis();
   // start I2C
   int sda = I2C_SDA;
   int scl = I2C_SCL;
@@ -73,134 +137,190 @@ void setup()
   Wire.setPins(sda, scl);
   Wire.begin();
   Wire.setClock(100000);
-  delay(5000);
+  uint32_t probeStart;
 
   // RTC setup
   #ifdef HAS_RTC
-  while (!RTC_Setup()) 
+  probeStart = Probe_Start();
+  bool rtcFound = false;
+  for(int tryIdx = 0; tryIdx < RTC_SETUP_TRIES; tryIdx++)
   {
+    rtcFound = RTC_Setup();
+    if(rtcFound)
+    {
+      break;
+    }
     #ifdef DEBUG_VERBOSE
     Serial.println("Couldn't find RTC...retry");
     #endif
-    tftDisplay.drawString("Couldn't find RTC", textPosition[0], textPosition[1], GFXFF);
-    textPosition[1] += fontHeight;
-    delay(1000);
+    BootLog("Couldn't find RTC");
+    vTaskDelay(pdMS_TO_TICKS(1000));
+  }
+  // without the RTC the clock stays unsynced, Clock_EpochMs is millis() since boot
+  if(rtcFound)
+  {
+    Clock_Sync();
+  }
+  else
+  {
+    BootLog("No RTC, times are from boot");
   }
+  Probe_Stop(PROBE_RTC_SETUP, probeStart);
   #ifdef SET_TO_SYSTEM_TIME
   Serial.println("Set date and time to system");
   delay(5000);
   RTC_SetDateTime(DateTime(F(__DATE__), F(__TIME__)));
   #endif
-  String tmpTimeStr = "RTC OK ";
-  tmpTimeStr += RTC_GetStringTime();
-  tmpTimeStr += " ";
-  tmpTimeStr += RTC_GetStringDate();
-  tftDisplay.drawString(tmpTimeStr.c_str(), textPosition[0], textPosition[1], GFXFF);
-  textPosition[1] += fontHeight;
+  char timeStr[RTC_STRING_SIZE];
+  char dateStr[RTC_STRING_SIZE];
+  if(rtcFound)
+  {
+    sprintf(outStr, "RTC OK %s %s (%lu ms)", RTC_GetStringTime(timeStr, sizeof(timeStr)), RTC_GetStringDate(dateStr, sizeof(dateStr)), millis() - stageStart);
+    BootLog(outStr);
+  }
   #endif
 
-
   // thermocouple amp setup
+  probeStart = Probe_Start();
   Thermo_Setup();
-
-  // user buttons setup
-  for(int idx = 0; idx < BUTTON_COUNT; idx++)
-  {
-    pinMode(buttons[idx].buttonPin, INPUT_PULLUP);
-  }
-  
+  Probe_Stop(PROBE_THERMO_SETUP, probeStart);
+  xEventGroupSetBits(bootEvents, BOOT_I2C_DONE);
+  vTaskDelete(NULL);
+}
+//
+// boot task - LittleFS, microSD, device and car setup files
+// holds spiMutex while using the SD card, it shares the SPI bus with the TFT
+//
+void BootSDTask(void* param)
+{
+  char outStr[128];
+  unsigned long stageStart = millis();
   #ifdef DEBUG_VERBOSE
   Serial.println( " initializing LittleFS" );
   #endif
-  if(!LittleFS.begin(FORMAT_LITTLEFS_IF_FAILED)){
-      #ifdef DEBUG_VERBOSE
-      Serial.println("LittleFS Mount Failed");
-      #endif
-      tftDisplay.drawString("LittleFS Mount Failed", textPosition[0], textPosition[1], GFXFF);
-      textPosition[1] += fontHeight;
-      return;
+  if(!LittleFS.begin(FORMAT_LITTLEFS_IF_FAILED))
+  {
+    #ifdef DEBUG_VERBOSE
+    Serial.println("LittleFS Mount Failed");
+    #endif
+    BootLog("LittleFS Mount Failed");
   }
   #ifdef DEBUG_VERBOSE
-  Serial.println( "LittleFS initialized" );
-  Serial.println("Files on LittleFS");
-  ListDirectory(LittleFS, "/", 3);
+  else
+  {
+    Serial.println( "LittleFS initialized" );
+    Serial.println("Files on LittleFS");
+    ListDirectory(LittleFS, "/", 3);
+  }
   #endif
 
   #ifdef DEBUG_VERBOSE
   Serial.println( "initializing microSD" );
   #endif
-
   int failCount = 0;
-  while(!SD.begin(SD_CS))
+  uint32_t probeStart = Probe_Start();
+  while(true)
   {
+    xSemaphoreTake(spiMutex, portMAX_DELAY);
+    bool mounted = SD.begin(SD_CS);
+    xSemaphoreGive(spiMutex);
+    if(mounted)
+    {
+      break;
+    }
     #ifdef DEBUG_VERBOSE
     Serial.println("microSD card mount failed");
     #endif
     failCount++;
     if(failCount == 1)
     {
-      tftDisplay.drawString("Initializing SD card", textPosition[0], textPosition[1], GFXFF);
-   }
-    else if(failCount > 1)
+      BootLog("Initializing SD card");
+    }
+    else if(failCount % 10 == 0)
     {
       sprintf(outStr, "microSD card mount failed after %d attempts", failCount);
-      tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+      BootLog(outStr);
     }
-    if(failCount > 100)
+    if(failCount >= SD_MOUNT_TRIES)
     {
-      while(true) { }
+      // cardType is CARD_NONE below, settings stay at defaults
+      BootLog("No microSD card, running without it");
+      break;
     }
-    delay(1000);
+    vTaskDelay(pdMS_TO_TICKS(1000));
   }
-  tftDisplay.drawString("SD initialized           ", textPosition[0], textPosition[1], GFXFF);
-  textPosition[1] += fontHeight;
+  Probe_Stop(PROBE_SD_MOUNT, probeStart);
+  sprintf(outStr, "SD initialized (%lu ms)", millis() - stageStart);
+  BootLog(outStr);
+  xSemaphoreTake(spiMutex, portMAX_DELAY);
   uint8_t cardType = SD.cardType();
-  if(cardType == CARD_NONE)
+  #ifdef DEBUG_VERBOSE
+  if(cardType != CARD_NONE)
   {
-    return;
+    Serial.println( "SD initialized" );
+    Serial.println("Files on SD");
+    ListDirectory(SD, "/", 3);
   }
-  uint64_t cardSize = SD.cardSize() / (1024 * 1024);
-  #ifdef DEBUG_VERBOSE
-  Serial.println( "SD initialized" );
-  Serial.println("Files on SD");
-  ListDirectory(SD, "/", 3);
-  #endif
-
-  tftDisplay.drawString("Read device setup        ", textPosition[0], textPosition[1], GFXFF);
-  delay(1000);
-  //textPosition[1] += fontHeight;
-  ReadDeviceSetupFile(SD,  "/py_set.txt");
-  WriteDeviceSetupHTML(SD, "/py_set.html");
-  //WriteDeviceSetupHTML(LittleFS, "/py_set.html");
-
-  tftDisplay.drawString("Read cars setup          ", textPosition[0], textPosition[1], GFXFF);
-  delay(1000);
-  //textPosition[1] += fontHeight;
-  ReadCarSetupFile(SD,  "/py_cars.txt");
-  WriteCarSetupHTML(SD, "/py_cars.html", carSetupIdx);
-  //WriteCarSetupHTML(LittleFS, "/py_cars.html", carSetupIdx);
-
-  tftDisplay.drawString("Write results to HTML    ", textPosition[0], textPosition[1], GFXFF);
-  textPosition[1] += fontHeight;
-  WriteResultsHTML(SD);
-  //WriteResultsHTML(LittleFS);
-
-  #ifdef HAS_RTC
-  // get time from RTC
-  sprintf(outStr, "%s %s", RTC_GetStringTime().c_str(), RTC_GetStringDate().c_str());
-  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
-  textPosition[1] += fontHeight;
-  #endif
-  deviceState = DISPLAY_MENU;
-
-  
-  
-  #ifdef DEBUG_VERBOSE
-  ListDirectory(LittleFS, "/", 1);
   #endif
+  if(cardType != CARD_NONE)
+  {
+    probeStart = Probe_Start();
+    ReadDeviceSetupFile(SD,  "/py_set.txt");
+    Probe_Stop(PROBE_READ_DEVICE, probeStart);
+    ReadCalibrationFile(SD, CAL_PATH);
+  }
+  Cal_Select(deviceSettings.probeID);
+  xSemaphoreGive(spiMutex);
+  // WiFi can start once SSID and password are known
+  xEventGroupSetBits(bootEvents, BOOT_SETTINGS_DONE);
+  BootLog("Read device setup");
 
+  if(cardType != CARD_NONE)
+  {
+    xSemaphoreTake(spiMutex, portMAX_DELAY);
+    probeStart = Probe_Start();
+    ReadCarSetupFile(SD,  "/py_cars.txt");
+    Probe_Stop(PROBE_READ_CARS, probeStart);
+    xSemaphoreGive(spiMutex);
+  }
+  sprintf(outStr, "Read cars setup (%lu ms)", millis() - stageStart);
+  BootLog(outStr);
+  xEventGroupSetBits(bootEvents, BOOT_SD_DONE);
+  vTaskDelete(NULL);
+}
+//
+// boot task - soft-AP and web server, after device settings are read
+//
+void BootWiFiTask(void* param)
+{
+  char outStr[128];
+  xEventGroupWaitBits(bootEvents, BOOT_SETTINGS_DONE, pdFALSE, pdTRUE, portMAX_DELAY);
+  unsigned long stageStart = millis();
+  uint32_t probeStart = Probe_Start();
   WiFi.softAP(deviceSettings.ssid, deviceSettings.pass);
   IP = WiFi.softAPIP();
+  WebServerSetup();
+  Probe_Stop(PROBE_WIFI_START, probeStart);
+  sprintf(outStr, "WiFi started (%lu ms)", millis() - stageStart);
+  BootLog(outStr);
+  xEventGroupSetBits(bootEvents, BOOT_WIFI_DONE);
+  vTaskDelete(NULL);
+}
+//
+// queue a progress line for the boot screen
+//
+void BootLog(const char* text)
+{
+  BootMessage message;
+  strncpy(message.text, text, sizeof(message.text) - 1);
+  message.text[sizeof(message.text) - 1] = '\0';
+  xQueueSend(bootLogQueue, &message, pdMS_TO_TICKS(100));
+}
+//
+// web server pages and form handling
+//
+void WebServerSetup()
+{
   // Web Server Root URL
   Serial.println("starting webserver");
   server.on("/", HTTP_GET, [](AsyncWebServerRequest *request)
@@ -208,19 +328,70 @@ void setup()
     #ifdef DEBUG_VERBOSE
     Serial.println("HTTP_GET, send /py_main.html from LittleFS");
     #endif
-    request->send(/*LittleFS*/SD, "/py_main.html", "text/html");
+    Web_SendFile(request, "/py_main.html", "text/html");
+  });
+  // other pages and files from SD, read under spiMutex (Web_SendFile)
+  server.onNotFound([](AsyncWebServerRequest *request)
+  {
+    Web_SendFile(request, request->url().c_str(), Web_ContentType(request->url().c_str()));
+  });
+  // timing probes as JSON
+  server.on("/api/diag", HTTP_GET, [](AsyncWebServerRequest *request)
+  {
+    AsyncResponseStream *response = request->beginResponseStream("application/json");
+    Probe_WriteJSON(*response);
+    request->send(response);
+  });
+  // stored results in a time window as JSON - /api/results?car=<id>&from=<epoch ms>&to=<epoch ms>
+  server.on("/api/results", HTTP_GET, [](AsyncWebServerRequest *request)
+  {
+    int carID = -1;
+    uint64_t fromMs = 0;
+    uint64_t toMs = UINT64_MAX;
+    if(request->hasParam("car"))
+    {
+      carID = atoi(request->getParam("car")->value().c_str());
+    }
+    if(request->hasParam("from"))
+    {
+      fromMs = strtoull(request->getParam("from")->value().c_str(), NULL, 10);
+    }
+    if(request->hasParam("to"))
+    {
+      toMs = strtoull(request->getParam("to")->value().c_str(), NULL, 10);
+    }
+    // sent a chunk at a time, freed with the response
+    std::shared_ptr<ResultsStream> stream((ResultsStream*)calloc(1, sizeof(ResultsStream)), free);
+    if(!stream)
+    {
+      request->send(503, "text/plain", "Pyrometer busy, try again");
+      return;
+    }
+    stream->carID = carID;
+    stream->fromMs = fromMs;
+    stream->toMs = toMs;
+    AsyncWebServerResponse* response = request->beginChunkedResponse("application/json",
+      [stream](uint8_t* buffer, size_t maxLen, size_t index) -> size_t
+      {
+        // SD card and car list, the loop task gives these up while it waits for a button
+        if(xSemaphoreTake(spiMutex, pdMS_TO_TICKS(WEB_CHUNK_WAIT_MS)) != pdTRUE)
+        {
+          return RESPONSE_TRY_AGAIN;
+        }
+        size_t len = Results_FillJSON(*stream, buffer, maxLen);
+        xSemaphoreGive(spiMutex);
+        return len;
+      });
+    request->send(response);
   });
-  
-  server.serveStatic("/", /*LittleFS*/SD, "/");
   server.on("/", HTTP_POST, [](AsyncWebServerRequest *request) 
   {
     #ifdef DEBUG_VERBOSE
     Serial.println("HTTP_POST");
     #endif
+    // only parsed here, cars, carNames and settings are changed on the loop task (Web_ApplyForms)
     int params = request->params();
-    int pageSource = 0;
-    CarSettings tempCar;
-    DeviceSettings tempDevice;
+    WebForm form;
     char valueCheck[32];
     bool forceContinue = false;
     for(int i=0; i < params; i++)
@@ -239,40 +410,50 @@ void setup()
       // car settings
       if (strcmp(p->name().c_str(), "car_id") == 0)
       {
-        strcpy(tempCar.carName, p->value().c_str());
-        pageSource = 1;
+        form.car.carName = Pool_Add(form.names, p->value().c_str());
+        form.pageSource = WEB_PAGE_CARS;
         continue;
       }
       if (strcmp(p->name().c_str(), "tirecount_id") == 0)
       {
-        tempCar.tireCount = atoi(p->value().c_str());
+        form.car.tireCount = Car_ClampCount(atoi(p->value().c_str()), CAR_MAX_TIRES);
         continue;
       }
       if (strcmp(p->name().c_str(), "measurecount_id") == 0)
       {
-        tempCar.positionCount = atoi(p->value().c_str());
+        form.car.positionCount = Car_ClampCount(atoi(p->value().c_str()), CAR_MAX_POSITIONS);
+        continue;
+      }
+      if (strcmp(p->name().c_str(), "walk_id") == 0)
+      {
+        strlcpy(form.walkText, p->value().c_str(), sizeof(form.walkText));
         continue;
       }
-      for(int tireIdx = 0; tireIdx < 6; tireIdx++)
+      if (strcmp(p->name().c_str(), "reverse_id") == 0)
+      {
+        strlcpy(form.reverseText, p->value().c_str(), sizeof(form.reverseText));
+        continue;
+      }
+      for(int tireIdx = 0; tireIdx < CAR_MAX_TIRES; tireIdx++)
       {
         sprintf(valueCheck, "tire%d_full_id", tireIdx);
         if (strcmp(p->name().c_str(), valueCheck) == 0)
         {
-          strcpy(tempCar.tireLongName[tireIdx], p->value().c_str());
+          form.car.tireLongName[tireIdx] = Pool_Add(form.names, p->value().c_str());
           forceContinue = true;
           break;
         }
         sprintf(valueCheck, "tire%d_short_id", tireIdx);
         if (strcmp(p->name().c_str(), valueCheck) == 0)
         {
-          strcpy(tempCar.tireShortName[tireIdx], p->value().c_str());
+          form.car.tireShortName[tireIdx] = Pool_Add(form.names, p->value().c_str());
           forceContinue = true;
           break;
         }
         sprintf(valueCheck, "tire%d_maxt_id", tireIdx);
         if (strcmp(p->name().c_str(), valueCheck) == 0)
         {
-          tempCar.maxTemp[tireIdx] = atof(p->value().c_str());
+          form.car.maxTemp[tireIdx] = atof(p->value().c_str());
           forceContinue = true;
           break;
         }
@@ -281,19 +462,19 @@ void setup()
       {
         continue;
       }
-      for(int posIdx = 0; posIdx < 3; posIdx++)
+      for(int posIdx = 0; posIdx < CAR_MAX_POSITIONS; posIdx++)
       {
         sprintf(valueCheck, "position%d_full_id", posIdx);
         if (strcmp(p->name().c_str(), valueCheck) == 0)
         {
-          strcpy(tempCar.positionLongName[posIdx], p->value().c_str());
+          form.car.positionLongName[posIdx] = Pool_Add(form.names, p->value().c_str());
           forceContinue = true;
           break;
         }
         sprintf(valueCheck, "position%d_short_id", posIdx);
         if (strcmp(p->name().c_str(), valueCheck) == 0)
         {
-          strcpy(tempCar.positionShortName[posIdx], p->value().c_str());
+          form.car.positionShortName[posIdx] = Pool_Add(form.names, p->value().c_str());
           forceContinue = true;
           break;
         }
@@ -305,224 +486,238 @@ void setup()
       // device settings
       if (strcmp(p->name().c_str(), "ssid_id") == 0)
       {
-        strcpy(tempDevice.ssid, p->value().c_str());
-        pageSource = 2;
+        strcpy(form.device.ssid, p->value().c_str());
+        form.pageSource = WEB_PAGE_DEVICE;
         continue;
       }
       if (strcmp(p->name().c_str(), "pass_id") == 0)
       {
-        strcpy(tempDevice.pass, p->value().c_str());
+        strcpy(form.device.pass, p->value().c_str());
         continue;
       }
       // true for C, false for F
       if (strcmp(p->name().c_str(), "units_id") == 0)
       {
-        tempDevice.tempUnits = false;
+        form.device.tempUnits = false;
         if(strcmp(p->value().c_str(), "C") == 0)
         {
           Serial.println("C");
-          tempDevice.tempUnits = true;
+          form.device.tempUnits = true;
         }
         else
         {
           Serial.println("F");
-          tempDevice.tempUnits = false;
+          form.device.tempUnits = false;
         }
         continue;
       }
       // screenRotation 0 = R, 1 = L
       if (strcmp(p->name().c_str(), "orientation_id") == 0)
       {
-        tempDevice.screenRotation = 1;
+        form.device.screenRotation = 1;
         if(strcmp(p->value().c_str(), "R") == 0)
         {
-          tempDevice.screenRotation = 0;
+          form.device.screenRotation = 0;
         }
         continue;
       }
       // stable temp bandwidth
       if (strcmp(p->name().c_str(), "bandwidth_id") == 0)
       {
-        tempDevice.stableBand[0] = atof(p->value().c_str()) / -2.0;
-        tempDevice.stableBand[1] = atof(p->value().c_str()) /  2.0;
+        form.device.stableBand[0] = atof(p->value().c_str()) / -2.0;
+        form.device.stableBand[1] = atof(p->value().c_str()) /  2.0;
         continue;
       }
       // stable temp bandwidth
       if (strcmp(p->name().c_str(), "stabledelay_id") == 0)
       {
-        tempDevice.stableDelay = atoi(p->value().c_str());
+        form.device.stableDelay = atoi(p->value().c_str());
         continue;
       }
       // stable temp buffer
       if (strcmp(p->name().c_str(), "stablebuffer_id") == 0)
       {
-        tempDevice.stableBuffer = atoi(p->value().c_str());
+        form.device.stableBuffer = atoi(p->value().c_str());
+        form.device.stableBuffer = form.device.stableBuffer < 5 ? 5 : (form.device.stableBuffer > STABLE_WINDOW_MAX ? STABLE_WINDOW_MAX : form.device.stableBuffer);
+        continue;
+      }
+      // stable temp method
+      if (strcmp(p->name().c_str(), "stablemethod_id") == 0)
+      {
+        form.device.stableMethod = STABLE_BAND;
+        for(int method = 0; method < STABLE_METHOD_COUNT; method++)
+        {
+          if(strcmp(p->value().c_str(), stableMethodNames[method]) == 0)
+          {
+            form.device.stableMethod = method;
+          }
+        }
+        continue;
+      }
+      // stable temp slope limit
+      if (strcmp(p->name().c_str(), "stableslope_id") == 0)
+      {
+        form.device.stableSlope = atof(p->value().c_str());
+        form.device.stableSlope = form.device.stableSlope < 0.01 ? 0.01 : form.device.stableSlope;
+        continue;
+      }
+      // raw sample trace
+      if (strcmp(p->name().c_str(), "trace_id") == 0)
+      {
+        form.device.traceSamples = strcmp(p->value().c_str(), "On") == 0;
         continue;
       }
       // is12Hour true for 12 hour clock, false for 24 hour clock
       if (strcmp(p->name().c_str(), "clock_id") == 0)
       {
-        tempDevice.is12Hour = true;
+        form.device.is12Hour = true;
         int hourMode = atoi(p->value().c_str());
         Serial.println(hourMode);
         if(hourMode == 24)
         {
           Serial.println("24 hour clock");
-          tempDevice.is12Hour = false;
+          form.device.is12Hour = false;
         }
         else
         {
           Serial.println("12 hour clock");
-          tempDevice.is12Hour = true;
+          form.device.is12Hour = true;
         }
         continue;
       }
       if (strcmp(p->name().c_str(), "fontsize_id") == 0)
       {
-        tempDevice.fontPoints = atoi(p->value().c_str());
-        if((tempDevice.fontPoints !=  9) &&
-           (tempDevice.fontPoints != 12) &&
-           (tempDevice.fontPoints != 18) &&
-           (tempDevice.fontPoints != 24))
+        form.device.fontPoints = atoi(p->value().c_str());
+        if((form.device.fontPoints !=  9) &&
+           (form.device.fontPoints != 12) &&
+           (form.device.fontPoints != 18) &&
+           (form.device.fontPoints != 24))
         {
-          tempDevice.fontPoints =  12;
+          form.device.fontPoints =  12;
         }
         continue;
       }
-      if (pageSource == 1) 
+      // buttons
+      if (strcmp(p->name().c_str(), "update") == 0)
       {
-        if(strcmp(p->name().c_str(), "update") == 0)
-        {
-          // update current car settings
-          strcpy(cars[carSetupIdx].carName, tempCar.carName);
-          cars[carSetupIdx].tireCount = tempCar.tireCount;
-          cars[carSetupIdx].positionCount = tempCar.positionCount;
-          for(int tireIdx = 0; tireIdx < 6; tireIdx++)
-          {
-            strcpy(cars[carSetupIdx].tireLongName[tireIdx], tempCar.tireLongName[tireIdx]);
-            strcpy(cars[carSetupIdx].tireShortName[tireIdx], tempCar.tireShortName[tireIdx]);
-            cars[carSetupIdx].maxTemp[tireIdx] = tempCar.maxTemp[tireIdx];
-          }
-          for(int posIdx = 0; posIdx < 3; posIdx++)
-          {
-            strcpy(cars[carSetupIdx].positionLongName[posIdx], tempCar.positionLongName[posIdx]);
-            strcpy(cars[carSetupIdx].positionShortName[posIdx], tempCar.positionShortName[posIdx]);
-          }
-          WriteCarSetupFile(SD, "/py_cars.txt");
-          //WriteCarSetupHTML(LittleFS, "/py_cars.html", carSetupIdx);
-          //WriteCarSetupHTML(SD, "/py_cars.html", carSetupIdx);
-        }
-        else if ((strcmp(p->name().c_str(), "new") == 0))
-        {
-          // create a blank new car entry
-          carCount++;
-          carSetupIdx++;
-          if (void* mem = realloc(cars, sizeof(CarSettings) * carCount))
-          {
-            cars = static_cast<CarSettings*>(mem);
-          }
-          cars[carCount - 1].carID = maxCarID;
-          strcpy(cars[carCount - 1].carName, "-");
-          cars[carCount - 1].tireCount = 4;
-          cars[carCount - 1].positionCount = 3;
-          strcpy(cars[carCount - 1].tireShortName[0], "-");
-          strcpy(cars[carCount - 1].tireLongName[0], "-");
-          cars[carCount - 1].maxTemp[0] = 100.0;
-          strcpy(cars[carCount - 1].tireShortName[1], "-");
-          strcpy(cars[carCount - 1].tireLongName[1], "-");
-          cars[carCount - 1].maxTemp[1] = 100.0;
-          strcpy(cars[carCount - 1].tireShortName[2], "-");
-          strcpy(cars[carCount - 1].tireLongName[2], "-");
-          cars[carCount - 1].maxTemp[2] = 100.0;
-          strcpy(cars[carCount - 1].tireShortName[3], "-");
-          strcpy(cars[carCount - 1].tireLongName[3], "-");
-          cars[carCount - 1].maxTemp[3] = 100.0;
-
-          strcpy(cars[carCount - 1].positionShortName[0], "-");
-          strcpy(cars[carCount - 1].positionLongName[0], "-");
-          strcpy(cars[carCount - 1].positionShortName[1], "-");
-          strcpy(cars[carCount - 1].positionLongName[1], "-");
-          strcpy(cars[carCount - 1].positionShortName[2], "-");
-          strcpy(cars[carCount - 1].positionLongName[2], "-");
-          WriteCarSetupFile(SD, "/py_cars.txt");
-          //WriteCarSetupHTML(LittleFS, "/py_cars.html", carSetupIdx);
-          //WriteCarSetupHTML(SD, "/py_cars.html", carSetupIdx);
-        }
-        else if ((strcmp(p->name().c_str(), "delete") == 0))
-        {
-          // delete current car entry
-          for(int carIdx = carSetupIdx; carIdx < carCount - 1; carIdx++)
-          {
-            cars[carIdx] = cars[carIdx + 1];
-          }
-          carCount--;
-          if (void* mem = realloc(cars, sizeof(CarSettings) * carCount))
-          {
-            cars = static_cast<CarSettings*>(mem);
-          }
-          WriteCarSetupFile(SD, "/py_cars.txt");
-          //WriteCarSetupHTML(LittleFS, "/py_cars.html", carSetupIdx);
-          //WriteCarSetupHTML(SD, "/py_cars.html", carSetupIdx);
-        }
-        // buttons
-        if (strcmp(p->name().c_str(), "next") == 0)
-        {
-          carSetupIdx = carSetupIdx + 1 < carCount ? carSetupIdx + 1 : carCount - 1;
-          //WriteCarSetupHTML(LittleFS, "/py_cars.html", carSetupIdx);
-          WriteCarSetupHTML(SD, "/py_cars.html", carSetupIdx);
-          request->send(/*LittleFS*/SD, "/py_cars.html", "text/html");
-        }
-        if (strcmp(p->name().c_str(), "prior") == 0)
-        {
-          carSetupIdx = carSetupIdx - 1 >= 0 ? carSetupIdx - 1 : 0;
-          //WriteCarSetupHTML(LittleFS, "/py_cars.html", carSetupIdx);
-          WriteCarSetupHTML(SD, "/py_cars.html", carSetupIdx);
-          request->send(/*LittleFS*/SD, "/py_cars.html", "text/html");
-        }
-        request->send(/*LittleFS*/SD, "/py_cars.html", "text/html");
+        form.action = WEB_FORM_UPDATE;
       }
-      else if (pageSource == 2)
+      else if (strcmp(p->name().c_str(), "new") == 0)
       {
-        if (strcmp(p->name().c_str(), "update") == 0)
-        {
-          // update device settings
-          strcpy(deviceSettings.ssid, tempDevice.ssid);
-          strcpy(deviceSettings.pass , tempDevice.pass);
-          deviceSettings.tempUnits = tempDevice.tempUnits;
-          if(deviceSettings.screenRotation != tempDevice.screenRotation)
-          {
-            deviceSettings.screenRotation = tempDevice.screenRotation;
-            RotateDisplay(true);
-          }
-          deviceSettings.stableBand[0] = tempDevice.stableBand[0];
-          deviceSettings.stableBand[1] = tempDevice.stableBand[1];
-          deviceSettings.stableDelay = tempDevice.stableDelay;
-          deviceSettings.is12Hour = tempDevice.is12Hour;
-          deviceSettings.fontPoints = tempDevice.fontPoints;
-          WriteDeviceSetupFile(SD, "/py_set.txt");
-          //WriteDeviceSetupHTML(LittleFS, "/py_set.html");
-          WriteDeviceSetupHTML(SD, "/py_set.html");
-          request->send(/*LittleFS*/SD, "/py_set.html", "text/html");
-        }
+        form.action = WEB_FORM_NEW;
       }
-      else
+      else if (strcmp(p->name().c_str(), "delete") == 0)
+      {
+        form.action = WEB_FORM_DELETE;
+      }
+      else if (strcmp(p->name().c_str(), "next") == 0)
+      {
+        form.action = WEB_FORM_NEXT;
+      }
+      else if (strcmp(p->name().c_str(), "prior") == 0)
       {
-        request->send(/*LittleFS*/SD, "/py_main.html", "text/html");
+        form.action = WEB_FORM_PRIOR;
       }
     }
+    const char* page = form.pageSource == WEB_PAGE_CARS ? "/py_cars.html" :
+                       (form.pageSource == WEB_PAGE_DEVICE ? "/py_set.html" : "/py_main.html");
+    if((form.pageSource == WEB_PAGE_NONE) || (form.action == WEB_FORM_NONE))
+    {
+      Pool_Reset(form.names);
+      Web_SendFile(request, page, "text/html");
+      return;
+    }
+    // the queue owns form.names from here
+    if((webFormQueue == NULL) || (xQueueSend(webFormQueue, &form, 0) != pdTRUE))
+    {
+      Pool_Reset(form.names);
+      request->send(503, "text/plain", "Pyrometer busy, try again");
+      return;
+    }
+    // page is regenerated once the loop task applies the form
+    char outStr[256];
+    snprintf(outStr, sizeof(outStr),
+             "<html><head><meta http-equiv=\"refresh\" content=\"%d; url=%s\"></head>"
+             "<body>Updating - changes apply when the pyrometer is at its main menu</body></html>",
+             WEB_REFRESH_SECONDS, page);
+    request->send(200, "text/html", outStr);
   });
   server.begin();
-  
-  sprintf(outStr, "IP %d.%d.%d.%d", IP[0], IP[1], IP[2], IP[3]);
-  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
-  textPosition[1] += fontHeight;
-  sprintf(outStr, "Password %s", deviceSettings.pass);
-  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
-  textPosition[1] += fontHeight;
-  SetupTireMeasureGrid(deviceSettings.fontPoints);
-
-  delay(5000);
-  RotateDisplay(deviceSettings.screenRotation != 0);
+}
+//
+// send an SD file as a chunked response, each chunk is read under spiMutex
+// the loop task holds spiMutex except while waiting for a button (WaitButtonEvent)
+//
+void Web_SendFile(AsyncWebServerRequest* request, const char* path, const char* contentType)
+{
+  if(xSemaphoreTake(spiMutex, pdMS_TO_TICKS(WEB_SPI_WAIT_MS)) != pdTRUE)
+  {
+    request->send(503, "text/plain", "Pyrometer busy, try again");
+    return;
+  }
+  bool found = SD.exists(path);
+  xSemaphoreGive(spiMutex);
+  if(!found)
+  {
+    request->send(404, "text/plain", "Not found");
+    return;
+  }
+  String filePath = path;
+  AsyncWebServerResponse* response = request->beginChunkedResponse(contentType,
+    [filePath](uint8_t* buffer, size_t maxLen, size_t index) -> size_t
+    {
+      if(xSemaphoreTake(spiMutex, pdMS_TO_TICKS(WEB_CHUNK_WAIT_MS)) != pdTRUE)
+      {
+        return RESPONSE_TRY_AGAIN;
+      }
+      // index is the bytes already sent
+      size_t len = 0;
+      File file = SD.open(filePath.c_str(), FILE_READ);
+      if(file && file.seek(index))
+      {
+        int readCount = file.read(buffer, maxLen);
+        len = readCount > 0 ? readCount : 0;
+      }
+      if(file)
+      {
+        file.close();
+      }
+      xSemaphoreGive(spiMutex);
+      return len;
+    });
+  request->send(response);
+}
+//
+// content type for a file served from SD, by extension
+//
+const char* Web_ContentType(const char* path)
+{
+  const char* extension = strrchr(path, '.');
+  if(extension == NULL)
+  {
+    return "application/octet-stream";
+  }
+  if(strcmp(extension, ".html") == 0)
+  {
+    return "text/html";
+  }
+  if(strcmp(extension, ".css") == 0)
+  {
+    return "text/css";
+  }
+  if(strcmp(extension, ".js") == 0)
+  {
+    return "application/javascript";
+  }
+  if(strcmp(extension, ".json") == 0)
+  {
+    return "application/json";
+  }
+  if(strcmp(extension, ".txt") == 0)
+  {
+    return "text/plain";
+  }
+  return "application/octet-stream";
 }
 //
 // display menu associated with current device state
@@ -542,8 +737,20 @@ void loop()
       MeasureAllTireTemps();
       deviceState = DISPLAY_MENU;
       break;
+    case RESUME_TIRES:
+      MeasureAllTireTemps(true);
+      deviceState = DISPLAY_MENU;
+      break;
+    case MEASURE_RUN_GROUP:
+      MeasureRunGroup();
+      deviceState = DISPLAY_MENU;
+      break;
     case DISPLAY_TIRES:
-      DisplayAllTireTemps(cars[selectedCar]);
+      {
+        MeasureRecord record;
+        Car_GetRecord(cars[selectedCar], measureEpochMs, record);
+        DisplayAllTireTemps(record);
+      }
       deviceState = DISPLAY_MENU;
       break;
     case DISPLAY_SELECTED_RESULT:
@@ -572,14 +779,15 @@ void loop()
 //
 void MainMenu()
 {
-  int menuCount = 6;
-  MenuChoice mainMenuChoices[6];  
+  int menuCount = 7;
+  MenuChoice mainMenuChoices[7];  
   mainMenuChoices[0].description = "Measure Temps";                   mainMenuChoices[0].result = MEASURE_TIRES;
-  mainMenuChoices[1].description = cars[selectedCar].carName; mainMenuChoices[1].result = SELECT_CAR;
-  mainMenuChoices[2].description = "Display Temps";                   mainMenuChoices[2].result = DISPLAY_TIRES;
-  mainMenuChoices[3].description = "Instant Temp";                    mainMenuChoices[3].result = INSTANT_TEMP;
-  mainMenuChoices[4].description = "Display Selected Results";        mainMenuChoices[4].result = DISPLAY_SELECTED_RESULT;
-  mainMenuChoices[5].description = "Settings";                        mainMenuChoices[5].result = CHANGE_SETTINGS;
+  mainMenuChoices[1].description = Pool_Get(carNames, cars[selectedCar].carName); mainMenuChoices[1].result = SELECT_CAR;
+  mainMenuChoices[2].description = "Measure Run Group";               mainMenuChoices[2].result = MEASURE_RUN_GROUP;
+  mainMenuChoices[3].description = "Display Temps";                   mainMenuChoices[3].result = DISPLAY_TIRES;
+  mainMenuChoices[4].description = "Instant Temp";                    mainMenuChoices[4].result = INSTANT_TEMP;
+  mainMenuChoices[5].description = "Display Selected Results";        mainMenuChoices[5].result = DISPLAY_SELECTED_RESULT;
+  mainMenuChoices[6].description = "Settings";                        mainMenuChoices[6].result = CHANGE_SETTINGS;
   
   deviceState = MenuSelect(deviceSettings.fontPoints, mainMenuChoices, menuCount, MEASURE_TIRES); 
 }
@@ -591,7 +799,7 @@ void SelectCarMenu()
   MenuChoice* carsMenu = (MenuChoice*)calloc(carCount, sizeof(MenuChoice));
   for(int idx = 0; idx < carCount; idx++)
   {
-    carsMenu[idx].description = cars[idx].carName;
+    carsMenu[idx].description = Pool_Get(carNames, cars[idx].carName);
     carsMenu[idx].description += " (ID: ";
     carsMenu[idx].description += cars[idx].carID;
     carsMenu[idx].description += ")";
@@ -601,57 +809,172 @@ void SelectCarMenu()
   free(carsMenu);
 }
 //
-// display all results for a selected car
+// build a run group - selecting a car adds it to the end of the group, selecting it again removes it
+// group order is shown as #n before the car name
 //
-void SelectedResultsMenu(fs::FS &fs, const char * path)
+void RunGroupMenu()
 {
-  char buf[512];
-  CarSettings currentResultCar;
-  int tokenIdx = 0;
-  int measureIdx = 0;
-  int tireIdx = 0;
-  int positionIdx = 0;
-  int tempCnt = 0;
-  int measureRange[2] = {99, 99};
-  int tireNameRange[2] = {99, 99};
-  int posNameRange[2] = {99, 99};
-  char* token;
-  File file = SD.open(path, FILE_READ);
-  if(!file)
+  int menuCount = carCount + 2;
+  MenuChoice* groupMenu = (MenuChoice*)calloc(menuCount, sizeof(MenuChoice));
+  int initialSelect = 0;
+  runGroupCount = 0;
+  while(true)
   {
-    tftDisplay.fillScreen(TFT_WHITE);
-    YamuraBanner();
-    tftDisplay.drawString("No results for", 5, 0,  GFXFF);
-    tftDisplay.drawString(cars[selectedCar].carName, 5, fontHeight, GFXFF);
-    tftDisplay.drawString("Select another car", 5, 2* fontHeight, GFXFF);
-    delay(5000);
-    return;
-  }
-  // get count of results
-  int menuCnt = 0;
-  while(menuCnt < MAX_MENU_ITEMS)
+    groupMenu[0].description = "Start (";
+    groupMenu[0].description += runGroupCount;
+    groupMenu[0].description += " cars)";
+    groupMenu[0].result = carCount;
+    for(int carIdx = 0; carIdx < carCount; carIdx++)
+    {
+      groupMenu[carIdx + 1].description = "";
+      for(int groupIdx = 0; groupIdx < runGroupCount; groupIdx++)
+      {
+        if(runGroup[groupIdx] == carIdx)
+        {
+          groupMenu[carIdx + 1].description = "#";
+          groupMenu[carIdx + 1].description += groupIdx + 1;
+          groupMenu[carIdx + 1].description += " ";
+          break;
+        }
+      }
+      groupMenu[carIdx + 1].description += Pool_Get(carNames, cars[carIdx].carName);
+      groupMenu[carIdx + 1].result = carIdx;
+    }
+    groupMenu[carCount + 1].description = "Cancel";
+    groupMenu[carCount + 1].result = carCount + 1;
+    int choice = MenuSelect(deviceSettings.fontPoints, groupMenu, menuCount, initialSelect);
+    if(choice == carCount)
+    {
+      break;
+    }
+    if(choice == carCount + 1)
+    {
+      runGroupCount = 0;
+      break;
+    }
+    initialSelect = choice;
+    int groupIdx = 0;
+    while((groupIdx < runGroupCount) && (runGroup[groupIdx] != choice))
+    {
+      groupIdx++;
+    }
+    if(groupIdx < runGroupCount)
+    {
+      for(; groupIdx < runGroupCount - 1; groupIdx++)
+      {
+        runGroup[groupIdx] = runGroup[groupIdx + 1];
+      }
+      runGroupCount--;
+    }
+    else if(runGroupCount < RUN_GROUP_MAX)
+    {
+      runGroup[runGroupCount] = choice;
+      runGroupCount++;
+    }
+  }
+  free(groupMenu);
+}
+//
+// measure each car in the run group in order, one confirm between cars
+// records are staged on LittleFS, SD copies and HTML pages wait for idle after the group
+//
+void MeasureRunGroup()
+{
+  char outStr[MENU_TEXT_SIZE];
+  MenuChoice nextCar[3];
+  RunGroupMenu();
+  runGroupActive = true;
+  for(int groupIdx = 0; groupIdx < runGroupCount; groupIdx++)
+  {
+    selectedCar = runGroup[groupIdx];
+    snprintf(outStr, sizeof(outStr), "Measure %s (%d of %d)", Pool_Get(carNames, cars[selectedCar].carName),
+                                     groupIdx + 1, runGroupCount);
+    nextCar[0].description = outStr;            nextCar[0].result = 2;
+    nextCar[1].description = "Skip car";        nextCar[1].result = 1;
+    nextCar[2].description = "End run group";   nextCar[2].result = 0;
+    int choice = MenuSelect(deviceSettings.fontPoints, nextCar, 3, 2);
+    if(choice == 0)
+    {
+      break;
+    }
+    if(choice == 2)
+    {
+      MeasureAllTireTemps(false, true);
+    }
+  }
+  runGroupActive = false;
+  if(LittleFS.exists(PENDING_PATH))
+  {
+    htmlPending |= HTML_RECORDS | HTML_RESULTS;
+  }
+}
+//
+// display all results for a selected car
+//
+void SelectedResultsMenu(fs::FS &fs, const char * path)
+{
+  char* line;
+  MeasureRecord record;
+  int tokenIdx = 0;
+  int measureIdx = 0;
+  int tireIdx = 0;
+  int positionIdx = 0;
+  int tempCnt = 0;
+  int measureRange[2] = {99, 99};
+  int tireNameRange[2] = {99, 99};
+  int posNameRange[2] = {99, 99};
+  File file = SD.open(path, FILE_READ);
+  if(!file)
+  {
+    tftDisplay.fillScreen(TFT_WHITE);
+    YamuraBanner();
+    tftDisplay.drawString("No results for", 5, 0,  GFXFF);
+    tftDisplay.drawString(Pool_Get(carNames, cars[selectedCar].carName), 5, fontHeight, GFXFF);
+    tftDisplay.drawString("Select another car", 5, 2* fontHeight, GFXFF);
+    delay(5000);
+    return;
+  }
+  LineReader* reader = (LineReader*)calloc(1, sizeof(LineReader));
+  if(reader == NULL)
+  {
+    file.close();
+    return;
+  }
+  // get count of results
+  int menuCnt = 0;
+  Line_Begin(*reader, file);
+  while(menuCnt < MAX_MENU_ITEMS)
   {
-    ReadLine(file, buf);
-    if(strlen(buf) == 0)
+    line = Line_Read(*reader);
+    if(strlen(line) == 0)
     {
       break;
     }
 	menuCnt++;
   }
   file.close();
-  MenuChoice* carsMenu = (MenuChoice*)calloc(menuCnt, sizeof(MenuChoice));
+  int resultCnt = menuCnt;
+  MenuChoice* carsMenu = (MenuChoice*)calloc(resultCnt, sizeof(MenuChoice));
   file = SD.open(path, FILE_READ);
+  Line_Begin(*reader, file);
   menuCnt = 0;
-  while(true)
+  while(menuCnt < resultCnt)
   {
-    ReadLine(file, buf);
-    if(strlen(buf) == 0)
+    line = Line_Read(*reader);
+    if(strlen(line) == 0)
     {
       break;
     }
-    token = strtok(buf, ";");
     char outStr[128];
-    sprintf(outStr, "%s %s", cars[selectedCar].carName, token);
+    char timeStr[RECORD_TIME_SIZE];
+    if(!ReadMeasurementFile(line, record))
+    {
+      sprintf(outStr, "%s (bad record)", Pool_Get(carNames, cars[selectedCar].carName));
+    }
+    else
+    {
+      sprintf(outStr, "%s %s", Pool_Get(carNames, cars[selectedCar].carName), Results_TimeText(record, timeStr, sizeof(timeStr)));
+    }
     carsMenu[menuCnt].description = outStr;
     carsMenu[menuCnt].result = menuCnt;
     menuCnt++;
@@ -668,27 +991,33 @@ void SelectedResultsMenu(fs::FS &fs, const char * path)
     tftDisplay.fillScreen(TFT_WHITE);
     YamuraBanner();
     tftDisplay.drawString("No results for", 5, 0, GFXFF);
-    tftDisplay.drawString(cars[selectedCar].carName, 5, fontHeight, GFXFF);
+    tftDisplay.drawString(Pool_Get(carNames, cars[selectedCar].carName), 5, fontHeight, GFXFF);
     tftDisplay.drawString("Select another car", 5, 2* fontHeight, GFXFF);
     delay(5000);
+    free(reader);
     return;
   }
+  Line_Begin(*reader, file);
   for (int lineNumber = 0; lineNumber <= menuResult; lineNumber++)
   {
-    ReadLine(file, buf);
+    line = Line_Read(*reader);
   } 
   file.close();
-  ReadMeasurementFile(buf, currentResultCar);
-  DisplayAllTireTemps(currentResultCar);
+  if(ReadMeasurementFile(line, record))
+  {
+    DisplayAllTireTemps(record);
+  }
+  // record names point into the reader's line
+  free(reader);
 }
 //
 // change device settings menu
 //
 void ChangeSettingsMenu()
 {
-  int menuCount = 13;
+  int menuCount = SET_MENU_COUNT;
   int result =  0;
-  MenuChoice settingsChoices[13];
+  MenuChoice settingsChoices[SET_MENU_COUNT];
   char buf[512];
 
   while(true)
@@ -719,6 +1048,25 @@ void ChangeSettingsMenu()
     // temperature stabilization buffer
     settingsChoices[SET_STABLEBUFFER].description = "Temp buffer";
     settingsChoices[SET_STABLEBUFFER].result = SET_STABLEBUFFER;
+    // temperature stabilization method
+    settingsChoices[SET_STABLEMETHOD].description = "Temp method (";
+    settingsChoices[SET_STABLEMETHOD].description += stableMethodNames[deviceSettings.stableMethod];
+    settingsChoices[SET_STABLEMETHOD].description += ")";
+    settingsChoices[SET_STABLEMETHOD].result = SET_STABLEMETHOD;
+    // temperature stabilization slope limit
+    settingsChoices[SET_STABLESLOPE].description = "Temp slope";
+    settingsChoices[SET_STABLESLOPE].result = SET_STABLESLOPE;
+    // raw sample trace on/off
+    settingsChoices[SET_TRACE].description = deviceSettings.traceSamples ? "Sample trace (On)" : "Sample trace (Off)";
+    settingsChoices[SET_TRACE].result = SET_TRACE;
+    // stable temp auto-tune
+    settingsChoices[SET_AUTOTUNE].description = "Auto-tune temp settings";
+    settingsChoices[SET_AUTOTUNE].result = SET_AUTOTUNE;
+    // probe calibration
+    settingsChoices[SET_CALIBRATE].description = "Calibrate probe ";
+    settingsChoices[SET_CALIBRATE].description += deviceSettings.probeID;
+    settingsChoices[SET_CALIBRATE].description += calTable.active ? " (On)" : " (Off)";
+    settingsChoices[SET_CALIBRATE].result = SET_CALIBRATE;
     // delete data
     settingsChoices[SET_DELETEDATA].description = "Delete Data";
     settingsChoices[SET_DELETEDATA].result = SET_DELETEDATA;
@@ -730,6 +1078,13 @@ void ChangeSettingsMenu()
     sprintf(buf, "Pass %s", deviceSettings.pass);
     settingsChoices[SET_PASS].description = buf;
     settingsChoices[SET_PASS].result = SET_PASS;
+    // battery life estimate
+    sprintf(buf, "Battery est %0.1fh (%d%% asleep)", Power_BatteryHours(), (int)(millis() > 0 ? (powerStats.sleepMs * 100ULL) / millis() : 0));
+    settingsChoices[SET_BATTERY].description = buf;
+    settingsChoices[SET_BATTERY].result = SET_BATTERY;
+    // timing diagnostics
+    settingsChoices[SET_DIAGNOSTICS].description = "Diagnostics";
+    settingsChoices[SET_DIAGNOSTICS].result = SET_DIAGNOSTICS;
     // save
     settingsChoices[SET_SAVESETTINGS].description = "Save Settings";
     settingsChoices[SET_SAVESETTINGS].result = SET_SAVESETTINGS;
@@ -754,6 +1109,21 @@ void ChangeSettingsMenu()
       case SET_STABLEBUFFER:
         SetStableBufferMenu();
         break;
+      case SET_STABLEMETHOD:
+        SetStableMethodMenu();
+        break;
+      case SET_STABLESLOPE:
+        SetStableSlopeMenu();
+        break;
+      case SET_TRACE:
+        deviceSettings.traceSamples = !deviceSettings.traceSamples;
+        break;
+      case SET_AUTOTUNE:
+        AutoTuneMenu();
+        break;
+      case SET_CALIBRATE:
+        CalibrationMenu();
+        break;
       case SET_DELETEDATA:
         DeleteDataFilesMenu();
         break;
@@ -776,6 +1146,11 @@ void ChangeSettingsMenu()
         break;
       case SET_PASS:
         break;
+      case SET_BATTERY:
+        break;
+      case SET_DIAGNOSTICS:
+        DiagnosticsMenu();
+        break;
       case SET_EXIT:
         return;
       default:
@@ -915,7 +1290,7 @@ void SetStableBandwidthMenu()
       tftDisplay.fillRect(textPosition[0], textPosition[1], tftDisplay.width(), fontHeight, TFT_WHITE);
       tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
     }
-    delay(100);
+    WaitButtonEvent(100);
   }
 }
 //
@@ -978,7 +1353,7 @@ void SetStableDelayMenu()
       tftDisplay.fillRect(textPosition[0], textPosition[1], tftDisplay.width(), fontHeight, TFT_WHITE);
       tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
     }
-    delay(100);
+    WaitButtonEvent(100);
   }
 }
 //
@@ -1036,66 +1411,35 @@ void SetStableBufferMenu()
     else if(buttons[2].buttonReleased)
     {
       buttons[2].buttonReleased = false;
+      if(deviceSettings.stableBuffer >= STABLE_WINDOW_MAX)
+      {
+        continue;
+      }
       deviceSettings.stableBuffer += 1;
       sprintf(outStr, "\t%ld", deviceSettings.stableBuffer);
       tftDisplay.fillRect(textPosition[0], textPosition[1], tftDisplay.width(), fontHeight, TFT_WHITE);
       tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
     }
-    delay(100);
+    WaitButtonEvent(100);
   }
 }
 //
-// delete data files menu (Yes or No)
+// select stable temp method
 //
-void DeleteDataFilesMenu(bool verify)
+void SetStableMethodMenu()
 {
-  int menuResult = 1;
-  MenuChoice deleteFileYN[2];
-  if(verify)
-  {
-    int menuCount = 2;
-    deleteFileYN[0].description = "Yes";      deleteFileYN[0].result = 1;
-    deleteFileYN[1].description = "No";   deleteFileYN[1].result = 0;
-    menuResult = MenuSelect(deviceSettings.fontPoints, deleteFileYN, menuCount, 1); 
-  }
-  if(menuResult == 1)
-  {
-    int dataIdx = 0;
-    char nameBuf[128];
-    for(int dataIdx = 0; dataIdx < 100; dataIdx++)
-    {
-      sprintf(nameBuf, "/py_temps_%d.txt", dataIdx);
-      if(!SD.exists(nameBuf))
-      {
-        continue;
-      }
-      DeleteFile(SD, nameBuf);
-    }
-    DeleteFile(SD, "/py_res.html");
-    // create the HTML header
-    WriteResultsHTML(/*LittleFS*/SD);
-  }
+  MenuChoice methodChoices[STABLE_METHOD_COUNT];
+  methodChoices[STABLE_BAND].description  = "Band (max-min in window)";  methodChoices[STABLE_BAND].result = STABLE_BAND;
+  methodChoices[STABLE_SLOPE].description = "Slope (dT/dt in window)";   methodChoices[STABLE_SLOPE].result = STABLE_SLOPE;
+  methodChoices[STABLE_KALMAN].description = "Kalman (estimate in band)"; methodChoices[STABLE_KALMAN].result = STABLE_KALMAN;
+  deviceSettings.stableMethod = MenuSelect(deviceSettings.fontPoints, methodChoices, STABLE_METHOD_COUNT, deviceSettings.stableMethod);
 }
 //
-// return next state as selection from choices array
-// initialSelect defines the item in choices selected at the start of user input
+// set slope limit (degrees/second) for slope stable temp method
 //
-int MenuSelect(int fontSize, MenuChoice choices[], int menuCount, int initialSelect)
+void SetStableSlopeMenu()
 {
-  char outStr[256];
-  // location of text
-  textPosition[0] = 5;
-  textPosition[1] = 0;
-  unsigned long currentMillis = millis();
-  // find initial selection
-  int selection = initialSelect;
-  for(int selIdx = 0; selIdx < menuCount; selIdx++)
-  {
-    if(choices[selIdx].result == initialSelect)
-    {
-      selection = selIdx;
-    }
-  }
+  char outStr[128];
   // reset buttons
   for(int btnIdx = 0; btnIdx < BUTTON_COUNT; btnIdx++)
   {
@@ -1104,2342 +1448,5333 @@ int MenuSelect(int fontSize, MenuChoice choices[], int menuCount, int initialSel
   // erase screen, draw banner
   tftDisplay.fillScreen(TFT_WHITE);
   YamuraBanner();
-  // loop until selection is made
-  SetFont(fontSize);
-  int linesToDisplay = (tftDisplay.height() - 10)/fontHeight;
-  // range of selections to display (allow scrolling)
-  int displayRange[2] = {0, linesToDisplay - 1 };
-  displayRange[1] = (menuCount < linesToDisplay ? menuCount : linesToDisplay) - 1;
+  tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+  // display title
+  SetFont(deviceSettings.fontPoints);
   // display menu
+  textPosition[0] = 5;
+  textPosition[1] = 0;
+  sprintf(outStr, "Temperature slope (deg/sec)");
+  tftDisplay.fillRect(textPosition[0], textPosition[1], tftDisplay.width(), fontHeight, TFT_WHITE);
+  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+
+  textPosition[1] += fontHeight;
+  sprintf(outStr, "\t%0.2f", deviceSettings.stableSlope);
+  tftDisplay.fillRect(textPosition[0], textPosition[1], tftDisplay.width(), fontHeight, TFT_WHITE);
+  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+  unsigned long currentMillis = millis();
   while(true)
   {
-    textPosition[0] = 5;
-    textPosition[1] = 0;
-    for(int menuIdx = displayRange[0]; menuIdx <= displayRange[1]; menuIdx++)
+    currentMillis = millis();
+    CheckButtons(currentMillis);
+    // selection made, set state and break
+    if(buttons[0].buttonReleased)
     {
-      //sprintf(outStr, "%s", choices[menuIdx].description.c_str());
-      tftDisplay.fillRect(textPosition[0], textPosition[1], tftDisplay.width(), fontHeight, TFT_WHITE);
-      if(menuIdx == selection)
-      {
-        //sprintf(outStr, ">%s", choices[menuIdx].description.c_str());
-        tftDisplay.setTextColor(TFT_WHITE, TFT_RED);
-        tftDisplay.drawString(">", textPosition[0], textPosition[1], GFXFF);
-      }
-      //else
-      //{
-      textPosition[0] = fontWidth;
-        sprintf(outStr, "%s", choices[menuIdx].description.c_str());
-        tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
-        tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
-      //}
-      textPosition[0] = 0;
-      textPosition[1] += fontHeight;
+      buttons[0].buttonReleased = false;
+      return;
     }
-    while(true)
+    // down button, decrease slope by .01
+    else if(buttons[1].buttonReleased)
     {
-      currentMillis = millis();
-      CheckButtons(currentMillis);
-      // selection made, set state and break
-      if(buttons[0].buttonReleased)
-      {
-        buttons[0].buttonReleased = false;
-        return choices[selection].result;
-      }
-      // change selection down, break
-      else if(buttons[1].buttonReleased)
-      {
-        buttons[1].buttonReleased = false;
-        selection = (selection + 1) < menuCount ? (selection + 1) : 0;
-        // handle loop back to start
-        if (selection < displayRange[0])
-        {
-          displayRange[0] = selection;
-          displayRange[1] = displayRange[0] + linesToDisplay - 1; 
-        }
-        // show next line at bottom
-        else 
-        if (selection > displayRange[1])
-        {
-          displayRange[1] = selection; 
-          displayRange[0] = displayRange[1] - linesToDisplay + 1;
-        }
-        break;
-      }
-      // change selection up, break
-      else if(buttons[2].buttonReleased)
-      {
-        buttons[2].buttonReleased = false;
-        selection = (selection - 1) >= 0 ? (selection - 1) : menuCount - 1;
-        // handle loop back to start
-        if (selection < displayRange[0])
-        {
-          displayRange[0] = selection;
-          displayRange[1] = displayRange[0] + linesToDisplay - 1; 
-        }
-        // show next line at bottom
-        else 
-        if (selection > displayRange[1])
-        {
-          displayRange[1] = selection; 
-          displayRange[0] = displayRange[1] - linesToDisplay + 1;
-        }
-        break;
-      }
-      else if(buttons[3].buttonReleased)
+      buttons[1].buttonReleased = false;
+      if(deviceSettings.stableSlope - 0.01 < 0.01)
       {
+        continue;
       }
-      delay(100);
+      deviceSettings.stableSlope -= 0.01;
+      sprintf(outStr, "\t%0.2f", deviceSettings.stableSlope);
+      tftDisplay.fillRect(textPosition[0], textPosition[1], tftDisplay.width(), fontHeight, TFT_WHITE);
+      tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+    }      
+    // up button, increase slope by .01
+    else if(buttons[2].buttonReleased)
+    {
+      buttons[2].buttonReleased = false;
+      deviceSettings.stableSlope += 0.01;
+      sprintf(outStr, "\t%0.2f", deviceSettings.stableSlope);
+      tftDisplay.fillRect(textPosition[0], textPosition[1], tftDisplay.width(), fontHeight, TFT_WHITE);
+      tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
     }
+    WaitButtonEvent(100);
   }
-  return choices[selection].result;
 }
 //
-// user set date/time
+// auto-tune the stable temp settings for this probe - record TUNE_INSERTIONS insertions on a
+// reference surface, replay them through the current method over a grid of settings and offer
+// the fastest one that reads every insertion within TUNE_ACCURACY of where it settled
 //
-void SetDateTime()
+void AutoTuneMenu()
 {
-  char outStr[256];
-  int timeVals[8] = {0, 0, 0, 0, 0, 0, 0, 0};  // date, month, year, day, hour, min, sec, 100ths
-  // location of text
-  textPosition[0] = 5;
-  textPosition[1] = 0;
-  int setIdx = 0;
-  unsigned long curTime = millis();
-  int delta = 0;
-  #ifndef HAS_RTC
-  tftDisplay.fillScreen(TFT_WHITE);
-  YamuraBanner();
-  tftDisplay.drawString("RTC not present", textPosition[0], textPosition[1], GFXFF);
-  delay(5000);
-  return;
-  #endif
-  DateTime now;
-  now = RTC_GetDateTime();
-  int year = now.year();
-  int month = now.month();
-  int day = now.day();
-  int dayOfWeek = now.dayOfTheWeek();
-  bool isPM = now.isPM();
-
-  timeVals[DATE] = now.day();
-  timeVals[MONTH] = now.month();
-  timeVals[YEAR] = now.year();
-  timeVals[DAYOFWEEK] = now.dayOfTheWeek();
-  timeVals[HOUR] = now.hour();
-  if((now.isPM()) && (!deviceSettings.is12Hour))
-  {
-    timeVals[HOUR] += 12;
-  }
-  timeVals[MINUTE] = now.minute();
-  for(int btnIdx = 0; btnIdx < BUTTON_COUNT; btnIdx++)
+  char outStr[MENU_TEXT_SIZE];
+  char detailStr[MENU_TEXT_SIZE];
+  MenuChoice tuneChoices[2];
+  int counts[TUNE_INSERTIONS];
+  const int maxSamples = TUNE_RECORD_MS / TUNE_PERIOD_MS;
+  float* times = (float*)calloc(TUNE_INSERTIONS * maxSamples, sizeof(float));
+  float* temps = (float*)calloc(TUNE_INSERTIONS * maxSamples, sizeof(float));
+  if((times == NULL) || (temps == NULL))
   {
-    buttons[btnIdx].buttonReleased = false;
+    free(times);
+    free(temps);
+    return;
   }
-  while(true)
+  for(int insertion = 0; insertion < TUNE_INSERTIONS; insertion++)
   {
-    textPosition[0] = 5;
-    textPosition[1] = 0;
-    tftDisplay.fillScreen(TFT_WHITE);
-    YamuraBanner();
-    SetFont(24);
-    tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
-  
-    tftDisplay.drawString("Set date/time", textPosition[0], textPosition[1], GFXFF);
-    
-    textPosition[1] += fontHeight;
-
-    sprintf(outStr, "%02d", timeVals[MONTH]);
-    if(setIdx == 0)
+    snprintf(outStr, sizeof(outStr), "Probe in air, start (%d of %d)", insertion + 1, TUNE_INSERTIONS);
+    tuneChoices[0].description = outStr;     tuneChoices[0].result = 1;
+    tuneChoices[1].description = "Cancel";   tuneChoices[1].result = 0;
+    if(MenuSelect(deviceSettings.fontPoints, tuneChoices, 2, 0) == 0)
     {
-      tftDisplay.setTextColor(TFT_BLACK, TFT_YELLOW);
+      free(times);
+      free(temps);
+      return;
     }
-    else
+    counts[insertion] = Tune_Record(&times[insertion * maxSamples], &temps[insertion * maxSamples], maxSamples, insertion);
+    if(counts[insertion] == TUNE_NO_TRANSIENT)
     {
-      tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+      // settled from the first sample, would tune to trivially fast settings - record it again
+      tuneChoices[0].description = "No warm up seen, cool probe and retry";   tuneChoices[0].result = 0;
+      MenuSelect(deviceSettings.fontPoints, tuneChoices, 1, 0);
+      insertion--;
+      continue;
     }
-    tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
-    textPosition[0] += tftDisplay.textWidth(outStr);
-
-    sprintf(outStr, "/");
-    tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
-    tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
-    textPosition[0] += tftDisplay.textWidth(outStr);
-
-    sprintf(outStr, "%02d", timeVals[DATE]);
-    if(setIdx == 1)
+    if(counts[insertion] == 0)
     {
-      tftDisplay.setTextColor(TFT_BLACK, TFT_YELLOW);
+      // cancelled waiting for contact
+      free(times);
+      free(temps);
+      return;
     }
-    else
+    if(counts[insertion] < 0)
     {
-      tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+      // probe fault, nothing useful to tune with
+      snprintf(outStr, sizeof(outStr), "%s - check probe", thermoFaultNames[thermoFault]);
+      tuneChoices[0].description = outStr;   tuneChoices[0].result = 0;
+      MenuSelect(deviceSettings.fontPoints, tuneChoices, 1, 0);
+      free(times);
+      free(temps);
+      return;
     }
-    tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
-    textPosition[0] += tftDisplay.textWidth(outStr);
-
-    sprintf(outStr, "/");
-    tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
-    tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
-    textPosition[0] += tftDisplay.textWidth(outStr);
-
-    sprintf(outStr, "%02d", timeVals[YEAR]);
-    if(setIdx == 2)
+  }
+  StableParams best;
+  unsigned long bestDelay = 0;
+  float bestSec = 0.0F;
+  bool isFound = Tune_Search(times, temps, counts, maxSamples, best, bestDelay, bestSec);
+  free(times);
+  free(temps);
+  if(!isFound)
+  {
+    snprintf(outStr, sizeof(outStr), "No %s setting within +/-%0.2f", stableMethodNames[deviceSettings.stableMethod], TUNE_ACCURACY);
+    tuneChoices[0].description = outStr;   tuneChoices[0].result = 0;
+    MenuSelect(deviceSettings.fontPoints, tuneChoices, 1, 0);
+    return;
+  }
+  if(best.method == STABLE_BAND)
+  {
+    snprintf(detailStr, sizeof(detailStr), "Band %0.2f delay %lu buffer %d", best.bandHigh * 2.0, bestDelay, best.buffer);
+  }
+  else if(best.method == STABLE_SLOPE)
+  {
+    snprintf(detailStr, sizeof(detailStr), "Slope %0.2f delay %lu buffer %d", best.slope, bestDelay, best.buffer);
+  }
+  else
+  {
+    snprintf(detailStr, sizeof(detailStr), "Band %0.2f slope %0.2f delay %lu", best.bandHigh * 2.0, best.slope, bestDelay);
+  }
+  snprintf(outStr, sizeof(outStr), "Save (settles in %0.1f s)", bestSec);
+  tuneChoices[0].description = outStr;     tuneChoices[0].result = 1;
+  tuneChoices[1].description = detailStr;  tuneChoices[1].result = 0;
+  if(MenuSelect(deviceSettings.fontPoints, tuneChoices, 2, 0) != 1)
+  {
+    return;
+  }
+  deviceSettings.stableBand[0] = best.bandLow;
+  deviceSettings.stableBand[1] = best.bandHigh;
+  deviceSettings.stableSlope = best.slope;
+  deviceSettings.stableBuffer = best.buffer;
+  deviceSettings.stableDelay = bestDelay;
+  WriteDeviceSetupFile(SD, "/py_set.txt");
+  WriteDeviceSetupHTML(SD, "/py_set.html");
+}
+//
+// record one insertion at TUNE_PERIOD_MS for TUNE_RECORD_MS, live temp on screen
+// times start at contact - the first sample THERMO_CONTACT_RISE over the temp in air
+// returns samples recorded, 0 if cancelled (up/down) before contact, -1 on a probe fault,
+// TUNE_NO_TRANSIENT if the reference temp was not TUNE_TRANSIENT above the contact sample
+//
+int Tune_Record(float* times, float* temps, int maxSamples, int insertion)
+{
+  char outStr[128];
+  tftDisplay.fillScreen(TFT_WHITE);
+  YamuraBanner();
+  tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+  SetFont(deviceSettings.fontPoints);
+  textPosition[0] = 5;
+  textPosition[1] = 0;
+  // same amplifier filter the tuned method measures with
+  Thermo_SetFilter(deviceSettings.stableMethod == STABLE_KALMAN ? THERMO_FILTER_KALMAN : THERMO_FILTER_DEFAULT);
+  // wait for contact, display units
+  float contactRise = deviceSettings.tempUnits ? THERMO_CONTACT_RISE : THERMO_CONTACT_RISE * 1.8;
+  float airTemp = Thermo_GetTemp();
+  if(thermoFault != THERMO_OK)
+  {
+    return -1;
+  }
+  sprintf(outStr, "Touch probe to reference (%d of %d)", insertion + 1, TUNE_INSERTIONS);
+  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+  textPosition[1] += 2 * fontHeight;
+  float temperature = airTemp;
+  // own schedule, sampleSchedule keeps the last measurement for diagnostics
+  SampleSchedule schedule;
+  Sched_Begin(schedule, TUNE_PERIOD_MS);
+  while(temperature - airTemp < contactRise)
+  {
+    CheckButtons(millis());
+    if(buttons[1].buttonReleased || buttons[2].buttonReleased)
     {
-      tftDisplay.setTextColor(TFT_BLACK, TFT_YELLOW);
+      buttons[1].buttonReleased = false;
+      buttons[2].buttonReleased = false;
+      return 0;
     }
-    else
+    Sched_WaitNext(schedule);
+    temperature = Thermo_GetTemp();
+    if(thermoFault != THERMO_OK)
     {
-      tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+      return -1;
     }
-    tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
-    textPosition[0] += tftDisplay.textWidth(outStr);
-
-    sprintf(outStr, " %s", days[timeVals[DAYOFWEEK]]);
-    if(setIdx == 3)
+    sprintf(outStr, "        %0.2f         ", temperature);
+    tftDisplay.setFreeFont(FSS24); // max font
+    tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+    SetFont(deviceSettings.fontPoints);
+  }
+  textPosition[1] = 0;
+  sprintf(outStr, "Recording %d of %d, hold probe steady", insertion + 1, TUNE_INSERTIONS);
+  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+  textPosition[1] += 2 * fontHeight;
+  // contact sample is the first one recorded, at time 0
+  unsigned long startTime = millis();
+  Sched_Begin(schedule, TUNE_PERIOD_MS);
+  int count = 0;
+  while(count < maxSamples)
+  {
+    if(count > 0)
     {
-      tftDisplay.setTextColor(TFT_BLACK, TFT_YELLOW);
+      temperature = Thermo_GetTemp();
     }
-    else
+    if(thermoFault != THERMO_OK)
     {
-      tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+      return -1;
     }
-    tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
-
-    textPosition[0] = 5;
-    textPosition[1] += fontHeight;
-
-    sprintf(outStr, "%02d", timeVals[HOUR]);
-    if(setIdx == 4)
+    times[count] = (millis() - startTime) / 1000.0F;
+    temps[count] = temperature;
+    count++;
+    sprintf(outStr, "        %0.2f (%lus)         ", temperature, (TUNE_RECORD_MS - (millis() - startTime)) / 1000);
+    tftDisplay.setFreeFont(FSS24); // max font
+    tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+    SetFont(deviceSettings.fontPoints);
+    Sched_WaitNext(schedule);
+  }
+  // an insertion with no transient is the probe already settled, not a step to tune against
+  float plateau = 0.0F;
+  int first = count > TUNE_PLATEAU ? count - TUNE_PLATEAU : 0;
+  for(int idx = first; idx < count; idx++)
+  {
+    plateau += temps[idx];
+  }
+  plateau /= count > first ? count - first : 1;
+  return plateau - temps[0] >= TUNE_TRANSIENT ? count : TUNE_NO_TRANSIENT;
+}
+//
+// replay the recorded insertions through the current method at each candidate setting
+// best is the setting with the shortest worst-case settle (then shortest total) that read
+// every insertion stable and within TUNE_ACCURACY of its last TUNE_PLATEAU samples
+// returns false if no candidate qualified
+//
+bool Tune_Search(const float* times, const float* temps, const int* counts, int maxSamples, StableParams& best,
+                 unsigned long& bestDelay, float& bestSec)
+{
+  const int delaySteps[] = {1, 2, 3, 4};
+  const int bufferList[] = {5, 8, 10, 15, 20};
+  const float bandList[] = {0.05, 0.075, 0.125, 0.25, 0.375, 0.5};
+  const float slopeList[] = {0.02, 0.05, 0.1, 0.2};
+  float plateaus[TUNE_INSERTIONS];
+  for(int insertion = 0; insertion < TUNE_INSERTIONS; insertion++)
+  {
+    const float* insertTemps = &temps[insertion * maxSamples];
+    int first = counts[insertion] > TUNE_PLATEAU ? counts[insertion] - TUNE_PLATEAU : 0;
+    plateaus[insertion] = 0.0F;
+    for(int idx = first; idx < counts[insertion]; idx++)
     {
-      tftDisplay.setTextColor(TFT_BLACK, TFT_YELLOW);
+      plateaus[insertion] += insertTemps[idx];
     }
-    else
+    plateaus[insertion] /= counts[insertion] > first ? counts[insertion] - first : 1;
+  }
+  // only the settings the current method uses are searched, the rest stay as set
+  int method = deviceSettings.stableMethod;
+  int delayCount = sizeof(delaySteps) / sizeof(delaySteps[0]);
+  int bufferCount = method == STABLE_KALMAN ? 1 : sizeof(bufferList) / sizeof(bufferList[0]);
+  int bandCount = method == STABLE_SLOPE ? 1 : sizeof(bandList) / sizeof(bandList[0]);
+  int slopeCount = method == STABLE_BAND ? 1 : sizeof(slopeList) / sizeof(slopeList[0]);
+  bool isFound = false;
+  float bestTotal = 0.0F;
+  StableParams params;
+  params.method = method;
+  params.kalmanNoise = deviceSettings.kalmanNoise;
+  params.kalmanRate = deviceSettings.kalmanRate;
+  params.seed = deviceSettings.tempUnits == 0 ? 60.0 : 15.0;
+  for(int delayIdx = 0; delayIdx < delayCount; delayIdx++)
+  {
+    for(int bufferIdx = 0; bufferIdx < bufferCount; bufferIdx++)
     {
-      tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+      params.buffer = method == STABLE_KALMAN ? deviceSettings.stableBuffer : bufferList[bufferIdx];
+      for(int bandIdx = 0; bandIdx < bandCount; bandIdx++)
+      {
+        params.bandHigh = method == STABLE_SLOPE ? deviceSettings.stableBand[1] : bandList[bandIdx];
+        params.bandLow = -params.bandHigh;
+        for(int slopeIdx = 0; slopeIdx < slopeCount; slopeIdx++)
+        {
+          params.slope = method == STABLE_BAND ? deviceSettings.stableSlope : slopeList[slopeIdx];
+          float worstSec = 0.0F;
+          float totalSec = 0.0F;
+          bool isGood = true;
+          for(int insertion = 0; isGood && (insertion < TUNE_INSERTIONS); insertion++)
+          {
+            float value;
+            int lastIdx;
+            int status = Stable_Replay(&times[insertion * maxSamples], &temps[insertion * maxSamples], counts[insertion],
+                                       delaySteps[delayIdx], params, value, lastIdx);
+            float settleSec = times[(insertion * maxSamples) + lastIdx];
+            isGood = (status == REPLAY_STABLE) && (fabsf(value - plateaus[insertion]) <= TUNE_ACCURACY);
+            worstSec = settleSec > worstSec ? settleSec : worstSec;
+            totalSec += settleSec;
+          }
+          if(!isGood || (isFound && ((worstSec > bestSec) || ((worstSec == bestSec) && (totalSec >= bestTotal)))))
+          {
+            continue;
+          }
+          isFound = true;
+          best = params;
+          bestDelay = delaySteps[delayIdx] * TUNE_PERIOD_MS;
+          bestSec = worstSec;
+          bestTotal = totalSec;
+        }
+      }
     }
-    tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
-    textPosition[0] += tftDisplay.textWidth(outStr);
-
-    sprintf(outStr, ":");
-    tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
-    tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
-    textPosition[0] += tftDisplay.textWidth(outStr);
-
-    sprintf(outStr, "%02d", timeVals[MINUTE]);
-    if(setIdx == 5)
+  }
+  #ifdef DEBUG_VERBOSE
+  if(isFound)
+  {
+    Serial.printf("auto-tune %s delay %lu buffer %d band %0.3f slope %0.3f worst %0.1f s\n",
+                  stableMethodNames[method], bestDelay, best.buffer, best.bandHigh, best.slope, bestSec);
+  }
+  #endif
+  return isFound;
+}
+//
+// probe calibration - pick the probe ID, capture reference points for it, clear or save them
+//
+void CalibrationMenu()
+{
+  char outStr[MENU_TEXT_SIZE];
+  MenuChoice calChoices[5];
+  int result = 0;
+  while(true)
+  {
+    int probeIdx = Cal_FindProbe(deviceSettings.probeID, false);
+    int pointCount = probeIdx >= 0 ? calProbes[probeIdx].pointCount : 0;
+    snprintf(outStr, sizeof(outStr), "Probe ID %d", deviceSettings.probeID);
+    calChoices[0].description = outStr;           calChoices[0].result = 0;
+    snprintf(outStr, sizeof(outStr), "Add point (%d of %d)", pointCount, CAL_MAX_POINTS);
+    calChoices[1].description = outStr;           calChoices[1].result = 1;
+    calChoices[2].description = "Clear points";   calChoices[2].result = 2;
+    calChoices[3].description = "Save";           calChoices[3].result = 3;
+    calChoices[4].description = "Exit";           calChoices[4].result = 4;
+    result = MenuSelect(deviceSettings.fontPoints, calChoices, 5, result);
+    switch(result)
     {
-      tftDisplay.setTextColor(TFT_BLACK, TFT_YELLOW);
+      case 0:
+        SetProbeIDMenu();
+        Cal_Select(deviceSettings.probeID);
+        break;
+      case 1:
+      {
+        float rawC = 0.0F;
+        if((pointCount >= CAL_MAX_POINTS) || !Cal_Capture(rawC))
+        {
+          break;
+        }
+        // reference entry starts at the corrected reading, display units
+        float startTemp = Cal_Apply(calTable, rawC);
+        startTemp = deviceSettings.tempUnits == 0 ? CtoFAbsolute(startTemp) : startTemp;
+        float refC = Cal_EnterReference(startTemp);
+        probeIdx = Cal_FindProbe(deviceSettings.probeID, true);
+        if(probeIdx < 0)
+        {
+          // CAL_MAX_PROBES curves already
+          break;
+        }
+        CalProbe& probe = calProbes[probeIdx];
+        probe.points[probe.pointCount].rawC = rawC;
+        probe.points[probe.pointCount].refC = refC;
+        probe.pointCount++;
+        Cal_Select(deviceSettings.probeID);
+        #ifdef DEBUG_VERBOSE
+        Serial.printf("probe %d point %d raw %0.2fC reference %0.2fC\n", probe.probeID, probe.pointCount, rawC, refC);
+        #endif
+        break;
+      }
+      case 2:
+        if(probeIdx >= 0)
+        {
+          calProbes[probeIdx].pointCount = 0;
+        }
+        Cal_Select(deviceSettings.probeID);
+        break;
+      case 3:
+        WriteCalibrationFile(SD, CAL_PATH);
+        WriteDeviceSetupFile(SD, "/py_set.txt");
+        break;
+      default:
+        return;
     }
-    else
+  }
+}
+//
+// set the ID of the fitted probe, selects its calibration curve
+//
+void SetProbeIDMenu()
+{
+  char outStr[128];
+  // reset buttons
+  for(int btnIdx = 0; btnIdx < BUTTON_COUNT; btnIdx++)
+  {
+    buttons[btnIdx].buttonReleased = false;
+  }
+  // erase screen, draw banner
+  tftDisplay.fillScreen(TFT_WHITE);
+  YamuraBanner();
+  tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+  // display title
+  SetFont(deviceSettings.fontPoints);
+  // display menu
+  textPosition[0] = 5;
+  textPosition[1] = 0;
+  sprintf(outStr, "Probe ID:");
+  tftDisplay.fillRect(textPosition[0], textPosition[1], tftDisplay.width(), fontHeight, TFT_WHITE);
+  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+  textPosition[1] += fontHeight;
+  sprintf(outStr, "\t%d", deviceSettings.probeID);
+  tftDisplay.fillRect(textPosition[0], textPosition[1], tftDisplay.width(), fontHeight, TFT_WHITE);
+  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+  unsigned long currentMillis = millis();
+  while(true)
+  {
+    currentMillis = millis();
+    CheckButtons(currentMillis);
+    // selection made, set state and break
+    if(buttons[0].buttonReleased)
     {
-      tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+      buttons[0].buttonReleased = false;
+      return;
     }
-    tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
-    textPosition[0] += tftDisplay.textWidth(outStr);
-
-    if(deviceSettings.is12Hour)
+    // down button, decrease ID by 1
+    else if(buttons[1].buttonReleased)
     {
-      sprintf(outStr, "%s", (isPM ? " PM" : " AM"));
-      if(setIdx == 6)
-      {
-        tftDisplay.setTextColor(TFT_BLACK, TFT_YELLOW);
-      }
-      else
+      buttons[1].buttonReleased = false;
+      if(deviceSettings.probeID <= 1)
       {
-        tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+        continue;
       }
-      tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
-    }
-
-    textPosition[0] = 5;
-    textPosition[1] += fontHeight;
-
-    if((deviceSettings.is12Hour &&  (setIdx >= 7)) ||
-       (!deviceSettings.is12Hour && (setIdx >= 6)))
-    {
-      break;
-    }
-
-    while(!buttons[0].buttonReleased)
+      deviceSettings.probeID -= 1;
+      sprintf(outStr, "\t%d", deviceSettings.probeID);
+      tftDisplay.fillRect(textPosition[0], textPosition[1], tftDisplay.width(), fontHeight, TFT_WHITE);
+      tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+    }      
+    // up button, increase ID by 1
+    else if(buttons[2].buttonReleased)
     {
-      curTime = millis();
-      CheckButtons(curTime);
-      // save time element, advance
-      if(buttons[0].buttonReleased)
+      buttons[2].buttonReleased = false;
+      if(deviceSettings.probeID >= CAL_ID_MAX)
       {
-        buttons[0].buttonReleased = false;
-        setIdx++;
+        continue;
       }
-      // increase/decrease
-      else if(buttons[1].buttonReleased)
-      {
-        buttons[1].buttonReleased = false;
-        delta = -1;
-      }
-      else if(buttons[2].buttonReleased)
-      {
-        buttons[2].buttonReleased = false;
-        delta = 1;
-      }
-      else
-      {
-        delta = 0;
-        continue;
-      }
-      switch (setIdx)
-      {
-        case 0:  // month
-          timeVals[MONTH] += delta;
-          if(timeVals[MONTH] <= 0)
-          {
-            timeVals[MONTH] = 12;
-          }
-          if(timeVals[MONTH] > 12)
-          {
-            timeVals[MONTH] = 1;
-          }
-          break;
-        case 1:  // date
-          timeVals[DATE] += delta;
-          if(timeVals[DATE] <= 0)
-          {
-            timeVals[DATE] = 31;
-          }
-          if(timeVals[DATE] > 31)
-          {
-            timeVals[DATE] = 1;
-          }
-          break;
-        case 2:  // year
-          timeVals[YEAR] += delta;
-          break;
-        case 3:  // day of week
-          timeVals[DAYOFWEEK] += delta;
-          if(timeVals[DAYOFWEEK] < 0)
-          {
-            timeVals[DAYOFWEEK] = 6;
-          }
-          if(timeVals[DAYOFWEEK] > 6)
-          {
-            timeVals[DAYOFWEEK] = 0;
-          }
-          break;
-        case 4:  // hour
-          timeVals[HOUR] += delta;
-          if(deviceSettings.is12Hour)
-          {
-            if(timeVals[HOUR] <= 0) // going back from 1 to 12
-            {
-              timeVals[HOUR] = 12;
-            }
-            if(timeVals[HOUR] > 12) // going forward from 12 to 1
-            {
-              timeVals[HOUR] = 1;
-            }
-          }
-          else
-          {
-            if(timeVals[HOUR] < 0)  // going back from 0 to 23 (12am to 11 pm)
-            {
-              timeVals[HOUR] = 23;
-            }
-            if(timeVals[HOUR] > 23) // going forward from 11pm to 12am
-            {
-              timeVals[HOUR] = 0;
-            }
-          }
-          break;
-        case 5:  // minute
-          timeVals[MINUTE] += delta;
-          if(timeVals[MINUTE] < 0)
-          {
-            timeVals[MINUTE] = 59;
-          }
-          if(timeVals[MINUTE] > 59)
-          {
-            timeVals[MINUTE] = 0;
-          }
-          break;
-        case 6:  // am/pm
-          if(delta != 0)
-          {
-            isPM = !isPM;
-          }
-          break;
-      }
-      break;
+      deviceSettings.probeID += 1;
+      sprintf(outStr, "\t%d", deviceSettings.probeID);
+      tftDisplay.fillRect(textPosition[0], textPosition[1], tftDisplay.width(), fontHeight, TFT_WHITE);
+      tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
     }
+    WaitButtonEvent(100);
   }
-  if((deviceSettings.is12Hour) && isPM && (timeVals[HOUR] < 12)) // convert to 24 hour clock for RTC module 
-  {
-    timeVals[HOUR] += 12;
-  }
-
-  RTC_SetDateTime(timeVals[YEAR], timeVals[MONTH], timeVals[DATE], timeVals[HOUR],timeVals[MINUTE],timeVals[SECOND]);
-  textPosition[1] += fontHeight * 2;
-  sprintf(outStr,"Set to %s %s", RTC_GetStringTime(), RTC_GetStringDate());
-  tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
-  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
-  SetFont(deviceSettings.fontPoints);
-  delay(5000);
 }
-
-// READ WRITE CREATE HTML SETUP FILES
-
 //
-// read car settings file
+// live probe temp (current calibration applied) until select, rawC is the average raw amplifier
+// reading over the last CAL_CAPTURE_AVG samples - returns false if cancelled with down
 //
-void ReadCarSetupFile(fs::FS &fs, const char * path)
+bool Cal_Capture(float& rawC)
 {
-  char buf[512];
-  File file = fs.open(path, FILE_READ);
-  if(!file)
+  char outStr[128];
+  float samples[CAL_CAPTURE_AVG];
+  int count = 0;
+  // reset buttons
+  for(int btnIdx = 0; btnIdx < BUTTON_COUNT; btnIdx++)
   {
-    return;
+    buttons[btnIdx].buttonReleased = false;
   }
-  ReadLine(file, buf);
-  carCount = atoi(buf);
-  cars = (CarSettings*)calloc(carCount, sizeof(CarSettings));
-  int maxTires = 0;
-  int maxPositions = 0;
-  for(int carIdx = 0; carIdx < carCount; carIdx++)
+  tftDisplay.fillScreen(TFT_WHITE);
+  YamuraBanner();
+  tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+  SetFont(deviceSettings.fontPoints);
+  textPosition[0] = 5;
+  textPosition[1] = 0;
+  tftDisplay.drawString("Probe on reference, select to capture", textPosition[0], textPosition[1], GFXFF);
+  textPosition[1] += fontHeight;
+  tftDisplay.drawString("Down to cancel", textPosition[0], textPosition[1], GFXFF);
+  textPosition[1] += 2 * fontHeight;
+  Thermo_SetFilter(THERMO_FILTER_DEFAULT);
+  // own schedule, sampleSchedule keeps the last measurement for diagnostics
+  SampleSchedule schedule;
+  Sched_Begin(schedule, CAL_CAPTURE_MS);
+  while(true)
   {
-    // read ID
-    ReadLine(file, buf);
-    cars[carIdx].carID = atoi(buf);
-    maxCarID = maxCarID > cars[carIdx].carID ? maxCarID : cars[carIdx].carID;
-    // read name
-    ReadLine(file, buf);
-    strcpy(cars[carIdx].carName, buf);
-    // read tire count and create arrays
-    ReadLine(file, buf);
-    cars[carIdx].tireCount = atoi(buf);
-    maxTires = maxTires > cars[carIdx].tireCount ? maxTires : cars[carIdx].tireCount;
-    // read tire short and long names
-    for(int tireIdx = 0; tireIdx < cars[carIdx].tireCount; tireIdx++)
-    {
-      ReadLine(file, buf);
-      strcpy(cars[carIdx].tireShortName[tireIdx], buf);
-      ReadLine(file, buf);
-      strcpy(cars[carIdx].tireLongName[tireIdx], buf);
-      ReadLine(file, buf);
-      cars[carIdx].maxTemp[tireIdx] = atof(buf);
-    }
-    // read measurement count and create arrays
-    ReadLine(file, buf);
-    cars[carIdx].positionCount = atoi(buf);
-    maxPositions = maxPositions > cars[carIdx].positionCount ? maxPositions : cars[carIdx].positionCount;
-    // read tire short and long names
-    for(int positionIdx = 0; positionIdx < cars[carIdx].positionCount; positionIdx++)
+    float temperature = Thermo_GetTemp();
+    if(thermoFault != THERMO_OK)
+    {
+      // start the average over once the probe reads again
+      count = 0;
+      snprintf(outStr, sizeof(outStr), "  %s           ", thermoFaultNames[thermoFault]);
+    }
+    else
+    {
+      samples[count % CAL_CAPTURE_AVG] = thermoHotC;
+      count++;
+      snprintf(outStr, sizeof(outStr), "        %0.2f         ", temperature);
+    }
+    tftDisplay.setFreeFont(FSS24); // max font
+    tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+    SetFont(deviceSettings.fontPoints);
+    CheckButtons(millis());
+    if(buttons[0].buttonReleased)
+    {
+      buttons[0].buttonReleased = false;
+      if(count >= CAL_CAPTURE_AVG)
+      {
+        break;
+      }
+    }
+    else if(buttons[1].buttonReleased)
     {
-      ReadLine(file, buf);
-      strcpy(cars[carIdx].positionShortName[positionIdx], buf);
-      ReadLine(file, buf);
-      strcpy(cars[carIdx].positionLongName[positionIdx], buf);
+      buttons[1].buttonReleased = false;
+      return false;
     }
-    // seperator
-    ReadLine(file, buf);
+    Sched_WaitNext(schedule);
   }
-  selectedCar = 0;
-  file.close();
+  rawC = 0.0F;
+  for(int idx = 0; idx < CAL_CAPTURE_AVG; idx++)
+  {
+    rawC += samples[idx];
+  }
+  rawC /= CAL_CAPTURE_AVG;
+  return true;
 }
 //
-// write car settings file
+// enter the reference temp in display units (up/down 0.1 from startTemp, select to accept)
+// returns it in degrees C
 //
-void WriteCarSetupFile(fs::FS &fs, const char * path)
+float Cal_EnterReference(float startTemp)
 {
-  char buf[512];
-  File file = fs.open(path, FILE_WRITE);
-  if(!file)
+  char outStr[128];
+  float refTemp = roundf(startTemp * 10.0F) / 10.0F;
+  // reset buttons
+  for(int btnIdx = 0; btnIdx < BUTTON_COUNT; btnIdx++)
   {
-    return;
+    buttons[btnIdx].buttonReleased = false;
   }
-  sprintf(buf, "%d", carCount);
-  file.println(buf);            // number of cars
-  for(int carIdx = 0; carIdx < carCount; carIdx++)
+  // erase screen, draw banner
+  tftDisplay.fillScreen(TFT_WHITE);
+  YamuraBanner();
+  tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+  // display title
+  SetFont(deviceSettings.fontPoints);
+  // display menu
+  textPosition[0] = 5;
+  textPosition[1] = 0;
+  sprintf(outStr, "Reference temperature:");
+  tftDisplay.fillRect(textPosition[0], textPosition[1], tftDisplay.width(), fontHeight, TFT_WHITE);
+  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+  textPosition[1] += fontHeight;
+  sprintf(outStr, "\t%0.1f", refTemp);
+  tftDisplay.fillRect(textPosition[0], textPosition[1], tftDisplay.width(), fontHeight, TFT_WHITE);
+  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+  unsigned long currentMillis = millis();
+  while(true)
   {
-    maxCarID = maxCarID > cars[carIdx].carID ? maxCarID : cars[carIdx].carID;
-    file.println(cars[carIdx].carID);    // carID
-    file.println(cars[carIdx].carName);    // car
-    sprintf(buf, "%d", cars[carIdx].tireCount);
-    file.println(buf);
-    for(int wheelIdx = 0; wheelIdx < cars[carIdx].tireCount; wheelIdx++)
+    currentMillis = millis();
+    CheckButtons(currentMillis);
+    // selection made, return it in C
+    if(buttons[0].buttonReleased)
     {
-      sprintf(buf, "%s", cars[carIdx].tireShortName[wheelIdx]);
-      file.println(buf);
-      sprintf(buf, "%s", cars[carIdx].tireLongName[wheelIdx]);
-      file.println(buf);
-      sprintf(buf, "%0.2lf", cars[carIdx].maxTemp[wheelIdx]);
-      file.println(buf);
+      buttons[0].buttonReleased = false;
+      return deviceSettings.tempUnits == 0 ? FtoCAbsolute(refTemp) : refTemp;
     }
-    sprintf(buf, "%d", cars[carIdx].positionCount);
-    file.println(buf);
-    for(int posIdx = 0; posIdx < cars[carIdx].positionCount; posIdx++)
+    // down button, decrease reference by .1
+    else if(buttons[1].buttonReleased)
     {
-      sprintf(buf, "%s", cars[carIdx].positionShortName[posIdx]);
-      file.println(buf);
-      sprintf(buf, "%s", cars[carIdx].positionLongName[posIdx]);
-      file.println(buf);
+      buttons[1].buttonReleased = false;
+      refTemp -= 0.1F;
+      sprintf(outStr, "\t%0.1f", refTemp);
+      tftDisplay.fillRect(textPosition[0], textPosition[1], tftDisplay.width(), fontHeight, TFT_WHITE);
+      tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+    }      
+    // up button, increase reference by .1
+    else if(buttons[2].buttonReleased)
+    {
+      buttons[2].buttonReleased = false;
+      refTemp += 0.1F;
+      sprintf(outStr, "\t%0.1f", refTemp);
+      tftDisplay.fillRect(textPosition[0], textPosition[1], tftDisplay.width(), fontHeight, TFT_WHITE);
+      tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
     }
-    file.println("=========="); 
+    WaitButtonEvent(100);
   }
-  file.close();
-  
-  #ifdef DEBUG_VERBOSE
-  Serial.println("Done writing, readback");
-  file = fs.open(path, FILE_READ);
-  Serial.println(path);
-  while(true)
+}
+//
+// index of probeID in calProbes, -1 if missing
+// add creates an empty entry for it if there is room
+//
+int Cal_FindProbe(int probeID, bool add)
+{
+  for(int probeIdx = 0; probeIdx < calProbeCount; probeIdx++)
   {
-    ReadLine(file, buf);
-    if(strlen(buf)==0)
+    if(calProbes[probeIdx].probeID == probeID)
     {
-      break;
+      return probeIdx;
     }
-    Serial.println(buf);
   }
-  Serial.println("Done");
-  file.close();
-  #endif
+  if(!add || (calProbeCount >= CAL_MAX_PROBES))
+  {
+    return -1;
+  }
+  calProbes[calProbeCount].probeID = probeID;
+  calProbes[calProbeCount].pointCount = 0;
+  calProbeCount++;
+  return calProbeCount - 1;
 }
 //
-// write car settings to HTML for web interface
+// build calTable from probeID's points, readings pass through uncorrected if it has none
 //
-void WriteCarSetupHTML(fs::FS &fs, const char * path, int carIdx)
+void Cal_Select(int probeID)
 {
-  DeleteFile(fs, path);
-  char buf[512];
-  File file = fs.open(path, FILE_WRITE);
-  if(!file)
+  int probeIdx = Cal_FindProbe(probeID, false);
+  if(probeIdx < 0)
   {
+    Cal_Build(calTable, NULL, 0);
     return;
   }
-  file.println("<html>");
-  file.println("<head>");
-  file.println("<meta charset=\"UTF-8\">");
-  file.println("<meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">");
-  file.println("<meta http-equiv=\"Cache-Control\" content=\"no-cache, no-store, must-revalidate\" />");
-  file.println("<meta http-equiv=\"Pragma\" content=\"no-cache\" /><meta http-equiv=\"Expires\" content=\"0\"/>");
-  file.println("<title>Yamura Tire Pyrometer</title>");
-  file.println("<link rel=\"icon\" href=\"data:,\">");
-  file.println("<link rel=\"stylesheet\" type=\"text/css\" href=\"style.css\">");
-  file.println("</head>");
-  file.println("<body>");
-  file.println("<div class=\"content\">");
-  file.println("<div class=\"card-grid\">");
-  file.println("<div class=\"card\">");
-  file.println("<form action=\"/\" method=\"POST\">");
-  file.println("<p>");
-  
-  file.println("<div>");
-  file.println("<h3>Car and Driver Info</h3>");
-  file.println("</div>");
-
-  file.println("<div class=\"dInput\" v-if=\"activeStage == 3\">");
-  file.println("<div><label for=\"car_id\">Car/Driver</label>");
-  sprintf(buf, "<input type=\"text\" id =\"car_id\" name=\"car_id\" value = \"%s\"></div>", cars[carIdx].carName);
-  file.println(buf);
-  file.println("</div>");
-
-  sprintf(buf, "<div><label for=\"tirecount_id\">Tires (%d)</label>", cars[carIdx].tireCount);
-  file.println(buf);
-  file.println("<div><select id =\"tirecount_id\" name=\"tirecount_id\"><br>");
-  sprintf(buf, "<option>%d</option>", cars[carIdx].tireCount);
-  file.println(buf);
-  file.println("<option>2</option>");  
-  file.println("<option>3</option>");
-  file.println("<option>4</option>");
-  file.println("<option>6</option>");
-  file.println("</select>");
-
-  sprintf(buf, "<div><label for=\"measurecount_id\">Measurements (%d)</label>", cars[carIdx].positionCount);
-  file.println(buf);
-  file.println("<div><select id =\"measurecount_id\" name=\"measurecount_id\"><br>");
-  sprintf(buf, "<option>%d</option>", cars[carIdx].positionCount);
-  file.println(buf);
-  file.println("<option>1</option>");  
-  file.println("<option>2</option>");
-  file.println("<option>3</option>");
-  file.println("</select>");
-  
-  file.println("</div>");
-  file.println("</p>");
-  file.println("<p>");
-  file.println("<div>");
-  file.println("<h3>Tire Info</h3>");
-  file.println("</div>");
-  for(int tireIdx = 0; tireIdx < 6; tireIdx++)
-  {
-    sprintf(buf, "<div class=\"dInput\" v-if=\"activeStage == 3\">");
-    file.println(buf);
-    if(tireIdx == 0)
-    {
-      sprintf(buf, "<div><label for=\"tire%d_full_id\">Full</label>", tireIdx);
-    }
-    else
-    {
-      sprintf(buf, "<div>");
-    }
-    file.println(buf);
-    if(tireIdx < cars[carIdx].tireCount)
-    {
-      sprintf(buf, "<input type=\"text\" id =\"tire%d_full_id\" name=\"tire%d_full_id\" value = \"%s\"></div>", tireIdx, tireIdx, cars[carIdx].tireLongName[tireIdx]);
-    }
-    else
-    {
-      sprintf(buf, "<input type=\"text\" id =\"tire%d_full_id\" name=\"tire%d_full_id\" value = \"%s\"></div>", tireIdx, tireIdx, "-");
-    }
-    file.println(buf);
-    if(tireIdx == 0)
-    {
-      sprintf(buf, "<div><label for=\"tire%d_short_id\">Short</label>", tireIdx);
-    }
-    else
-    {
-      sprintf(buf, "<div><label for=\"tire%d_short_id\"></label>", tireIdx);
-    }
-
-    file.println(buf);
-    if(tireIdx < cars[carIdx].tireCount)
-    {
-      sprintf(buf, "<input type=\"text\" id =\"tire%d_short_id\" name=\"tire%d_short_id\" value = \"%s\"></div>",  tireIdx, tireIdx, cars[carIdx].tireShortName[tireIdx]);
-    }
-    else
-    {
-      sprintf(buf, "<input type=\"text\" id =\"tire%d_short_id\" name=\"tire%d_short_id\" value = \"%s\"></div>",  tireIdx, tireIdx, "-");
-    }
-    file.println(buf);
-    if(tireIdx == 0)
-    {
-      sprintf(buf, "<div><label for=\"tire%d_maxt_id\">Max T</label>", tireIdx);
-    }
-    else
-    {
-      sprintf(buf, "<div><label for=\"tire%d_maxt_id\"></label>", tireIdx);
-    }
-    file.println(buf);
-    if(tireIdx < cars[carIdx].tireCount)
-    {
-      sprintf(buf, "<input type=\"text\" id =\"tire%d_maxt_id\" name=\"tire%d_maxt_id\" value = \"%0.1lf\"></div>", tireIdx, tireIdx, cars[carIdx].maxTemp[tireIdx]);
-    }
-    else
-    {
-      sprintf(buf, "<input type=\"text\" id =\"tire%d_maxt_id\" name=\"tire%d_maxt_id\" value = \"%s\"></div>", tireIdx, tireIdx, "-");
-    }
-    file.println(buf);
-    sprintf(buf, "</div>");
-    file.println(buf);
-  }
-  file.println("</p>");
-  file.println("<p>");
-  file.println("<div>");
-  file.println("<h3>Measure Points</h3>");
-  file.println("</div>");
-  for(int measIdx = 0; measIdx < 3; measIdx++)
+  Cal_Build(calTable, calProbes[probeIdx].points, calProbes[probeIdx].pointCount);
+}
+//
+// delete data files menu (Yes or No)
+//
+void DeleteDataFilesMenu(bool verify)
+{
+  int menuResult = 1;
+  MenuChoice deleteFileYN[2];
+  if(verify)
   {
-    file.println("<div class=\"dInput\" v-if=\"activeStage == 3\">");
-    if(measIdx == 0)
-    {
-      sprintf(buf, "<div><label for=\"position%d_full_id\">Full</label>", measIdx);
-    }
-    else
-    {
-      sprintf(buf, "<div>");
-    }
-    file.println(buf);
-    if(measIdx < cars[carIdx].positionCount)
-    {
-      sprintf(buf, "<input type=\"text\" id =\"position%d_full_id\" name=\"position%d_full_id\" value = \"%s\"></div>", measIdx, measIdx, cars[carIdx].positionLongName[measIdx]);
-    }
-    else
-    {
-      sprintf(buf, "<input type=\"text\" id =\"position%d_full_id\" name=\"position%d_full_id\" value = \"%s\"></div>", measIdx, measIdx, "-");
-    }
-    file.println(buf);
-    if(measIdx == 0)
-    {
-      sprintf(buf, "<div><label for=\"position%d_short_id\">Short</label>", measIdx);
-    }
-    else
-    {
-      sprintf(buf, "<div>");
-    }
-
-    file.println(buf);
-    if(measIdx < cars[carIdx].positionCount)
-    {
-      sprintf(buf, "<input type=\"text\" id =\"position%d_short_id\" name=\"position%d_short_id\" value = \"%s\"></div>", measIdx, measIdx, cars[carIdx].positionShortName[measIdx]);
-    }
-    else
-    {
-      sprintf(buf, "<input type=\"text\" id =\"position%d_short_id\" name=\"position%d_short_id\" value = \"%s\"></div>", measIdx, measIdx, "-");
-    }
-    file.println(buf);
-    file.println("</div>");
+    int menuCount = 2;
+    deleteFileYN[0].description = "Yes";      deleteFileYN[0].result = 1;
+    deleteFileYN[1].description = "No";   deleteFileYN[1].result = 0;
+    menuResult = MenuSelect(deviceSettings.fontPoints, deleteFileYN, menuCount, 1); 
   }
-  file.println("</table>");
-  file.println("<p>");
-  file.println("<div>");
-  file.println("<h3>Actions</h3>");
-  file.println("</div>");
-  file.println("<button name=\"update\" type =\"submit\" value =\"update\">Update</button>");
-  file.println("<button name=\"prior\"  type =\"submit\" value =\"prior\">Prior</button>");
-  file.println("<button name=\"next\"   type =\"submit\" value =\"next\">Next</button>");
-  file.println("<button name=\"delete\" type =\"submit\" value =\"delete\">Delete</button>");
-  file.println("<button name=\"new\"    type =\"submit\" value =\"new\">New</button>");
-  file.println("<button name=\"home\" type=\"submit\" value=\"home\"><a href=\"/py_main.html\">Home</a></button>");
-  file.println("</p>");
-  file.println("</form>");
-  file.println("</div>");
-  file.println("</div>");
-  file.println("</div>");
-  file.println("</body>");
-  file.println("</html>");
-  file.close();
-  delay(100);
-  #ifdef DEBUG_VERBOSE
-  file = fs.open(path, FILE_READ);
-  Serial.println(path);
-  while(true)
+  if(menuResult == 1)
   {
-    ReadLine(file, buf);
-    if(strlen(buf)==0)
+    int dataIdx = 0;
+    char nameBuf[128];
+    // a results page part written still has a results file open
+    Results_HTMLCancel();
+    for(int dataIdx = 0; dataIdx < 100; dataIdx++)
     {
-      break;
+      sprintf(nameBuf, "/py_temps_%d.txt", dataIdx);
+      if(!SD.exists(nameBuf))
+      {
+        continue;
+      }
+      DeleteFile(SD, nameBuf);
     }
-    Serial.println(buf);
+    DeleteFile(SD, "/py_res.html");
+    DeleteFile(SD, TRACE_PATH);
+    // create the HTML header
+    WriteResultsHTML(/*LittleFS*/SD);
   }
-  Serial.println("Done");
-  file.close();
-  #endif
 }
 //
-// read device settings file
+// show timing probes, last/average/max in ms, select any line to exit
 //
-void ReadDeviceSetupFile(fs::FS &fs, const char * path)
+void DiagnosticsMenu()
 {
-  char buf[512];
-  File file = fs.open(path, FILE_READ);
-  if(!file)
+  char buf[128];
+  MenuChoice diagChoices[PROBE_COUNT + 2];
+  sprintf(buf, "Up %lus, heap %u", millis() / 1000, ESP.getFreeHeap());
+  diagChoices[0].description = buf;
+  diagChoices[0].result = 0;
+  sprintf(buf, "Samples %lu ms %0.2f Hz, %lu overruns", sampleSchedule.periodMs, Sched_RateHz(sampleSchedule), sampleSchedule.overruns);
+  diagChoices[PROBE_COUNT + 1].description = buf;
+  diagChoices[PROBE_COUNT + 1].result = PROBE_COUNT + 1;
+  for(int probeIdx = 0; probeIdx < PROBE_COUNT; probeIdx++)
   {
-    return;
+    TimingProbe& probe = timingProbes[probeIdx];
+    if(probe.count == 0)
+    {
+      sprintf(buf, "%s -", probe.name);
+    }
+    else
+    {
+      sprintf(buf, "%s %0.1f/%0.1f/%0.1f ms (%u)", probe.name,
+                                                 probe.lastUs / 1000.0,
+                                                 (probe.totalUs / probe.count) / 1000.0,
+                                                 probe.maxUs / 1000.0,
+                                                 probe.count);
+    }
+    diagChoices[probeIdx + 1].description = buf;
+    diagChoices[probeIdx + 1].result = probeIdx + 1;
   }
-  ReadLine(file, buf);
-  sprintf(deviceSettings.ssid, buf);
-  ReadLine(file, buf);
-  sprintf(deviceSettings.pass, buf);
-  ReadLine(file, buf);
-  deviceSettings.screenRotation = atoi(buf);
-  ReadLine(file, buf);
-  deviceSettings.stableBand[0] = atof(buf) / -2.0;
-  deviceSettings.stableBand[1] = atof(buf) / 2.0;
-  ReadLine(file, buf);
-  deviceSettings.stableDelay = atoi(buf);
-  ReadLine(file, buf);
-  deviceSettings.stableBuffer = atoi(buf);
-  int temp = 0;
-  ReadLine(file, buf);
-  temp = atoi(buf);
-  deviceSettings.tempUnits = temp == 0 ? false : true;
-  ReadLine(file, buf);
-  temp = atoi(buf);
-  deviceSettings.is12Hour = temp == 0 ? false : true;
-  ReadLine(file, buf);
-  deviceSettings.fontPoints = atoi(buf);
+  MenuSelect(9, diagChoices, PROBE_COUNT + 2, 0);
 }
 //
-// write device settings file
+// return next state as selection from choices array
+// initialSelect defines the item in choices selected at the start of user input
 //
-void WriteDeviceSetupFile(fs::FS &fs, const char * path)
+int MenuSelect(int fontSize, MenuChoice choices[], int menuCount, int initialSelect)
 {
-  char buf[512];
-  DeleteFile(fs, path);
-  File file = fs.open(path, FILE_WRITE);
-  if(!file)
-  {
-    return;
-  }
-  file.println(deviceSettings.ssid);
-  file.println(deviceSettings.pass);
-  file.println(deviceSettings.screenRotation);
-  file.println(deviceSettings.stableBand[1] * 2.0);
-  file.println(deviceSettings.stableDelay);
-  file.println(deviceSettings.stableBuffer);
-  file.println(deviceSettings.tempUnits ? 1 : 0);
-  file.println(deviceSettings.is12Hour ? 1 : 0);
-  file.println(deviceSettings.fontPoints);
-  file.close();
-  #ifdef DEBUG_VERBOSE
-  Serial.println("Done writing, readback");
-  file = fs.open(path, FILE_READ);
-  Serial.println(path);
-  while(true)
+  char outStr[256];
+  // location of text
+  textPosition[0] = 5;
+  textPosition[1] = 0;
+  unsigned long currentMillis = millis();
+  // find initial selection
+  int selection = initialSelect;
+  for(int selIdx = 0; selIdx < menuCount; selIdx++)
   {
-    ReadLine(file, buf);
-    if(strlen(buf)==0)
+    if(choices[selIdx].result == initialSelect)
     {
-      break;
+      selection = selIdx;
     }
-    Serial.println(buf);
   }
-  Serial.println("Done");
-  file.close();
-  #endif
-}
-//
-// write device settings to HTML for web interface
-//
-void WriteDeviceSetupHTML(fs::FS &fs, const char * path)
-{
-  Serial.println("Write device setup file");
-  int selectedIndex = 0;
-  char buf[512];
-  DeleteFile(fs, path);
-  File file = fs.open(path, FILE_WRITE);
-  if(!file)
+  // reset buttons
+  for(int btnIdx = 0; btnIdx < BUTTON_COUNT; btnIdx++)
   {
-    return;
+    buttons[btnIdx].buttonReleased = false;
   }
-  file.println("<!DOCTYPE html>");
-  file.println("<html>");
-  file.println("<head>");
-  file.println("<meta charset=\"UTF-8\">");
-  file.println("<meta name=\"viewport\" content=\"width=device-width, initial-scale=1\">");
-  file.println("<meta http-equiv=\"Cache-Control\" content=\"no-cache, no-store, must-revalidate\" />");
-  file.println("<meta http-equiv=\"Pragma\" content=\"no-cache\" /><meta http-equiv=\"Expires\" content=\"0\"/>");
-  file.println("<title>Yamura Pyrometer Setup</title>");
-  file.println("<link rel=\"icon\" href=\"data:,\">");
-  file.println("<link rel=\"stylesheet\" type=\"text/css\" href=\"style.css\">");
-  file.println("</head>");
-
-  file.println("<body>");
-  file.println("<div class=\"content\">");
-  file.println("<div class=\"card-grid\">");
-  file.println("<div class=\"card\">");
-  file.println("<form action=\"/\" method=\"POST\">");
-
-  file.println("<p>");
-  file.println("<div>");
-  file.println("<h3>Pyrometer Settings</h3>");
-  file.println("</div>");
-  file.println("</p>");
-
-  file.println("<p>");
-  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
-  file.println("<label for=\"ssid_id\">SSID</label>");
-  sprintf(buf, "<div><input type=\"text\" id =\"ssid_id\" name=\"ssid_id\" value = \"%s\"><br>", deviceSettings.ssid);
-  file.println(buf);
-  file.println("</div>");
-  file.println("</p>");
-  
-  file.println("<p>");
-  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
-  file.println("<label for=\"pass_id\">Password</label>");
-  sprintf(buf, "<div><input type=\"text\" id =\"pass_id\" name=\"pass_id\" value = \"%s\"><br>", deviceSettings.pass);
-  file.println(buf);
-  file.println("</div>");
-  file.println("</p>");
-  
-  file.println("<p>");
-  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
-  selectedIndex = deviceSettings.tempUnits == true ? 0 : 1;
-  sprintf(buf, "<label for=\"units_id\">Temperature Units (%s)</label>", (deviceSettings.tempUnits == true ? "C" : "F"));
-  file.println(buf);
-  file.println("<div><select id =\"units_id\" name=\"units_id\"><br>");
-  sprintf(buf, "<option>%s</option>", (deviceSettings.tempUnits == true ? "C" : "F"));
-  file.println(buf);
-  file.println("<option>F</option>");  
-  file.println("<option>C</option>");
-  file.println("</select>");
-  file.println("</div>");
-  file.println("</p>");
-
-  file.println("<p>");
-  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
-  sprintf(buf, "<label for=\"orientation_id\">Screen Orientation (%s)</label>", (deviceSettings.screenRotation == 1 ? "R" : "L"));
-  file.println(buf);
-
-  file.println("<div><select id =\"orientation_id\" name=\"orientation_id\"><br>");
-  sprintf(buf, "<option>%s</option>", (deviceSettings.screenRotation == 1 ? "R" : "L"));
-  file.println(buf);
-  file.println("<option>R</option>");  
-  file.println("<option>L</option>");
-  file.println("</select>");
-  file.println("</div>");
-  file.println("</p>");
-
-  file.println("<p>");
-  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
-  file.println(" <label for=\"bandwidth_id\">Temperature Stable Bandwidth</label>");
-  sprintf(buf, "<div><input type=\"text\" id =\"bandwidth_id\" name=\"bandwidth_id\" value = \"%f\"><br>", (deviceSettings.stableBand[1] * 2.0));
-  file.println(buf);
-  file.println("</div>");
-  file.println("</p>");
-
-  file.println("<p>");
-  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
-  file.println(" <label for=\"stablebuffer_id\">Temperature buffer</label>");
-  sprintf(buf, "<div><input type=\"text\" id =\"stablebuffer_id\" name=\"stablebuffer_id\" value = \"%d\"><br>", deviceSettings.stableBuffer);
-  file.println(buf);
-  file.println("</div>");
-  file.println("</p>");
-
-  file.println("<p>");
-  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
-  file.println(" <label for=\"stabledelay_id\">Temperature Stable Delay (ms)</label>");
-  sprintf(buf, "<div><input type=\"text\" id =\"stabledelay_id\" name=\"stabledelay_id\" value = \"%ld\"><br>", deviceSettings.stableDelay);
-  file.println(buf);
-  file.println("</div>");
-  file.println("</p>");
-
-  file.println("<p>");
-  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
-  sprintf(buf, "<label for=\"clock_id\">Clock (%d)</label>", (deviceSettings.is12Hour == true ? 12 : 24));
-  file.println(buf);
-  file.println("<div><select id =\"clock_id\" name=\"clock_id\"><br>");
-  sprintf(buf, "<option>%d</option>", (deviceSettings.is12Hour == true ? 12 : 24));
-  file.println(buf);
-  file.println("<option>12</option>");  
-  file.println("<option>24</option>");
-  file.println("</select>");
-  file.println("</div>");
-  file.println("</p>");
-
-  file.println("<p>");
-  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
-  sprintf(buf, "<label for=\"fontsize_id\">Font Size (%d)</label>", deviceSettings.fontPoints);
-  file.println(buf);
-  file.println("<div><select id =\"fontsize_id\" name=\"fontsize_id\"><br>");
-  sprintf(buf, "<option>%d</option>", deviceSettings.fontPoints);
-  file.println(buf);
-  file.println("<option>9</option>");
-  file.println("<option>12</option>");  
-  file.println("<option>18</option>");
-  file.println("<option>24</option>");
-  file.println("</select>");
-
-  file.println("</div>");
-  file.println("</p>");
-  
-  file.println("<p>");
-  file.println("<div>");
-  file.println("<h3>Actions</h3>");
-  file.println("</div>");  
-  file.println("<button name=\"update\" type =\"submit\" value =\"update\">Update</button>");
-  file.println("<button><a href=\"py_main.html\">Home</a></button>");
-  file.println("</p>");
-  file.println("</form>");
-  file.println("</div>");
-  file.println("</div>");
-  file.println("</div>");
-  file.println("</div>");
-  file.println("</body>");
-  file.println("</html>");
-  file.close();
-
-  #ifdef DEBUG_VERBOSE
-  Serial.println("Done writing, readback");
-  file = fs.open(path, FILE_READ);
-  Serial.println(path);
+  // erase screen, draw banner
+  tftDisplay.fillScreen(TFT_WHITE);
+  YamuraBanner();
+  // loop until selection is made
+  SetFont(fontSize);
+  int linesToDisplay = (tftDisplay.height() - 10)/fontHeight;
+  // range of selections to display (allow scrolling)
+  int displayRange[2] = {0, linesToDisplay - 1 };
+  displayRange[1] = (menuCount < linesToDisplay ? menuCount : linesToDisplay) - 1;
+  // display menu
   while(true)
   {
-    ReadLine(file, buf);
-    if(strlen(buf)==0)
-    {
-      break;
-    }
-    Serial.println(buf);
-  }
-  Serial.println("Done");
-  file.close();
-  #endif
-}
-//
-// write all results to HTML file for web interface
-//
-void WriteResultsHTML(fs::FS &fs)
-{
-  char buf[512];
-  char outStr[512];
-  char tmpStr[512];
-  char nameBuf[128];
-  CarSettings currentResultCar;
-  File fileIn;   // data source file
-  File fileOut;  // html results file
-  // create a new HTML file
-  #ifdef DEBUG_VERBOSE
-  Serial.println("py_res.html header");
-  #endif
-  DeleteFile(fs, "/py_res.html");
-  fileOut = fs.open("/py_res.html", FILE_WRITE);
-  if(!fileOut)
-  {
-    Serial.println("failed to open data HTML file /py_res.html");
-    return;
-  }
-
-  fileOut.println("<!DOCTYPE html>");
-  fileOut.println("<html>");
-  fileOut.println("<head>");
-  fileOut.println("<title>Recording Pyrometer</title>");
-  fileOut.println("</head>");
-  fileOut.println("<body>");
-  fileOut.println("<h1>Recorded Results</h1>");
-  fileOut.println("<p>");
-  fileOut.println("<table border=\"1\">");
-  fileOut.println("<tr>");
-  fileOut.println("<th>Date/Time</th>");
-  fileOut.println("<th>Car/Driver</th>");
-  fileOut.println("</tr>");
-  float tireMin =  999.9;
-  float tireMax = -999.9;
-  int rowCount = 0;
-  bool outputSubHeader = true;
-  for (int dataFileCount = 0; dataFileCount < 100; dataFileCount++)
-  {
-    sprintf(nameBuf, "/py_temps_%d.txt", dataFileCount);
-    fileIn = SD.open(nameBuf, FILE_READ);
-    if(!fileIn)
+    uint32_t probeStart = Probe_Start();
+    textPosition[0] = 5;
+    textPosition[1] = 0;
+    for(int menuIdx = displayRange[0]; menuIdx <= displayRange[1]; menuIdx++)
     {
-      continue;
+      //sprintf(outStr, "%s", choices[menuIdx].description.c_str());
+      tftDisplay.fillRect(textPosition[0], textPosition[1], tftDisplay.width(), fontHeight, TFT_WHITE);
+      if(menuIdx == selection)
+      {
+        //sprintf(outStr, ">%s", choices[menuIdx].description.c_str());
+        tftDisplay.setTextColor(TFT_WHITE, TFT_RED);
+        tftDisplay.drawString(">", textPosition[0], textPosition[1], GFXFF);
+      }
+      //else
+      //{
+      textPosition[0] = fontWidth;
+        sprintf(outStr, "%s", choices[menuIdx].description.c_str());
+        tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+        tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+      //}
+      textPosition[0] = 0;
+      textPosition[1] += fontHeight;
     }
-    outputSubHeader = true;
+    Probe_Stop(PROBE_MENU_DRAW, probeStart);
     while(true)
     {
-      ReadLine(fileIn, buf);
-      // end of file
-      if(strlen(buf) == 0)
+      currentMillis = millis();
+      CheckButtons(currentMillis);
+      // selection made, set state and break
+      if(buttons[0].buttonReleased)
       {
-        fileIn.close();
-        break;
+        buttons[0].buttonReleased = false;
+        return choices[selection].result;
       }
-      ReadMeasurementFile(buf, currentResultCar);
-      if(outputSubHeader)
+      // change selection down, break
+      else if(buttons[1].buttonReleased)
       {
-        fileOut.println("<tr>");
-        fileOut.println("<td></td>");
-        fileOut.println("<td></td>");
-        for(int t_idx = 0; t_idx < currentResultCar.tireCount; t_idx++)
+        buttons[1].buttonReleased = false;
+        selection = (selection + 1) < menuCount ? (selection + 1) : 0;
+        // handle loop back to start
+        if (selection < displayRange[0])
         {
-          for(int p_idx = 0; p_idx < currentResultCar.positionCount; p_idx++)
-          {
-            sprintf(buf, "<td>%s-%s</td>", currentResultCar.tireShortName[t_idx], currentResultCar.positionShortName[p_idx]);
-            fileOut.println(buf);
-          }
+          displayRange[0] = selection;
+          displayRange[1] = displayRange[0] + linesToDisplay - 1; 
+        }
+        // show next line at bottom
+        else 
+        if (selection > displayRange[1])
+        {
+          displayRange[1] = selection; 
+          displayRange[0] = displayRange[1] - linesToDisplay + 1;
         }
-        fileOut.println("</tr>");
-      }
-      outputSubHeader = false;
-      rowCount++;
-      fileOut.println("<tr>");
-      sprintf(buf, "<td>%s</td>", currentResultCar.dateTime);
-      fileOut.println(buf);
-      sprintf(buf, "<td>%s</td>", currentResultCar.carName);
-      fileOut.println(buf);
-      for(int t_idx = 0; t_idx < currentResultCar.tireCount; t_idx++)
-      {
-        tireMin =  999.9;
-        tireMax = -999.9;
-        // get min/max temps
-        for(int p_idx = 0; p_idx < currentResultCar.positionCount; p_idx++)
+        break;
+      }
+      // change selection up, break
+      else if(buttons[2].buttonReleased)
+      {
+        buttons[2].buttonReleased = false;
+        selection = (selection - 1) >= 0 ? (selection - 1) : menuCount - 1;
+        // handle loop back to start
+        if (selection < displayRange[0])
         {
-          tireMin = tireMin < tireTemps[(t_idx * currentResultCar.positionCount) + p_idx] ? tireMin : tireTemps[(t_idx * currentResultCar.positionCount) + p_idx];
-          tireMax = tireMax > tireTemps[(t_idx * currentResultCar.positionCount) + p_idx] ? tireMax : tireTemps[(t_idx * currentResultCar.positionCount) + p_idx];
+          displayRange[0] = selection;
+          displayRange[1] = displayRange[0] + linesToDisplay - 1; 
         }
-        // add cells to file
-        for(int p_idx = 0; p_idx < currentResultCar.positionCount; p_idx++)
+        // show next line at bottom
+        else 
+        if (selection > displayRange[1])
         {
-          //if(tireTemps[(t_idx * currentResultCar.positionCount) + p_idx] >= currentResultCar.maxTemp[t_idx])
-          //{
-          //  sprintf(buf, "<td bgcolor=\"red\">%0.2f</td>", tireTemps[(t_idx * currentResultCar.positionCount) + p_idx]);
-          //}
-          //else if(tireTemps[(t_idx * currentResultCar.positionCount) + p_idx] <= tireMin)
-          //{
-          //  sprintf(buf, "<td bgcolor=\"cyan\">%0.2f</td>", tireTemps[(t_idx * currentResultCar.positionCount) + p_idx]);
-          //}
-          //else 
-          if (tireTemps[(t_idx * currentResultCar.positionCount) + p_idx] == tireMax)
-          {
-            sprintf(buf, "<td bgcolor=\"red\">%0.2f</td>", tireTemps[(t_idx * currentResultCar.positionCount) + p_idx]);
-          }
-          else
-          {
-            sprintf(buf, "<td>%0.2f</td>", tireTemps[(t_idx * currentResultCar.positionCount) + p_idx]);
-          }
-          fileOut.println(buf);
+          displayRange[1] = selection; 
+          displayRange[0] = displayRange[1] - linesToDisplay + 1;
         }
+        break;
       }
-      fileOut.println("</tr>");
-    }
-    fileIn.close();
-  }
-  if(rowCount == 0)
-  {
-    rowCount++;
-    fileOut.println("<tr>");
-    sprintf(buf, "<td>---</td>");
-    fileOut.println(buf);
-    sprintf(buf, "<td>---</td>");
-    fileOut.println(buf);
-    for(int t_idx = 0; t_idx < 4; t_idx++)
-    {
-      tireMin =  999.9;
-      tireMax = -999.9;
-      sprintf(buf, "<td>---</td>");
-      fileOut.println(buf);
-      // add cells to file
-      for(int p_idx = 0; p_idx < 3; p_idx++)
+      else if(buttons[3].buttonReleased)
       {
-        sprintf(buf, "<td>---</td>");
-        fileOut.println(buf);
       }
+      WaitButtonEvent(100);
     }
-    fileOut.println("</tr>");
   }
-  fileOut.println("</table>");
-  fileOut.println("</p>");
-  fileOut.println("<p>");
-  fileOut.println("<button name=\"home\" type=\"submit\" value=\"home\"><a href=\"/py_main.html\">Home</a></button>");
-  fileOut.println("</p>");
-  // add copy button, raw results text and script
-  fileOut.println("<p>");
-  fileOut.println("<button onclick=\"copyResults()\">Copy data</button>");
-  fileOut.println("</p>");
-  fileOut.println("<p>");
-  fileOut.println("<textarea id=\"rawTextResultsID\" rows=\"20\" cols=\"100\">");
-  rowCount = 0;
-  for (int dataFileCount = 0; dataFileCount < 100; dataFileCount++)
-  {
-    sprintf(nameBuf, "/py_temps_%d.txt", dataFileCount);
-    fileIn = SD.open(nameBuf, FILE_READ);
-    if(!fileIn)
-    {
-      continue;
-    }
-    outputSubHeader = true;
-    while(true)
-    {
-      ReadLine(fileIn, buf);
-      // end of file
-      if(strlen(buf) == 0)
-      {
-        fileIn.close();
-        break;
-      }
-      ReadMeasurementFile(buf, currentResultCar);
-      if(outputSubHeader)
+  return choices[selection].result;
+}
+//
+// user set date/time
+//
+void SetDateTime()
+{
+  char outStr[256];
+  int timeVals[8] = {0, 0, 0, 0, 0, 0, 0, 0};  // date, month, year, day, hour, min, sec, 100ths
+  // location of text
+  textPosition[0] = 5;
+  textPosition[1] = 0;
+  int setIdx = 0;
+  unsigned long curTime = millis();
+  int delta = 0;
+  #ifndef HAS_RTC
+  tftDisplay.fillScreen(TFT_WHITE);
+  YamuraBanner();
+  tftDisplay.drawString("RTC not present", textPosition[0], textPosition[1], GFXFF);
+  delay(5000);
+  return;
+  #endif
+  DateTime now;
+  now = Clock_Now();
+  int year = now.year();
+  int month = now.month();
+  int day = now.day();
+  int dayOfWeek = now.dayOfTheWeek();
+  bool isPM = now.isPM();
+
+  timeVals[DATE] = now.day();
+  timeVals[MONTH] = now.month();
+  timeVals[YEAR] = now.year();
+  timeVals[DAYOFWEEK] = now.dayOfTheWeek();
+  timeVals[HOUR] = now.hour();
+  if((now.isPM()) && (!deviceSettings.is12Hour))
+  {
+    timeVals[HOUR] += 12;
+  }
+  timeVals[MINUTE] = now.minute();
+  for(int btnIdx = 0; btnIdx < BUTTON_COUNT; btnIdx++)
+  {
+    buttons[btnIdx].buttonReleased = false;
+  }
+  while(true)
+  {
+    textPosition[0] = 5;
+    textPosition[1] = 0;
+    tftDisplay.fillScreen(TFT_WHITE);
+    YamuraBanner();
+    SetFont(24);
+    tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+  
+    tftDisplay.drawString("Set date/time", textPosition[0], textPosition[1], GFXFF);
+    
+    textPosition[1] += fontHeight;
+
+    sprintf(outStr, "%02d", timeVals[MONTH]);
+    if(setIdx == 0)
+    {
+      tftDisplay.setTextColor(TFT_BLACK, TFT_YELLOW);
+    }
+    else
+    {
+      tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+    }
+    tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
+    textPosition[0] += tftDisplay.textWidth(outStr);
+
+    sprintf(outStr, "/");
+    tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+    tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
+    textPosition[0] += tftDisplay.textWidth(outStr);
+
+    sprintf(outStr, "%02d", timeVals[DATE]);
+    if(setIdx == 1)
+    {
+      tftDisplay.setTextColor(TFT_BLACK, TFT_YELLOW);
+    }
+    else
+    {
+      tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+    }
+    tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
+    textPosition[0] += tftDisplay.textWidth(outStr);
+
+    sprintf(outStr, "/");
+    tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+    tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
+    textPosition[0] += tftDisplay.textWidth(outStr);
+
+    sprintf(outStr, "%02d", timeVals[YEAR]);
+    if(setIdx == 2)
+    {
+      tftDisplay.setTextColor(TFT_BLACK, TFT_YELLOW);
+    }
+    else
+    {
+      tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+    }
+    tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
+    textPosition[0] += tftDisplay.textWidth(outStr);
+
+    sprintf(outStr, " %s", days[timeVals[DAYOFWEEK]]);
+    if(setIdx == 3)
+    {
+      tftDisplay.setTextColor(TFT_BLACK, TFT_YELLOW);
+    }
+    else
+    {
+      tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+    }
+    tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
+
+    textPosition[0] = 5;
+    textPosition[1] += fontHeight;
+
+    sprintf(outStr, "%02d", timeVals[HOUR]);
+    if(setIdx == 4)
+    {
+      tftDisplay.setTextColor(TFT_BLACK, TFT_YELLOW);
+    }
+    else
+    {
+      tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+    }
+    tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
+    textPosition[0] += tftDisplay.textWidth(outStr);
+
+    sprintf(outStr, ":");
+    tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+    tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
+    textPosition[0] += tftDisplay.textWidth(outStr);
+
+    sprintf(outStr, "%02d", timeVals[MINUTE]);
+    if(setIdx == 5)
+    {
+      tftDisplay.setTextColor(TFT_BLACK, TFT_YELLOW);
+    }
+    else
+    {
+      tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+    }
+    tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
+    textPosition[0] += tftDisplay.textWidth(outStr);
+
+    if(deviceSettings.is12Hour)
+    {
+      sprintf(outStr, "%s", (isPM ? " PM" : " AM"));
+      if(setIdx == 6)
       {
-        sprintf(outStr, "\t%s", currentResultCar.carName);
-        for(int tireIdx = 0; tireIdx < currentResultCar.tireCount; tireIdx++)
-        {
-          for(int posIdx = 0; posIdx < currentResultCar.positionCount; posIdx++)
-          {
-            sprintf(tmpStr, "\t%s-%s", currentResultCar.tireShortName[tireIdx], currentResultCar.positionShortName[posIdx]);
-            strcat(outStr, tmpStr);
-          }
-        }
-        fileOut.println(outStr);
-        outputSubHeader = false;
+        tftDisplay.setTextColor(TFT_BLACK, TFT_YELLOW);
       }
-      sprintf(outStr, "%s\t%s", currentResultCar.dateTime, currentResultCar.carName);
-      for(int t_idx = 0; t_idx < currentResultCar.tireCount; t_idx++)
+      else
       {
-        // add cells to file
-        for(int p_idx = 0; p_idx < currentResultCar.positionCount; p_idx++)
-        {
-          sprintf(tmpStr, "\t%lf", tireTemps[(t_idx * currentResultCar.positionCount) + p_idx]);
-          strcat(outStr, tmpStr);
-        }
+        tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
       }
-      fileOut.println(outStr);
-      rowCount++;
-    }
-    fileIn.close();
-  }
-  fileOut.println("</textarea>");
-  fileOut.println("</p>");
-  fileOut.println("</body>");
-  fileOut.println("<script>");
-  fileOut.println("function copyResults() {");
-  fileOut.println("var copyText = document.getElementById(\"rawTextResultsID\");");
-  fileOut.println("copyText.select();");
-  fileOut.println("copyText.setSelectionRange(0, 99999);");
-  fileOut.println("navigator.clipboard.writeText(copyText.value);");
-  fileOut.println("}");
-  fileOut.println("</script>");
-  fileOut.println("</html>");
-  fileOut.close();
+      tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);
+    }
 
-  #ifdef DEBUG_VERBOSE
-  Serial.println("Done writing, readback");
-  fileIn = /*LittleFS*/SD.open("/py_res.html", FILE_READ);
-  Serial.println("/py_res.html");
-  while(true)
-  {
-    ReadLine(fileIn, buf);
-    if(strlen(buf)==0)
+    textPosition[0] = 5;
+    textPosition[1] += fontHeight;
+
+    if((deviceSettings.is12Hour &&  (setIdx >= 7)) ||
+       (!deviceSettings.is12Hour && (setIdx >= 6)))
+    {
+      break;
+    }
+
+    while(!buttons[0].buttonReleased)
     {
+      curTime = millis();
+      CheckButtons(curTime);
+      // save time element, advance
+      if(buttons[0].buttonReleased)
+      {
+        buttons[0].buttonReleased = false;
+        setIdx++;
+      }
+      // increase/decrease
+      else if(buttons[1].buttonReleased)
+      {
+        buttons[1].buttonReleased = false;
+        delta = -1;
+      }
+      else if(buttons[2].buttonReleased)
+      {
+        buttons[2].buttonReleased = false;
+        delta = 1;
+      }
+      else
+      {
+        delta = 0;
+        WaitButtonEvent(100);
+        continue;
+      }
+      switch (setIdx)
+      {
+        case 0:  // month
+          timeVals[MONTH] += delta;
+          if(timeVals[MONTH] <= 0)
+          {
+            timeVals[MONTH] = 12;
+          }
+          if(timeVals[MONTH] > 12)
+          {
+            timeVals[MONTH] = 1;
+          }
+          break;
+        case 1:  // date
+          timeVals[DATE] += delta;
+          if(timeVals[DATE] <= 0)
+          {
+            timeVals[DATE] = 31;
+          }
+          if(timeVals[DATE] > 31)
+          {
+            timeVals[DATE] = 1;
+          }
+          break;
+        case 2:  // year
+          timeVals[YEAR] += delta;
+          break;
+        case 3:  // day of week
+          timeVals[DAYOFWEEK] += delta;
+          if(timeVals[DAYOFWEEK] < 0)
+          {
+            timeVals[DAYOFWEEK] = 6;
+          }
+          if(timeVals[DAYOFWEEK] > 6)
+          {
+            timeVals[DAYOFWEEK] = 0;
+          }
+          break;
+        case 4:  // hour
+          timeVals[HOUR] += delta;
+          if(deviceSettings.is12Hour)
+          {
+            if(timeVals[HOUR] <= 0) // going back from 1 to 12
+            {
+              timeVals[HOUR] = 12;
+            }
+            if(timeVals[HOUR] > 12) // going forward from 12 to 1
+            {
+              timeVals[HOUR] = 1;
+            }
+          }
+          else
+          {
+            if(timeVals[HOUR] < 0)  // going back from 0 to 23 (12am to 11 pm)
+            {
+              timeVals[HOUR] = 23;
+            }
+            if(timeVals[HOUR] > 23) // going forward from 11pm to 12am
+            {
+              timeVals[HOUR] = 0;
+            }
+          }
+          break;
+        case 5:  // minute
+          timeVals[MINUTE] += delta;
+          if(timeVals[MINUTE] < 0)
+          {
+            timeVals[MINUTE] = 59;
+          }
+          if(timeVals[MINUTE] > 59)
+          {
+            timeVals[MINUTE] = 0;
+          }
+          break;
+        case 6:  // am/pm
+          if(delta != 0)
+          {
+            isPM = !isPM;
+          }
+          break;
+      }
+      break;
+    }
+  }
+  if((deviceSettings.is12Hour) && isPM && (timeVals[HOUR] < 12)) // convert to 24 hour clock for RTC module 
+  {
+    timeVals[HOUR] += 12;
+  }
+
+  RTC_SetDateTime(timeVals[YEAR], timeVals[MONTH], timeVals[DATE], timeVals[HOUR],timeVals[MINUTE],timeVals[SECOND]);
+  textPosition[1] += fontHeight * 2;
+  char timeStr[RTC_STRING_SIZE];
+  char dateStr[RTC_STRING_SIZE];
+  sprintf(outStr,"Set to %s %s", RTC_GetStringTime(timeStr, sizeof(timeStr)), RTC_GetStringDate(dateStr, sizeof(dateStr)));
+  tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+  SetFont(deviceSettings.fontPoints);
+  delay(5000);
+}
+
+// READ WRITE CREATE HTML SETUP FILES
+
+//
+// add a name to a string pool, returns its offset
+// identical names are stored once, names are truncated to POOL_NAME_MAX
+// returns 0 ("") for an empty name or if the pool can't grow
+//
+uint16_t Pool_Add(StringPool& pool, const char* value)
+{
+  if((value == NULL) || (value[0] == '\0'))
+  {
+    return 0;
+  }
+  int len = strnlen(value, POOL_NAME_MAX);
+  // reuse an existing copy
+  for(int offset = 1; offset < pool.used; offset += strlen(&pool.text[offset]) + 1)
+  {
+    if((strncmp(&pool.text[offset], value, len) == 0) && (pool.text[offset + len] == '\0'))
+    {
+      return offset;
+    }
+  }
+  // offset 0 is the empty string
+  int needed = (pool.used == 0 ? 1 : pool.used) + len + 1;
+  if(needed > pool.size)
+  {
+    int newSize = ((needed / POOL_BLOCK_SIZE) + 1) * POOL_BLOCK_SIZE;
+    if(newSize > 0xFFFF)
+    {
+      return 0;
+    }
+    char* newText = (char*)realloc(pool.text, newSize);
+    if(newText == NULL)
+    {
+      return 0;
+    }
+    pool.text = newText;
+    pool.size = newSize;
+  }
+  if(pool.used == 0)
+  {
+    pool.text[0] = '\0';
+    pool.used = 1;
+  }
+  int offset = pool.used;
+  memcpy(&pool.text[offset], value, len);
+  pool.text[offset + len] = '\0';
+  pool.used += len + 1;
+  return offset;
+}
+//
+// get a name from a string pool, bad offsets return ""
+//
+const char* Pool_Get(const StringPool& pool, uint16_t offset)
+{
+  if(offset >= pool.used)
+  {
+    return "";
+  }
+  return &pool.text[offset];
+}
+//
+// release all names in a string pool
+//
+void Pool_Reset(StringPool& pool)
+{
+  free(pool.text);
+  pool.text = NULL;
+  pool.used = 0;
+  pool.size = 0;
+}
+//
+// rebuild carNames with only the names cars still use (drops names replaced by web edits)
+//
+void Car_CompactNames()
+{
+  StringPool newNames;
+  for(int carIdx = 0; carIdx < carCount; carIdx++)
+  {
+    cars[carIdx].carName = Pool_Add(newNames, Pool_Get(carNames, cars[carIdx].carName));
+    for(int tireIdx = 0; tireIdx < CAR_MAX_TIRES; tireIdx++)
+    {
+      cars[carIdx].tireShortName[tireIdx] = Pool_Add(newNames, Pool_Get(carNames, cars[carIdx].tireShortName[tireIdx]));
+      cars[carIdx].tireLongName[tireIdx] = Pool_Add(newNames, Pool_Get(carNames, cars[carIdx].tireLongName[tireIdx]));
+    }
+    for(int positionIdx = 0; positionIdx < CAR_MAX_POSITIONS; positionIdx++)
+    {
+      cars[carIdx].positionShortName[positionIdx] = Pool_Add(newNames, Pool_Get(carNames, cars[carIdx].positionShortName[positionIdx]));
+      cars[carIdx].positionLongName[positionIdx] = Pool_Add(newNames, Pool_Get(carNames, cars[carIdx].positionLongName[positionIdx]));
+    }
+  }
+  Pool_Reset(carNames);
+  carNames = newNames;
+}
+//
+// measurement record view of a car with the current tireTemps, names point into carNames
+//
+void Car_GetRecord(const CarSettings& car, uint64_t epochMs, MeasureRecord& record)
+{
+  record.dateTime = "";
+  record.epochMs = epochMs;
+  record.hasReadingTimes = true;
+  record.hasFlags = true;
+  record.legacyTemps = false;
+  record.carName = Pool_Get(carNames, car.carName);
+  // counts are clamped to CAR_MAX_TIRES/CAR_MAX_POSITIONS (same as the record limits) when cars load
+  record.tireCount = car.tireCount;
+  record.positionCount = car.positionCount;
+  for(int idxTemp = 0; idxTemp < record.tireCount * record.positionCount; idxTemp++)
+  {
+    record.temps[idxTemp] = tireTemps[idxTemp];
+    record.readingMs[idxTemp] = tireTimes[idxTemp];
+    record.settleMs[idxTemp] = tireSettleMs[idxTemp];
+    record.flags[idxTemp] = tireFlags[idxTemp];
+  }
+  for(int idxTire = 0; idxTire < record.tireCount; idxTire++)
+  {
+    record.tireNames[idxTire] = Pool_Get(carNames, car.tireShortName[idxTire]);
+    // max temps are set in display units
+    record.maxTemps[idxTire] = Temp_FromDisplay(car.maxTemp[idxTire], deviceSettings.tempUnits);
+  }
+  for(int idxPosition = 0; idxPosition < record.positionCount; idxPosition++)
+  {
+    record.positionNames[idxPosition] = Pool_Get(carNames, car.positionShortName[idxPosition]);
+  }
+}
+//
+// limit a tire or position count from a file or web form to 1..maxCount
+//
+int Car_ClampCount(int count, int maxCount)
+{
+  if((count < 1) || (count > maxCount))
+  {
+    #ifdef DEBUG_VERBOSE
+    Serial.printf("count %d out of range, limited to 1..%d\n", count, maxCount);
+    #endif
+    return count < 1 ? 1 : maxCount;
+  }
+  return count;
+}
+//
+// walk tires in index order, all positions first to last
+//
+void Car_DefaultWalk(CarSettings& car)
+{
+  for(int tireIdx = 0; tireIdx < CAR_MAX_TIRES; tireIdx++)
+  {
+    car.walkOrder[tireIdx] = tireIdx;
+  }
+  car.reverseMask = 0;
+}
+//
+// parse a list of tire numbers (from 1, any separators) to tire indexes
+// returns the count of numbers in the list, only the first maxCount are stored
+//
+int Car_ParseTireList(const char* text, int tires[], int maxCount)
+{
+  int count = 0;
+  while(*text != '\0')
+  {
+    if((*text >= '0') && (*text <= '9'))
+    {
+      char* end;
+      long tireNumber = strtol(text, &end, 10);
+      if(count < maxCount)
+      {
+        tires[count] = (int)tireNumber - 1;
+      }
+      count++;
+      text = end;
+    }
+    else
+    {
+      text++;
+    }
+  }
+  return count;
+}
+//
+// set walk order from a tire number list, must name every tire once
+// anything else (including blank) leaves index order, returns false if the list was rejected
+//
+bool Car_SetWalk(CarSettings& car, const char* text)
+{
+  int tires[CAR_MAX_TIRES];
+  bool isUsed[CAR_MAX_TIRES] = {false};
+  for(int tireIdx = 0; tireIdx < CAR_MAX_TIRES; tireIdx++)
+  {
+    car.walkOrder[tireIdx] = tireIdx;
+  }
+  int count = Car_ParseTireList(text, tires, CAR_MAX_TIRES);
+  if(count == 0)
+  {
+    return true;
+  }
+  if(count != car.tireCount)
+  {
+    return false;
+  }
+  for(int step = 0; step < count; step++)
+  {
+    if((tires[step] < 0) || (tires[step] >= car.tireCount) || isUsed[tires[step]])
+    {
+      return false;
+    }
+    isUsed[tires[step]] = true;
+  }
+  for(int step = 0; step < count; step++)
+  {
+    car.walkOrder[step] = tires[step];
+  }
+  return true;
+}
+//
+// set tires measured last position to first (inside to outside) from a tire number list
+//
+void Car_SetReverse(CarSettings& car, const char* text)
+{
+  int tires[CAR_MAX_TIRES];
+  int count = Car_ParseTireList(text, tires, CAR_MAX_TIRES);
+  count = count < CAR_MAX_TIRES ? count : CAR_MAX_TIRES;
+  car.reverseMask = 0;
+  for(int idx = 0; idx < count; idx++)
+  {
+    if((tires[idx] >= 0) && (tires[idx] < car.tireCount))
+    {
+      car.reverseMask |= 1 << tires[idx];
+    }
+  }
+}
+//
+// walk order as a tire number list, empty for index order
+//
+char* Car_FormatWalk(const CarSettings& car, char* buf, int bufSize)
+{
+  bool isDefault = true;
+  int len = 0;
+  buf[0] = '\0';
+  for(int step = 0; step < car.tireCount; step++)
+  {
+    isDefault = isDefault && (car.walkOrder[step] == step);
+    len += snprintf(&buf[len], bufSize - len, step == 0 ? "%d" : ",%d", car.walkOrder[step] + 1);
+    if(len >= bufSize)
+    {
+      break;
+    }
+  }
+  if(isDefault)
+  {
+    buf[0] = '\0';
+  }
+  return buf;
+}
+//
+// reversed tires as a tire number list, empty if none
+//
+char* Car_FormatReverse(const CarSettings& car, char* buf, int bufSize)
+{
+  int len = 0;
+  buf[0] = '\0';
+  for(int tireIdx = 0; (tireIdx < car.tireCount) && (len < bufSize); tireIdx++)
+  {
+    if(car.reverseMask & (1 << tireIdx))
+    {
+      len += snprintf(&buf[len], bufSize - len, len == 0 ? "%d" : ",%d", tireIdx + 1);
+    }
+  }
+  return buf;
+}
+//
+// walk step of a tire
+//
+int Car_WalkStep(const CarSettings& car, int tireIdx)
+{
+  for(int step = 0; step < car.tireCount; step++)
+  {
+    if(car.walkOrder[step] == tireIdx)
+    {
+      return step;
+    }
+  }
+  return 0;
+}
+//
+// position index measured at a step on a tire
+//
+int Car_PositionAt(const CarSettings& car, int tireIdx, int step)
+{
+  if(car.reverseMask & (1 << tireIdx))
+  {
+    return car.positionCount - 1 - step;
+  }
+  return step;
+}
+//
+// size the tire temp matrix for the largest car (tires x positions)
+// only grows, readings already taken are kept - a 4x3 car list needs 12 entries
+//
+bool Measure_Resize()
+{
+  int tempCount = 1;
+  for(int carIdx = 0; carIdx < carCount; carIdx++)
+  {
+    int carTemps = cars[carIdx].tireCount * cars[carIdx].positionCount;
+    tempCount = tempCount > carTemps ? tempCount : carTemps;
+  }
+  if(tempCount <= measureCapacity)
+  {
+    return true;
+  }
+  if (void* mem = realloc(tireTemps, sizeof(TempCenti) * tempCount))
+  {
+    tireTemps = static_cast<TempCenti*>(mem);
+  }
+  else
+  {
+    return false;
+  }
+  if (void* mem = realloc(tireTimes, sizeof(uint64_t) * tempCount))
+  {
+    tireTimes = static_cast<uint64_t*>(mem);
+  }
+  else
+  {
+    return false;
+  }
+  if (void* mem = realloc(tireSettleMs, sizeof(uint32_t) * tempCount))
+  {
+    tireSettleMs = static_cast<uint32_t*>(mem);
+  }
+  else
+  {
+    return false;
+  }
+  if (void* mem = realloc(tireFlags, sizeof(uint8_t) * tempCount))
+  {
+    tireFlags = static_cast<uint8_t*>(mem);
+  }
+  else
+  {
+    return false;
+  }
+  for(int tempIdx = measureCapacity; tempIdx < tempCount; tempIdx++)
+  {
+    tireTemps[tempIdx] = 0;
+    tireTimes[tempIdx] = 0;
+    tireSettleMs[tempIdx] = 0;
+    tireFlags[tempIdx] = 0;
+  }
+  measureCapacity = tempCount;
+  return true;
+}
+//
+// clear all readings in the tire temp matrix
+//
+void Measure_Clear()
+{
+  for(int tempIdx = 0; tempIdx < measureCapacity; tempIdx++)
+  {
+    tireTemps[tempIdx] = 0;
+    tireTimes[tempIdx] = 0;
+    tireSettleMs[tempIdx] = 0;
+    tireFlags[tempIdx] = 0;
+  }
+}
+
+//
+// read car settings file
+//
+void ReadCarSetupFile(fs::FS &fs, const char * path)
+{
+  char* line;
+  File file = fs.open(path, FILE_READ);
+  if(!file)
+  {
+    return;
+  }
+  LineReader* reader = (LineReader*)calloc(1, sizeof(LineReader));
+  if(reader == NULL)
+  {
+    file.close();
+    return;
+  }
+  Line_Begin(*reader, file);
+  line = Line_Read(*reader);
+  carCount = atoi(line);
+  cars = (CarSettings*)calloc(carCount, sizeof(CarSettings));
+  Pool_Reset(carNames);
+  for(int carIdx = 0; carIdx < carCount; carIdx++)
+  {
+    // read ID
+    line = Line_Read(*reader);
+    cars[carIdx].carID = atoi(line);
+    maxCarID = maxCarID > cars[carIdx].carID ? maxCarID : cars[carIdx].carID;
+    // read name
+    line = Line_Read(*reader);
+    cars[carIdx].carName = Pool_Add(carNames, line);
+    // read tire count, entries past CAR_MAX_TIRES are read and dropped
+    line = Line_Read(*reader);
+    int fileCount = atoi(line);
+    cars[carIdx].tireCount = Car_ClampCount(fileCount, CAR_MAX_TIRES);
+    Car_DefaultWalk(cars[carIdx]);
+    // read tire short and long names
+    for(int tireIdx = 0; tireIdx < fileCount; tireIdx++)
+    {
+      char* shortName = Line_Read(*reader);
+      if(tireIdx < cars[carIdx].tireCount)
+      {
+        cars[carIdx].tireShortName[tireIdx] = Pool_Add(carNames, shortName);
+      }
+      char* longName = Line_Read(*reader);
+      if(tireIdx < cars[carIdx].tireCount)
+      {
+        cars[carIdx].tireLongName[tireIdx] = Pool_Add(carNames, longName);
+      }
+      line = Line_Read(*reader);
+      if(tireIdx < cars[carIdx].tireCount)
+      {
+        cars[carIdx].maxTemp[tireIdx] = atof(line);
+      }
+    }
+    // read measurement count, entries past CAR_MAX_POSITIONS are read and dropped
+    line = Line_Read(*reader);
+    fileCount = atoi(line);
+    cars[carIdx].positionCount = Car_ClampCount(fileCount, CAR_MAX_POSITIONS);
+    // read position short and long names
+    for(int positionIdx = 0; positionIdx < fileCount; positionIdx++)
+    {
+      char* shortName = Line_Read(*reader);
+      if(positionIdx < cars[carIdx].positionCount)
+      {
+        cars[carIdx].positionShortName[positionIdx] = Pool_Add(carNames, shortName);
+      }
+      char* longName = Line_Read(*reader);
+      if(positionIdx < cars[carIdx].positionCount)
+      {
+        cars[carIdx].positionLongName[positionIdx] = Pool_Add(carNames, longName);
+      }
+    }
+    // optional walk order and reversed tires, then seperator
+    while(true)
+    {
+      line = Line_Read(*reader);
+      if(strncmp(line, "walk=", 5) == 0)
+      {
+        Car_SetWalk(cars[carIdx], &line[5]);
+      }
+      else if(strncmp(line, "reverse=", 8) == 0)
+      {
+        Car_SetReverse(cars[carIdx], &line[8]);
+      }
+      else
+      {
+        break;
+      }
+    }
+  }
+  free(reader);
+  selectedCar = 0;
+  file.close();
+  Measure_Resize();
+}
+//
+// write car settings file
+//
+void WriteCarSetupFile(fs::FS &fs, const char * path)
+{
+  char buf[512];
+  File file = fs.open(path, FILE_WRITE);
+  if(!file)
+  {
+    return;
+  }
+  sprintf(buf, "%d", carCount);
+  file.println(buf);            // number of cars
+  for(int carIdx = 0; carIdx < carCount; carIdx++)
+  {
+    maxCarID = maxCarID > cars[carIdx].carID ? maxCarID : cars[carIdx].carID;
+    file.println(cars[carIdx].carID);    // carID
+    file.println(Pool_Get(carNames, cars[carIdx].carName));    // car
+    sprintf(buf, "%d", cars[carIdx].tireCount);
+    file.println(buf);
+    for(int wheelIdx = 0; wheelIdx < cars[carIdx].tireCount; wheelIdx++)
+    {
+      sprintf(buf, "%s", Pool_Get(carNames, cars[carIdx].tireShortName[wheelIdx]));
+      file.println(buf);
+      sprintf(buf, "%s", Pool_Get(carNames, cars[carIdx].tireLongName[wheelIdx]));
+      file.println(buf);
+      sprintf(buf, "%0.2lf", cars[carIdx].maxTemp[wheelIdx]);
+      file.println(buf);
+    }
+    sprintf(buf, "%d", cars[carIdx].positionCount);
+    file.println(buf);
+    for(int posIdx = 0; posIdx < cars[carIdx].positionCount; posIdx++)
+    {
+      sprintf(buf, "%s", Pool_Get(carNames, cars[carIdx].positionShortName[posIdx]));
+      file.println(buf);
+      sprintf(buf, "%s", Pool_Get(carNames, cars[carIdx].positionLongName[posIdx]));
+      file.println(buf);
+    }
+    // only when not the default (index order, outside first)
+    char listStr[CAR_LIST_SIZE];
+    if(strlen(Car_FormatWalk(cars[carIdx], listStr, sizeof(listStr))) > 0)
+    {
+      sprintf(buf, "walk=%s", listStr);
+      file.println(buf);
+    }
+    if(strlen(Car_FormatReverse(cars[carIdx], listStr, sizeof(listStr))) > 0)
+    {
+      sprintf(buf, "reverse=%s", listStr);
+      file.println(buf);
+    }
+    file.println("=========="); 
+  }
+  file.close();
+  
+  #ifdef DEBUG_VERBOSE
+  Serial.println("Done writing, readback");
+  file = fs.open(path, FILE_READ);
+  Serial.println(path);
+  LineReader* readback = (LineReader*)calloc(1, sizeof(LineReader));
+  if(readback != NULL)
+  {
+    Line_Begin(*readback, file);
+    while(true)
+    {
+      char* line = Line_Read(*readback);
+      if(strlen(line)==0)
+      {
+        break;
+      }
+      Serial.println(line);
+    }
+    free(readback);
+  }
+  Serial.println("Done");
+  file.close();
+  #endif
+}
+//
+// write car settings to HTML for web interface
+//
+void WriteCarSetupHTML(fs::FS &fs, const char * path, int carIdx)
+{
+  uint32_t probeStart = Probe_Start();
+  DeleteFile(fs, path);
+  char buf[512];
+  char listStr[CAR_LIST_SIZE];
+  File file = fs.open(path, FILE_WRITE);
+  if(!file)
+  {
+    return;
+  }
+  file.println("<html>");
+  file.println("<head>");
+  file.println("<meta charset=\"UTF-8\">");
+  file.println("<meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">");
+  file.println("<meta http-equiv=\"Cache-Control\" content=\"no-cache, no-store, must-revalidate\" />");
+  file.println("<meta http-equiv=\"Pragma\" content=\"no-cache\" /><meta http-equiv=\"Expires\" content=\"0\"/>");
+  file.println("<title>Yamura Tire Pyrometer</title>");
+  file.println("<link rel=\"icon\" href=\"data:,\">");
+  file.println("<link rel=\"stylesheet\" type=\"text/css\" href=\"style.css\">");
+  file.println("</head>");
+  file.println("<body>");
+  file.println("<div class=\"content\">");
+  file.println("<div class=\"card-grid\">");
+  file.println("<div class=\"card\">");
+  file.println("<form action=\"/\" method=\"POST\">");
+  file.println("<p>");
+  
+  file.println("<div>");
+  file.println("<h3>Car and Driver Info</h3>");
+  file.println("</div>");
+
+  file.println("<div class=\"dInput\" v-if=\"activeStage == 3\">");
+  file.println("<div><label for=\"car_id\">Car/Driver</label>");
+  sprintf(buf, "<input type=\"text\" id =\"car_id\" name=\"car_id\" value = \"%s\"></div>", Pool_Get(carNames, cars[carIdx].carName));
+  file.println(buf);
+  file.println("</div>");
+
+  sprintf(buf, "<div><label for=\"tirecount_id\">Tires (%d)</label>", cars[carIdx].tireCount);
+  file.println(buf);
+  file.println("<div><select id =\"tirecount_id\" name=\"tirecount_id\"><br>");
+  sprintf(buf, "<option>%d</option>", cars[carIdx].tireCount);
+  file.println(buf);
+  for(int count = 1; count <= CAR_MAX_TIRES; count++)
+  {
+    sprintf(buf, "<option>%d</option>", count);
+    file.println(buf);
+  }
+  file.println("</select>");
+
+  sprintf(buf, "<div><label for=\"measurecount_id\">Measurements (%d)</label>", cars[carIdx].positionCount);
+  file.println(buf);
+  file.println("<div><select id =\"measurecount_id\" name=\"measurecount_id\"><br>");
+  sprintf(buf, "<option>%d</option>", cars[carIdx].positionCount);
+  file.println(buf);
+  for(int count = 1; count <= CAR_MAX_POSITIONS; count++)
+  {
+    sprintf(buf, "<option>%d</option>", count);
+    file.println(buf);
+  }
+  file.println("</select>");
+
+  // tire numbers from 1, blank is tire order / outside first
+  file.println("<div><label for=\"walk_id\">Walk order</label>");
+  sprintf(buf, "<input type=\"text\" id =\"walk_id\" name=\"walk_id\" value = \"%s\"></div>", Car_FormatWalk(cars[carIdx], listStr, sizeof(listStr)));
+  file.println(buf);
+  file.println("<div><label for=\"reverse_id\">Inside first</label>");
+  sprintf(buf, "<input type=\"text\" id =\"reverse_id\" name=\"reverse_id\" value = \"%s\"></div>", Car_FormatReverse(cars[carIdx], listStr, sizeof(listStr)));
+  file.println(buf);
+  
+  file.println("</div>");
+  file.println("</p>");
+  file.println("<p>");
+  file.println("<div>");
+  file.println("<h3>Tire Info</h3>");
+  file.println("</div>");
+  for(int tireIdx = 0; tireIdx < CAR_MAX_TIRES; tireIdx++)
+  {
+    sprintf(buf, "<div class=\"dInput\" v-if=\"activeStage == 3\">");
+    file.println(buf);
+    if(tireIdx == 0)
+    {
+      sprintf(buf, "<div><label for=\"tire%d_full_id\">Full</label>", tireIdx);
+    }
+    else
+    {
+      sprintf(buf, "<div>");
+    }
+    file.println(buf);
+    if(tireIdx < cars[carIdx].tireCount)
+    {
+      sprintf(buf, "<input type=\"text\" id =\"tire%d_full_id\" name=\"tire%d_full_id\" value = \"%s\"></div>", tireIdx, tireIdx, Pool_Get(carNames, cars[carIdx].tireLongName[tireIdx]));
+    }
+    else
+    {
+      sprintf(buf, "<input type=\"text\" id =\"tire%d_full_id\" name=\"tire%d_full_id\" value = \"%s\"></div>", tireIdx, tireIdx, "-");
+    }
+    file.println(buf);
+    if(tireIdx == 0)
+    {
+      sprintf(buf, "<div><label for=\"tire%d_short_id\">Short</label>", tireIdx);
+    }
+    else
+    {
+      sprintf(buf, "<div><label for=\"tire%d_short_id\"></label>", tireIdx);
+    }
+
+    file.println(buf);
+    if(tireIdx < cars[carIdx].tireCount)
+    {
+      sprintf(buf, "<input type=\"text\" id =\"tire%d_short_id\" name=\"tire%d_short_id\" value = \"%s\"></div>",  tireIdx, tireIdx, Pool_Get(carNames, cars[carIdx].tireShortName[tireIdx]));
+    }
+    else
+    {
+      sprintf(buf, "<input type=\"text\" id =\"tire%d_short_id\" name=\"tire%d_short_id\" value = \"%s\"></div>",  tireIdx, tireIdx, "-");
+    }
+    file.println(buf);
+    if(tireIdx == 0)
+    {
+      sprintf(buf, "<div><label for=\"tire%d_maxt_id\">Max T</label>", tireIdx);
+    }
+    else
+    {
+      sprintf(buf, "<div><label for=\"tire%d_maxt_id\"></label>", tireIdx);
+    }
+    file.println(buf);
+    if(tireIdx < cars[carIdx].tireCount)
+    {
+      sprintf(buf, "<input type=\"text\" id =\"tire%d_maxt_id\" name=\"tire%d_maxt_id\" value = \"%0.1lf\"></div>", tireIdx, tireIdx, cars[carIdx].maxTemp[tireIdx]);
+    }
+    else
+    {
+      sprintf(buf, "<input type=\"text\" id =\"tire%d_maxt_id\" name=\"tire%d_maxt_id\" value = \"%s\"></div>", tireIdx, tireIdx, "-");
+    }
+    file.println(buf);
+    sprintf(buf, "</div>");
+    file.println(buf);
+  }
+  file.println("</p>");
+  file.println("<p>");
+  file.println("<div>");
+  file.println("<h3>Measure Points</h3>");
+  file.println("</div>");
+  for(int measIdx = 0; measIdx < CAR_MAX_POSITIONS; measIdx++)
+  {
+    file.println("<div class=\"dInput\" v-if=\"activeStage == 3\">");
+    if(measIdx == 0)
+    {
+      sprintf(buf, "<div><label for=\"position%d_full_id\">Full</label>", measIdx);
+    }
+    else
+    {
+      sprintf(buf, "<div>");
+    }
+    file.println(buf);
+    if(measIdx < cars[carIdx].positionCount)
+    {
+      sprintf(buf, "<input type=\"text\" id =\"position%d_full_id\" name=\"position%d_full_id\" value = \"%s\"></div>", measIdx, measIdx, Pool_Get(carNames, cars[carIdx].positionLongName[measIdx]));
+    }
+    else
+    {
+      sprintf(buf, "<input type=\"text\" id =\"position%d_full_id\" name=\"position%d_full_id\" value = \"%s\"></div>", measIdx, measIdx, "-");
+    }
+    file.println(buf);
+    if(measIdx == 0)
+    {
+      sprintf(buf, "<div><label for=\"position%d_short_id\">Short</label>", measIdx);
+    }
+    else
+    {
+      sprintf(buf, "<div>");
+    }
+
+    file.println(buf);
+    if(measIdx < cars[carIdx].positionCount)
+    {
+      sprintf(buf, "<input type=\"text\" id =\"position%d_short_id\" name=\"position%d_short_id\" value = \"%s\"></div>", measIdx, measIdx, Pool_Get(carNames, cars[carIdx].positionShortName[measIdx]));
+    }
+    else
+    {
+      sprintf(buf, "<input type=\"text\" id =\"position%d_short_id\" name=\"position%d_short_id\" value = \"%s\"></div>", measIdx, measIdx, "-");
+    }
+    file.println(buf);
+    file.println("</div>");
+  }
+  file.println("</table>");
+  file.println("<p>");
+  file.println("<div>");
+  file.println("<h3>Actions</h3>");
+  file.println("</div>");
+  file.println("<button name=\"update\" type =\"submit\" value =\"update\">Update</button>");
+  file.println("<button name=\"prior\"  type =\"submit\" value =\"prior\">Prior</button>");
+  file.println("<button name=\"next\"   type =\"submit\" value =\"next\">Next</button>");
+  file.println("<button name=\"delete\" type =\"submit\" value =\"delete\">Delete</button>");
+  file.println("<button name=\"new\"    type =\"submit\" value =\"new\">New</button>");
+  file.println("<button name=\"home\" type=\"submit\" value=\"home\"><a href=\"/py_main.html\">Home</a></button>");
+  file.println("</p>");
+  file.println("</form>");
+  file.println("</div>");
+  file.println("</div>");
+  file.println("</div>");
+  file.println("</body>");
+  file.println("</html>");
+  file.close();
+  Probe_Stop(PROBE_HTML_CARS, probeStart);
+  delay(100);
+  #ifdef DEBUG_VERBOSE
+  file = fs.open(path, FILE_READ);
+  Serial.println(path);
+  LineReader* readback = (LineReader*)calloc(1, sizeof(LineReader));
+  if(readback != NULL)
+  {
+    Line_Begin(*readback, file);
+    while(true)
+    {
+      char* line = Line_Read(*readback);
+      if(strlen(line)==0)
+      {
+        break;
+      }
+      Serial.println(line);
+    }
+    free(readback);
+  }
+  Serial.println("Done");
+  file.close();
+  #endif
+}
+//
+// read device settings file
+//
+void ReadDeviceSetupFile(fs::FS &fs, const char * path)
+{
+  char* line;
+  File file = fs.open(path, FILE_READ);
+  if(!file)
+  {
+    return;
+  }
+  LineReader* reader = (LineReader*)calloc(1, sizeof(LineReader));
+  if(reader == NULL)
+  {
+    file.close();
+    return;
+  }
+  Line_Begin(*reader, file);
+  line = Line_Read(*reader);
+  strlcpy(deviceSettings.ssid, line, sizeof(deviceSettings.ssid));
+  line = Line_Read(*reader);
+  strlcpy(deviceSettings.pass, line, sizeof(deviceSettings.pass));
+  line = Line_Read(*reader);
+  deviceSettings.screenRotation = atoi(line);
+  line = Line_Read(*reader);
+  deviceSettings.stableBand[0] = atof(line) / -2.0;
+  deviceSettings.stableBand[1] = atof(line) / 2.0;
+  line = Line_Read(*reader);
+  deviceSettings.stableDelay = atoi(line);
+  line = Line_Read(*reader);
+  deviceSettings.stableBuffer = atoi(line);
+  int temp = 0;
+  line = Line_Read(*reader);
+  temp = atoi(line);
+  deviceSettings.tempUnits = temp == 0 ? false : true;
+  line = Line_Read(*reader);
+  temp = atoi(line);
+  deviceSettings.is12Hour = temp == 0 ? false : true;
+  line = Line_Read(*reader);
+  deviceSettings.fontPoints = atoi(line);
+  // stable method lines are missing in older files, keep defaults
+  line = Line_Read(*reader);
+  if(strlen(line) > 0)
+  {
+    temp = atoi(line);
+    deviceSettings.stableMethod = (temp >= 0) && (temp < STABLE_METHOD_COUNT) ? temp : STABLE_BAND;
+  }
+  line = Line_Read(*reader);
+  if(strlen(line) > 0)
+  {
+    deviceSettings.stableSlope = atof(line);
+  }
+  line = Line_Read(*reader);
+  if(strlen(line) > 0)
+  {
+    deviceSettings.kalmanNoise = atof(line);
+  }
+  line = Line_Read(*reader);
+  if(strlen(line) > 0)
+  {
+    deviceSettings.kalmanRate = atof(line);
+  }
+  line = Line_Read(*reader);
+  if(strlen(line) > 0)
+  {
+    deviceSettings.traceSamples = atoi(line) != 0;
+  }
+  line = Line_Read(*reader);
+  if(strlen(line) > 0)
+  {
+    temp = atoi(line);
+    deviceSettings.probeID = (temp >= 1) && (temp <= CAL_ID_MAX) ? temp : 1;
+  }
+  // missing in files written before fixed point records, the units set then are the ones they used
+  line = Line_Read(*reader);
+  deviceSettings.legacyUnits = strlen(line) > 0 ? atoi(line) != 0 : deviceSettings.tempUnits;
+  deviceSettings.stableBuffer = deviceSettings.stableBuffer > STABLE_WINDOW_MAX ? STABLE_WINDOW_MAX : deviceSettings.stableBuffer;
+  free(reader);
+  file.close();
+}
+//
+// write device settings file
+//
+void WriteDeviceSetupFile(fs::FS &fs, const char * path)
+{
+  char buf[512];
+  DeleteFile(fs, path);
+  File file = fs.open(path, FILE_WRITE);
+  if(!file)
+  {
+    return;
+  }
+  file.println(deviceSettings.ssid);
+  file.println(deviceSettings.pass);
+  file.println(deviceSettings.screenRotation);
+  file.println(deviceSettings.stableBand[1] * 2.0);
+  file.println(deviceSettings.stableDelay);
+  file.println(deviceSettings.stableBuffer);
+  file.println(deviceSettings.tempUnits ? 1 : 0);
+  file.println(deviceSettings.is12Hour ? 1 : 0);
+  file.println(deviceSettings.fontPoints);
+  file.println(deviceSettings.stableMethod);
+  file.println(deviceSettings.stableSlope);
+  file.println(deviceSettings.kalmanNoise);
+  file.println(deviceSettings.kalmanRate);
+  file.println(deviceSettings.traceSamples ? 1 : 0);
+  file.println(deviceSettings.probeID);
+  file.println(deviceSettings.legacyUnits ? 1 : 0);
+  file.close();
+  #ifdef DEBUG_VERBOSE
+  Serial.println("Done writing, readback");
+  file = fs.open(path, FILE_READ);
+  Serial.println(path);
+  LineReader* readback = (LineReader*)calloc(1, sizeof(LineReader));
+  if(readback != NULL)
+  {
+    Line_Begin(*readback, file);
+    while(true)
+    {
+      char* line = Line_Read(*readback);
+      if(strlen(line)==0)
+      {
+        break;
+      }
+      Serial.println(line);
+    }
+    free(readback);
+  }
+  Serial.println("Done");
+  file.close();
+  #endif
+}
+//
+// read probe calibration curves, a "probe=<id>" line then a "<raw C>,<reference C>" line per point
+//
+void ReadCalibrationFile(fs::FS &fs, const char * path)
+{
+  char* line;
+  int probeIdx = -1;
+  calProbeCount = 0;
+  File file = fs.open(path, FILE_READ);
+  if(!file)
+  {
+    return;
+  }
+  LineReader* reader = (LineReader*)calloc(1, sizeof(LineReader));
+  if(reader == NULL)
+  {
+    file.close();
+    return;
+  }
+  Line_Begin(*reader, file);
+  while(true)
+  {
+    line = Line_Read(*reader);
+    if(strlen(line) == 0)
+    {
+      break;
+    }
+    if(strncmp(line, "probe=", 6) == 0)
+    {
+      // points for probes past CAL_MAX_PROBES are read and dropped
+      probeIdx = Cal_FindProbe(atoi(&line[6]), true);
+      continue;
+    }
+    char* comma = strchr(line, ',');
+    if((probeIdx < 0) || (comma == NULL) || (calProbes[probeIdx].pointCount >= CAL_MAX_POINTS))
+    {
+      continue;
+    }
+    CalProbe& probe = calProbes[probeIdx];
+    probe.points[probe.pointCount].rawC = atof(line);
+    probe.points[probe.pointCount].refC = atof(comma + 1);
+    probe.pointCount++;
+  }
+  free(reader);
+  file.close();
+}
+//
+// write probe calibration curves, probes without points are left out
+//
+void WriteCalibrationFile(fs::FS &fs, const char * path)
+{
+  char buf[64];
+  DeleteFile(fs, path);
+  File file = fs.open(path, FILE_WRITE);
+  if(!file)
+  {
+    return;
+  }
+  for(int probeIdx = 0; probeIdx < calProbeCount; probeIdx++)
+  {
+    const CalProbe& probe = calProbes[probeIdx];
+    if(probe.pointCount == 0)
+    {
+      continue;
+    }
+    sprintf(buf, "probe=%d", probe.probeID);
+    file.println(buf);
+    for(int pointIdx = 0; pointIdx < probe.pointCount; pointIdx++)
+    {
+      sprintf(buf, "%0.2f,%0.2f", probe.points[pointIdx].rawC, probe.points[pointIdx].refC);
+      file.println(buf);
+    }
+  }
+  file.close();
+}
+//
+// write device settings to HTML for web interface
+//
+void WriteDeviceSetupHTML(fs::FS &fs, const char * path)
+{
+  uint32_t probeStart = Probe_Start();
+  Serial.println("Write device setup file");
+  int selectedIndex = 0;
+  char buf[512];
+  DeleteFile(fs, path);
+  File file = fs.open(path, FILE_WRITE);
+  if(!file)
+  {
+    return;
+  }
+  file.println("<!DOCTYPE html>");
+  file.println("<html>");
+  file.println("<head>");
+  file.println("<meta charset=\"UTF-8\">");
+  file.println("<meta name=\"viewport\" content=\"width=device-width, initial-scale=1\">");
+  file.println("<meta http-equiv=\"Cache-Control\" content=\"no-cache, no-store, must-revalidate\" />");
+  file.println("<meta http-equiv=\"Pragma\" content=\"no-cache\" /><meta http-equiv=\"Expires\" content=\"0\"/>");
+  file.println("<title>Yamura Pyrometer Setup</title>");
+  file.println("<link rel=\"icon\" href=\"data:,\">");
+  file.println("<link rel=\"stylesheet\" type=\"text/css\" href=\"style.css\">");
+  file.println("</head>");
+
+  file.println("<body>");
+  file.println("<div class=\"content\">");
+  file.println("<div class=\"card-grid\">");
+  file.println("<div class=\"card\">");
+  file.println("<form action=\"/\" method=\"POST\">");
+
+  file.println("<p>");
+  file.println("<div>");
+  file.println("<h3>Pyrometer Settings</h3>");
+  file.println("</div>");
+  file.println("</p>");
+
+  file.println("<p>");
+  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
+  file.println("<label for=\"ssid_id\">SSID</label>");
+  sprintf(buf, "<div><input type=\"text\" id =\"ssid_id\" name=\"ssid_id\" value = \"%s\"><br>", deviceSettings.ssid);
+  file.println(buf);
+  file.println("</div>");
+  file.println("</p>");
+  
+  file.println("<p>");
+  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
+  file.println("<label for=\"pass_id\">Password</label>");
+  sprintf(buf, "<div><input type=\"text\" id =\"pass_id\" name=\"pass_id\" value = \"%s\"><br>", deviceSettings.pass);
+  file.println(buf);
+  file.println("</div>");
+  file.println("</p>");
+  
+  file.println("<p>");
+  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
+  selectedIndex = deviceSettings.tempUnits == true ? 0 : 1;
+  sprintf(buf, "<label for=\"units_id\">Temperature Units (%s)</label>", (deviceSettings.tempUnits == true ? "C" : "F"));
+  file.println(buf);
+  file.println("<div><select id =\"units_id\" name=\"units_id\"><br>");
+  sprintf(buf, "<option>%s</option>", (deviceSettings.tempUnits == true ? "C" : "F"));
+  file.println(buf);
+  file.println("<option>F</option>");  
+  file.println("<option>C</option>");
+  file.println("</select>");
+  file.println("</div>");
+  file.println("</p>");
+
+  file.println("<p>");
+  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
+  sprintf(buf, "<label for=\"orientation_id\">Screen Orientation (%s)</label>", (deviceSettings.screenRotation == 1 ? "R" : "L"));
+  file.println(buf);
+
+  file.println("<div><select id =\"orientation_id\" name=\"orientation_id\"><br>");
+  sprintf(buf, "<option>%s</option>", (deviceSettings.screenRotation == 1 ? "R" : "L"));
+  file.println(buf);
+  file.println("<option>R</option>");  
+  file.println("<option>L</option>");
+  file.println("</select>");
+  file.println("</div>");
+  file.println("</p>");
+
+  file.println("<p>");
+  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
+  file.println(" <label for=\"bandwidth_id\">Temperature Stable Bandwidth</label>");
+  sprintf(buf, "<div><input type=\"text\" id =\"bandwidth_id\" name=\"bandwidth_id\" value = \"%f\"><br>", (deviceSettings.stableBand[1] * 2.0));
+  file.println(buf);
+  file.println("</div>");
+  file.println("</p>");
+
+  file.println("<p>");
+  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
+  file.println(" <label for=\"stablebuffer_id\">Temperature buffer</label>");
+  sprintf(buf, "<div><input type=\"text\" id =\"stablebuffer_id\" name=\"stablebuffer_id\" value = \"%d\"><br>", deviceSettings.stableBuffer);
+  file.println(buf);
+  file.println("</div>");
+  file.println("</p>");
+
+  file.println("<p>");
+  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
+  file.println(" <label for=\"stabledelay_id\">Temperature Stable Delay (ms)</label>");
+  sprintf(buf, "<div><input type=\"text\" id =\"stabledelay_id\" name=\"stabledelay_id\" value = \"%ld\"><br>", deviceSettings.stableDelay);
+  file.println(buf);
+  file.println("</div>");
+  file.println("</p>");
+
+  file.println("<p>");
+  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
+  sprintf(buf, "<label for=\"stablemethod_id\">Temperature Stable Method (%s)</label>", stableMethodNames[deviceSettings.stableMethod]);
+  file.println(buf);
+  file.println("<div><select id =\"stablemethod_id\" name=\"stablemethod_id\"><br>");
+  sprintf(buf, "<option>%s</option>", stableMethodNames[deviceSettings.stableMethod]);
+  file.println(buf);
+  for(int method = 0; method < STABLE_METHOD_COUNT; method++)
+  {
+    sprintf(buf, "<option>%s</option>", stableMethodNames[method]);
+    file.println(buf);
+  }
+  file.println("</select>");
+  file.println("</div>");
+  file.println("</p>");
+
+  file.println("<p>");
+  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
+  file.println(" <label for=\"stableslope_id\">Temperature Stable Slope (deg/sec)</label>");
+  sprintf(buf, "<div><input type=\"text\" id =\"stableslope_id\" name=\"stableslope_id\" value = \"%0.2f\"><br>", deviceSettings.stableSlope);
+  file.println(buf);
+  file.println("</div>");
+  file.println("</p>");
+
+  file.println("<p>");
+  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
+  sprintf(buf, "<label for=\"trace_id\">Sample Trace (%s)</label>", deviceSettings.traceSamples ? "On" : "Off");
+  file.println(buf);
+  file.println("<div><select id =\"trace_id\" name=\"trace_id\"><br>");
+  sprintf(buf, "<option>%s</option>", deviceSettings.traceSamples ? "On" : "Off");
+  file.println(buf);
+  file.println("<option>Off</option>");
+  file.println("<option>On</option>");
+  file.println("</select>");
+  file.println("</div>");
+  file.println("</p>");
+
+  file.println("<p>");
+  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
+  sprintf(buf, "<label for=\"clock_id\">Clock (%d)</label>", (deviceSettings.is12Hour == true ? 12 : 24));
+  file.println(buf);
+  file.println("<div><select id =\"clock_id\" name=\"clock_id\"><br>");
+  sprintf(buf, "<option>%d</option>", (deviceSettings.is12Hour == true ? 12 : 24));
+  file.println(buf);
+  file.println("<option>12</option>");  
+  file.println("<option>24</option>");
+  file.println("</select>");
+  file.println("</div>");
+  file.println("</p>");
+
+  file.println("<p>");
+  file.println("<div class=\"dinput\" v-if=\"activeStage == 3\">");
+  sprintf(buf, "<label for=\"fontsize_id\">Font Size (%d)</label>", deviceSettings.fontPoints);
+  file.println(buf);
+  file.println("<div><select id =\"fontsize_id\" name=\"fontsize_id\"><br>");
+  sprintf(buf, "<option>%d</option>", deviceSettings.fontPoints);
+  file.println(buf);
+  file.println("<option>9</option>");
+  file.println("<option>12</option>");  
+  file.println("<option>18</option>");
+  file.println("<option>24</option>");
+  file.println("</select>");
+
+  file.println("</div>");
+  file.println("</p>");
+  
+  file.println("<p>");
+  file.println("<div>");
+  file.println("<h3>Actions</h3>");
+  file.println("</div>");  
+  file.println("<button name=\"update\" type =\"submit\" value =\"update\">Update</button>");
+  file.println("<button><a href=\"py_main.html\">Home</a></button>");
+  file.println("</p>");
+  file.println("</form>");
+  file.println("</div>");
+  file.println("</div>");
+  file.println("</div>");
+  file.println("</div>");
+  file.println("</body>");
+  file.println("</html>");
+  file.close();
+  Probe_Stop(PROBE_HTML_DEVICE, probeStart);
+
+  #ifdef DEBUG_VERBOSE
+  Serial.println("Done writing, readback");
+  file = fs.open(path, FILE_READ);
+  Serial.println(path);
+  LineReader* readback = (LineReader*)calloc(1, sizeof(LineReader));
+  if(readback != NULL)
+  {
+    Line_Begin(*readback, file);
+    while(true)
+    {
+      char* line = Line_Read(*readback);
+      if(strlen(line)==0)
+      {
+        break;
+      }
+      Serial.println(line);
+    }
+    free(readback);
+  }
+  Serial.println("Done");
+  file.close();
+  #endif
+}
+//
+// write all results to HTML file for web interface, all steps at once
+//
+void WriteResultsHTML(fs::FS &fs)
+{
+  if(!Results_HTMLBegin(fs))
+  {
+    return;
+  }
+  while(!Results_HTMLStep())
+  {
+  }
+}
+//
+// start the results page, header written to RESULTS_HTML_TEMP, any page part written is dropped
+// returns false if the page file can't be opened
+//
+bool Results_HTMLBegin(fs::FS &fs)
+{
+  ResultsHTMLWriter& writer = resultsHTML;
+  Results_HTMLCancel();
+  #ifdef DEBUG_VERBOSE
+  Serial.println("py_res.html header");
+  #endif
+  DeleteFile(fs, RESULTS_HTML_TEMP);
+  writer.fileOut = fs.open(RESULTS_HTML_TEMP, FILE_WRITE);
+  if(!writer.fileOut)
+  {
+    Serial.println("failed to open data HTML file " RESULTS_HTML_TEMP);
+    return false;
+  }
+  writer.active = true;
+  writer.fs = &fs;
+  writer.pass = 0;
+  writer.fileIdx = 0;
+  writer.rowCount = 0;
+  writer.subHeader = true;
+  writer.fileOut.println("<!DOCTYPE html>");
+  writer.fileOut.println("<html>");
+  writer.fileOut.println("<head>");
+  writer.fileOut.println("<title>Recording Pyrometer</title>");
+  writer.fileOut.println("</head>");
+  writer.fileOut.println("<body>");
+  writer.fileOut.println("<h1>Recorded Results</h1>");
+  writer.fileOut.println("<p>");
+  writer.fileOut.println("<table border=\"1\">");
+  writer.fileOut.println("<tr>");
+  writer.fileOut.println("<th>Date/Time</th>");
+  writer.fileOut.println("<th>Car/Driver</th>");
+  writer.fileOut.println("</tr>");
+  return true;
+}
+//
+// drop a results page part written, /py_res.html is left as it was
+//
+void Results_HTMLCancel()
+{
+  ResultsHTMLWriter& writer = resultsHTML;
+  if(!writer.active)
+  {
+    return;
+  }
+  writer.fileIn.close();
+  writer.fileOut.close();
+  DeleteFile(*writer.fs, RESULTS_HTML_TEMP);
+  writer.active = false;
+}
+//
+// table row for one record, with a position header row at the start of each results file
+//
+void Results_HTMLTableRow(ResultsHTMLWriter& writer, MeasureRecord& record)
+{
+  char buf[128];
+  char tmpStr[32];
+  char timeStr[RECORD_TIME_SIZE];
+  if(writer.subHeader)
+  {
+    writer.fileOut.println("<tr>");
+    writer.fileOut.println("<td></td>");
+    writer.fileOut.println("<td></td>");
+    for(int t_idx = 0; t_idx < record.tireCount; t_idx++)
+    {
+      for(int p_idx = 0; p_idx < record.positionCount; p_idx++)
+      {
+        sprintf(buf, "<td>%s-%s</td>", record.tireNames[t_idx], record.positionNames[p_idx]);
+        writer.fileOut.println(buf);
+      }
+    }
+    writer.fileOut.println("</tr>");
+  }
+  writer.subHeader = false;
+  writer.rowCount++;
+  writer.fileOut.println("<tr>");
+  sprintf(buf, "<td>%s</td>", Results_TimeText(record, timeStr, sizeof(timeStr)));
+  writer.fileOut.println(buf);
+  sprintf(buf, "<td>%s</td>", record.carName);
+  writer.fileOut.println(buf);
+  for(int t_idx = 0; t_idx < record.tireCount; t_idx++)
+  {
+    TempCenti tireMax = -TEMP_CENTI_MAX;
+    // get max temp
+    for(int p_idx = 0; p_idx < record.positionCount; p_idx++)
+    {
+      tireMax = tireMax > record.temps[(t_idx * record.positionCount) + p_idx] ? tireMax : record.temps[(t_idx * record.positionCount) + p_idx];
+    }
+    // add cells to file
+    for(int p_idx = 0; p_idx < record.positionCount; p_idx++)
+    {
+      Temp_Format(tmpStr, sizeof(tmpStr), record.temps[(t_idx * record.positionCount) + p_idx], deviceSettings.tempUnits, 2);
+      if (record.temps[(t_idx * record.positionCount) + p_idx] == tireMax)
+      {
+        sprintf(buf, "<td bgcolor=\"red\">%s</td>", tmpStr);
+      }
+      else
+      {
+        sprintf(buf, "<td>%s</td>", tmpStr);
+      }
+      writer.fileOut.println(buf);
+    }
+  }
+  writer.fileOut.println("</tr>");
+}
+//
+// raw text line for one record, with a position header line at the start of each results file
+//
+void Results_HTMLTextRow(ResultsHTMLWriter& writer, MeasureRecord& record)
+{
+  char outStr[512];
+  char tmpStr[64];
+  char timeStr[RECORD_TIME_SIZE];
+  if(writer.subHeader)
+  {
+    sprintf(outStr, "\t%s", record.carName);
+    for(int tireIdx = 0; tireIdx < record.tireCount; tireIdx++)
+    {
+      for(int posIdx = 0; posIdx < record.positionCount; posIdx++)
+      {
+        sprintf(tmpStr, "\t%s-%s", record.tireNames[tireIdx], record.positionNames[posIdx]);
+        strcat(outStr, tmpStr);
+      }
+    }
+    writer.fileOut.println(outStr);
+    writer.subHeader = false;
+  }
+  sprintf(outStr, "%s\t%s", Results_TimeText(record, timeStr, sizeof(timeStr)), record.carName);
+  for(int t_idx = 0; t_idx < record.tireCount; t_idx++)
+  {
+    // add cells to file
+    for(int p_idx = 0; p_idx < record.positionCount; p_idx++)
+    {
+      strcat(outStr, "\t");
+      Temp_Format(tmpStr, sizeof(tmpStr), record.temps[(t_idx * record.positionCount) + p_idx], deviceSettings.tempUnits, 2);
+      strcat(outStr, tmpStr);
+    }
+  }
+  writer.fileOut.println(outStr);
+  writer.rowCount++;
+}
+//
+// end of the table rows pass - placeholder row if there were no results, start of the raw text
+//
+void Results_HTMLTableEnd(ResultsHTMLWriter& writer)
+{
+  if(writer.rowCount == 0)
+  {
+    writer.fileOut.println("<tr>");
+    writer.fileOut.println("<td>---</td>");
+    writer.fileOut.println("<td>---</td>");
+    for(int t_idx = 0; t_idx < 4; t_idx++)
+    {
+      writer.fileOut.println("<td>---</td>");
+      // add cells to file
+      for(int p_idx = 0; p_idx < 3; p_idx++)
+      {
+        writer.fileOut.println("<td>---</td>");
+      }
+    }
+    writer.fileOut.println("</tr>");
+  }
+  writer.fileOut.println("</table>");
+  writer.fileOut.println("</p>");
+  writer.fileOut.println("<p>");
+  writer.fileOut.println("<button name=\"home\" type=\"submit\" value=\"home\"><a href=\"/py_main.html\">Home</a></button>");
+  writer.fileOut.println("</p>");
+  // add copy button, raw results text and script
+  writer.fileOut.println("<p>");
+  writer.fileOut.println("<button onclick=\"copyResults()\">Copy data</button>");
+  writer.fileOut.println("</p>");
+  writer.fileOut.println("<p>");
+  writer.fileOut.println("<textarea id=\"rawTextResultsID\" rows=\"20\" cols=\"100\">");
+}
+//
+// end of the page, RESULTS_HTML_TEMP replaces /py_res.html
+//
+void Results_HTMLEnd(ResultsHTMLWriter& writer)
+{
+  writer.fileOut.println("</textarea>");
+  writer.fileOut.println("</p>");
+  writer.fileOut.println("</body>");
+  writer.fileOut.println("<script>");
+  writer.fileOut.println("function copyResults() {");
+  writer.fileOut.println("var copyText = document.getElementById(\"rawTextResultsID\");");
+  writer.fileOut.println("copyText.select();");
+  writer.fileOut.println("copyText.setSelectionRange(0, 99999);");
+  writer.fileOut.println("navigator.clipboard.writeText(copyText.value);");
+  writer.fileOut.println("}");
+  writer.fileOut.println("</script>");
+  writer.fileOut.println("</html>");
+  writer.fileOut.close();
+  DeleteFile(*writer.fs, "/py_res.html");
+  writer.fs->rename(RESULTS_HTML_TEMP, "/py_res.html");
+  writer.active = false;
+
+  #ifdef DEBUG_VERBOSE
+  Serial.println("Done writing, readback");
+  File fileIn = writer.fs->open("/py_res.html", FILE_READ);
+  Serial.println("/py_res.html");
+  Line_Begin(writer.reader, fileIn);
+  while(true)
+  {
+    char* line = Line_Read(writer.reader);
+    if(strlen(line)==0)
+    {
+      break;
+    }
+    Serial.println(line);
+  }
+  Serial.println("Done");
+  fileIn.close();
+  #endif
+}
+//
+// write up to RESULTS_HTML_STEP_ROWS records of the results page (each results file is read twice,
+// table rows then raw text), returns true when the page is done or was not started
+//
+bool Results_HTMLStep()
+{
+  ResultsHTMLWriter& writer = resultsHTML;
+  if(!writer.active)
+  {
+    return true;
+  }
+  uint32_t probeStart = Probe_Start();
+  char nameBuf[32];
+  MeasureRecord record;
+  int rows = 0;
+  while(rows < RESULTS_HTML_STEP_ROWS)
+  {
+    // next results file
+    if(!writer.fileIn)
+    {
+      while(writer.fileIdx < 100)
+      {
+        sprintf(nameBuf, "/py_temps_%d.txt", writer.fileIdx);
+        writer.fileIn = SD.open(nameBuf, FILE_READ);
+        if(writer.fileIn)
+        {
+          break;
+        }
+        writer.fileIdx++;
+      }
+      if(writer.fileIdx >= 100)
+      {
+        if(writer.pass == 0)
+        {
+          Results_HTMLTableEnd(writer);
+          writer.pass = 1;
+          writer.fileIdx = 0;
+          writer.rowCount = 0;
+          break;
+        }
+        Results_HTMLEnd(writer);
+        break;
+      }
+      Line_Begin(writer.reader, writer.fileIn);
+      writer.subHeader = true;
+    }
+    char* line = Line_Read(writer.reader);
+    // end of file
+    if(strlen(line) == 0)
+    {
+      writer.fileIn.close();
+      writer.fileIdx++;
+      continue;
+    }
+    if(!ReadMeasurementFile(line, record))
+    {
+      continue;
+    }
+    if(writer.pass == 0)
+    {
+      Results_HTMLTableRow(writer, record);
+    }
+    else
+    {
+      Results_HTMLTextRow(writer, record);
+    }
+    rows++;
+  }
+  Probe_Stop(PROBE_HTML_RESULTS, probeStart);
+  return !writer.active;
+}
+//
+// regenerate one HTML page flagged in htmlPending, called when idle
+// one page per call so buttons are checked between pages, the results page a few records per call
+//
+void UpdatePendingHTML()
+{
+  if(htmlPending & HTML_RECORDS)
+  {
+    htmlPending &= ~HTML_RECORDS;
+    Results_Flush();
+  }
+  else if(htmlPending & HTML_DEVICE)
+  {
+    htmlPending &= ~HTML_DEVICE;
+    WriteDeviceSetupHTML(SD, "/py_set.html");
+  }
+  else if(htmlPending & HTML_CARS)
+  {
+    htmlPending &= ~HTML_CARS;
+    WriteCarSetupHTML(SD, "/py_cars.html", carSetupIdx);
+  }
+  else if(htmlPending & HTML_RESULTS)
+  {
+    // new results restart the page
+    htmlPending &= ~HTML_RESULTS;
+    if(Results_HTMLBegin(SD))
+    {
+      Results_HTMLStep();
+    }
+  }
+  else
+  {
+    Results_HTMLStep();
+  }
+}
+//
+// apply forms queued by the web server, returns true if any were applied
+// loop task only, from the main menu - no measurement, menu or record view holds a car index or
+// carNames pointer there, so cars can grow, shrink and change shape safely
+//
+bool Web_ApplyForms()
+{
+  WebForm form;
+  bool applied = false;
+  while((webFormQueue != NULL) && (xQueueReceive(webFormQueue, &form, 0) == pdTRUE))
+  {
+    Web_ApplyForm(form);
+    Pool_Reset(form.names);
+    applied = true;
+  }
+  return applied;
+}
+//
+// apply one posted form to the car list or device settings, save and flag the page for rewrite
+//
+void Web_ApplyForm(WebForm& form)
+{
+  if(form.pageSource == WEB_PAGE_CARS)
+  {
+    if((form.action == WEB_FORM_UPDATE) && (carSetupIdx < carCount))
+    {
+      // update current car settings
+      CarSettings& car = cars[carSetupIdx];
+      car.carName = Pool_Add(carNames, Pool_Get(form.names, form.car.carName));
+      car.tireCount = form.car.tireCount;
+      car.positionCount = form.car.positionCount;
+      for(int tireIdx = 0; tireIdx < CAR_MAX_TIRES; tireIdx++)
+      {
+        car.tireLongName[tireIdx] = Pool_Add(carNames, Pool_Get(form.names, form.car.tireLongName[tireIdx]));
+        car.tireShortName[tireIdx] = Pool_Add(carNames, Pool_Get(form.names, form.car.tireShortName[tireIdx]));
+        car.maxTemp[tireIdx] = form.car.maxTemp[tireIdx];
+      }
+      for(int posIdx = 0; posIdx < CAR_MAX_POSITIONS; posIdx++)
+      {
+        car.positionLongName[posIdx] = Pool_Add(carNames, Pool_Get(form.names, form.car.positionLongName[posIdx]));
+        car.positionShortName[posIdx] = Pool_Add(carNames, Pool_Get(form.names, form.car.positionShortName[posIdx]));
+      }
+      // checked against the new tire count, index order if the list does not fit
+      Car_SetWalk(car, form.walkText);
+      Car_SetReverse(car, form.reverseText);
+      Car_CompactNames();
+      Measure_Resize();
+      WriteCarSetupFile(SD, "/py_cars.txt");
+    }
+    else if(form.action == WEB_FORM_NEW)
+    {
+      // create a blank new car entry
+      void* mem = realloc(cars, sizeof(CarSettings) * (carCount + 1));
+      if(mem == NULL)
+      {
+        return;
+      }
+      cars = static_cast<CarSettings*>(mem);
+      carCount++;
+      carSetupIdx++;
+      CarSettings& car = cars[carCount - 1];
+      memset(&car, 0, sizeof(CarSettings));
+      car.carID = maxCarID;
+      car.carName = Pool_Add(carNames, "-");
+      car.tireCount = 4;
+      car.positionCount = 3;
+      Car_DefaultWalk(car);
+      for(int tireIdx = 0; tireIdx < car.tireCount; tireIdx++)
+      {
+        car.tireShortName[tireIdx] = Pool_Add(carNames, "-");
+        car.tireLongName[tireIdx] = Pool_Add(carNames, "-");
+        car.maxTemp[tireIdx] = 100.0;
+      }
+      for(int posIdx = 0; posIdx < car.positionCount; posIdx++)
+      {
+        car.positionShortName[posIdx] = Pool_Add(carNames, "-");
+        car.positionLongName[posIdx] = Pool_Add(carNames, "-");
+      }
+      Measure_Resize();
+      WriteCarSetupFile(SD, "/py_cars.txt");
+    }
+    else if((form.action == WEB_FORM_DELETE) && (carSetupIdx < carCount) && (carCount > 1))
+    {
+      // delete current car entry, the last car is kept so there is always one to select
+      for(int carIdx = carSetupIdx; carIdx < carCount - 1; carIdx++)
+      {
+        cars[carIdx] = cars[carIdx + 1];
+      }
+      carCount--;
+      if (void* mem = realloc(cars, sizeof(CarSettings) * carCount))
+      {
+        cars = static_cast<CarSettings*>(mem);
+      }
+      // keep the selected car selected, cars after the deleted one moved down
+      selectedCar = selectedCar > carSetupIdx ? selectedCar - 1 : selectedCar;
+      selectedCar = selectedCar < carCount ? selectedCar : carCount - 1;
+      carSetupIdx = carSetupIdx < carCount ? carSetupIdx : carCount - 1;
+      Car_CompactNames();
+      WriteCarSetupFile(SD, "/py_cars.txt");
+    }
+    else if(form.action == WEB_FORM_NEXT)
+    {
+      carSetupIdx = carSetupIdx + 1 < carCount ? carSetupIdx + 1 : carCount - 1;
+    }
+    else if(form.action == WEB_FORM_PRIOR)
+    {
+      carSetupIdx = carSetupIdx - 1 >= 0 ? carSetupIdx - 1 : 0;
+    }
+    htmlPending |= HTML_CARS;
+  }
+  else if((form.pageSource == WEB_PAGE_DEVICE) && (form.action == WEB_FORM_UPDATE))
+  {
+    // update device settings
+    strcpy(deviceSettings.ssid, form.device.ssid);
+    strcpy(deviceSettings.pass , form.device.pass);
+    deviceSettings.tempUnits = form.device.tempUnits;
+    if(deviceSettings.screenRotation != form.device.screenRotation)
+    {
+      deviceSettings.screenRotation = form.device.screenRotation;
+      RotateDisplay(true);
+    }
+    deviceSettings.stableBand[0] = form.device.stableBand[0];
+    deviceSettings.stableBand[1] = form.device.stableBand[1];
+    deviceSettings.stableDelay = form.device.stableDelay;
+    deviceSettings.stableBuffer = form.device.stableBuffer;
+    deviceSettings.stableMethod = form.device.stableMethod;
+    deviceSettings.stableSlope = form.device.stableSlope;
+    deviceSettings.traceSamples = form.device.traceSamples;
+    deviceSettings.is12Hour = form.device.is12Hour;
+    deviceSettings.fontPoints = form.device.fontPoints;
+    WriteDeviceSetupFile(SD, "/py_set.txt");
+    htmlPending |= HTML_DEVICE;
+  }
+}
+//
+// write current measurement to by car results file
+// (easier than trying to sore the results while writing the HTML....)
+//
+void WriteMeasurementFile(bool staged)
+{
+  uint32_t probeStart = Probe_Start();
+  char outStr[RECORD_LINE_SIZE];
+  char fileName[32];
+  MeasureRecord record;
+  // stored as epoch ms (millis() without an RTC), formatted when displayed
+  measureEpochMs = Clock_EpochMs();
+  // record fields point at the selected car names, no copies
+  Car_GetRecord(cars[selectedCar], measureEpochMs, record);
+  if(Record_Format(record, outStr, sizeof(outStr)) < 0)
+  {
+    #ifdef DEBUG_VERBOSE
+    Serial.println("measurement record too long, not saved");
+    #endif
+    Probe_Stop(PROBE_WRITE_MEASURE, probeStart);
+    return;
+  }
+  sprintf(fileName, "/py_temps_%d.txt", cars[selectedCar].carID);
+  // older staged records go first, this one waits behind them if they can't be copied yet
+  if(staged || !Results_Flush() || !AppendFile(SD, fileName, outStr))
+  {
+    Results_Stage(fileName, outStr);
+    htmlPending |= HTML_RECORDS;
+  }
+  Probe_Stop(PROBE_WRITE_MEASURE, probeStart);
+}
+//
+// stage a record for a results file on LittleFS (file name line, record line)
+//
+void Results_Stage(const char* fileName, const char* record)
+{
+  // a flush count left by a reset after the last flush belongs to records already gone
+  if(!LittleFS.exists(PENDING_PATH))
+  {
+    LittleFS.remove(PENDING_DONE_PATH);
+  }
+  File file = LittleFS.open(PENDING_PATH, FILE_APPEND);
+  if(!file)
+  {
+    #ifdef DEBUG_VERBOSE
+    Serial.println("failed to stage measurement record");
+    #endif
+    return;
+  }
+  file.println(fileName);
+  file.println(record);
+  file.close();
+}
+//
+// count of staged records already copied to SD (PENDING_DONE_PATH), 0 if none
+//
+int Results_FlushedCount()
+{
+  char buf[16];
+  File file = LittleFS.open(PENDING_DONE_PATH, FILE_READ);
+  if(!file)
+  {
+    return 0;
+  }
+  size_t len = file.read((uint8_t*)buf, sizeof(buf) - 1);
+  buf[len] = '\0';
+  file.close();
+  return atoi(buf);
+}
+//
+// save count of staged records copied to SD, rewritten after every record
+//
+void Results_SetFlushedCount(int count)
+{
+  File file = LittleFS.open(PENDING_DONE_PATH, FILE_WRITE);
+  if(!file)
+  {
+    return;
+  }
+  file.print(count);
+  file.close();
+}
+//
+// true if a results file already ends with line (println, so followed by CR LF)
+//
+bool Results_EndsWith(fs::FS &fs, const char* path, const char* line)
+{
+  File file = fs.open(path, FILE_READ);
+  if(!file)
+  {
+    return false;
+  }
+  size_t len = strlen(line);
+  bool match = (file.size() >= len + 2) && file.seek(file.size() - len - 2);
+  for(size_t idx = 0; match && (idx < len + 2); idx++)
+  {
+    int expected = idx < len ? (unsigned char)line[idx] : (idx == len ? '\r' : '\n');
+    match = file.read() == expected;
+  }
+  file.close();
+  return match;
+}
+//
+// copy staged records to their SD results files, then remove the staging file
+// safe to repeat after a reset part way through - records counted in PENDING_DONE_PATH are skipped,
+// and the next one is skipped if it reached SD before its count was saved
+// stops at the first record that can't be written (no SD card), staged records are kept for a retry
+// returns true if nothing is left staged
+//
+bool Results_Flush()
+{
+  char fileName[32];
+  char* line;
+  if(!LittleFS.exists(PENDING_PATH))
+  {
+    LittleFS.remove(PENDING_DONE_PATH);
+    return true;
+  }
+  if(SD.cardType() == CARD_NONE)
+  {
+    return false;
+  }
+  File file = LittleFS.open(PENDING_PATH, FILE_READ);
+  if(!file)
+  {
+    return false;
+  }
+  LineReader* reader = (LineReader*)calloc(1, sizeof(LineReader));
+  if(reader == NULL)
+  {
+    file.close();
+    return false;
+  }
+  bool allCopied = true;
+  int flushedCount = Results_FlushedCount();
+  int recordIdx = 0;
+  Line_Begin(*reader, file);
+  while(true)
+  {
+    line = Line_Read(*reader);
+    if(strlen(line) == 0)
+    {
+      break;
+    }
+    strlcpy(fileName, line, sizeof(fileName));
+    line = Line_Read(*reader);
+    if(strlen(line) == 0)
+    {
+      break;
+    }
+    if(recordIdx < flushedCount)
+    {
+      recordIdx++;
+      continue;
+    }
+    if(((recordIdx > flushedCount) || !Results_EndsWith(SD, fileName, line)) &&
+       !AppendFile(SD, fileName, line))
+    {
+      allCopied = false;
+      break;
+    }
+    recordIdx++;
+    Results_SetFlushedCount(recordIdx);
+  }
+  free(reader);
+  file.close();
+  if(!allCopied)
+  {
+    return false;
+  }
+  // staging file first, a count left without it is cleared by the next flush or stage
+  LittleFS.remove(PENDING_PATH);
+  LittleFS.remove(PENDING_DONE_PATH);
+  return true;
+}
+//
+// parse a measurement file line (modified in place), record fields point into the line
+// returns false if the line is not a valid record
+//
+bool ReadMeasurementFile(char buf[], MeasureRecord& record)
+{
+  uint32_t probeStart = Probe_Start();
+  bool isValid = Record_Parse(buf, record);
+  // older records hold temps in the units set when the settings file was first read by this firmware,
+  // kept in legacyUnits so changing units later does not change them
+  if(isValid)
+  {
+    Record_LegacyToC(record, deviceSettings.legacyUnits);
+  }
+  Probe_Stop(PROBE_READ_MEASURE, probeStart);
+  return isValid;
+}
+//
+// display text for a record time - epoch records are formatted here, older records keep their stored text
+//
+char* Results_TimeText(const MeasureRecord& record, char* buf, int bufSize)
+{
+  if(record.epochMs == 0)
+  {
+    strlcpy(buf, record.dateTime, bufSize);
+    return buf;
+  }
+  return Clock_FormatEpoch(record.epochMs, buf, bufSize);
+}
+//
+// text as a quoted JSON string, quotes, backslashes and control characters escaped
+//
+void Results_PrintJSONString(Print& out, const char* text)
+{
+  char escaped[8];
+  out.print("\"");
+  for(const char* chr = text; *chr != '\0'; chr++)
+  {
+    if((*chr == '"') || (*chr == '\\'))
+    {
+      out.print('\\');
+      out.print(*chr);
+    }
+    else if((unsigned char)*chr < 0x20)
+    {
+      snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)*chr);
+      out.print(escaped);
+    }
+    else
+    {
+      out.print(*chr);
+    }
+  }
+  out.print("\"");
+}
+//
+// write one record as a JSON object, first is false to put a separating comma ahead of it
+// temps_cc are hundredths of a degree C whatever the display units
+//
+void Results_WriteJSONRecord(Print& out, int carID, MeasureRecord& record, bool first)
+{
+  char number[24];
+  char timeStr[RECORD_TIME_SIZE];
+  out.print(first ? "{" : ",{");
+  out.print("\"car_id\":");
+  out.print(carID);
+  out.print(",\"car\":");
+  Results_PrintJSONString(out, record.carName);
+  out.print(",\"time_ms\":");
+  Record_FormatInt(number, sizeof(number), (int64_t)record.epochMs);
+  out.print(number);
+  out.print(",\"time\":\"");
+  out.print(Results_TimeText(record, timeStr, sizeof(timeStr)));
+  out.print("\",\"tires\":");
+  out.print(record.tireCount);
+  out.print(",\"positions\":");
+  out.print(record.positionCount);
+  out.print(",\"temps_cc\":[");
+  int tempCount = record.tireCount * record.positionCount;
+  for(int tempIdx = 0; tempIdx < tempCount; tempIdx++)
+  {
+    Record_FormatInt(number, sizeof(number), record.temps[tempIdx]);
+    out.print(tempIdx == 0 ? "" : ",");
+    out.print(number);
+  }
+  out.print("]");
+  if(record.hasReadingTimes)
+  {
+    out.print(",\"reading_ms\":[");
+    for(int tempIdx = 0; tempIdx < tempCount; tempIdx++)
+    {
+      Record_FormatInt(number, sizeof(number), (int64_t)record.readingMs[tempIdx]);
+      out.print(tempIdx == 0 ? "" : ",");
+      out.print(number);
+    }
+    out.print("],\"settle_ms\":[");
+    for(int tempIdx = 0; tempIdx < tempCount; tempIdx++)
+    {
+      out.print(tempIdx == 0 ? "" : ",");
+      out.print(record.settleMs[tempIdx]);
+    }
+    out.print("]");
+  }
+  out.print("}");
+}
+//
+// fill one chunk of the /api/results body - records with fromMs <= time <= toMs, carID < 0 for all cars
+// older records without epoch time only match when fromMs is 0
+// caller holds spiMutex for the chunk, the file position is kept in stream so cars and results files
+// may change between chunks (a car added or removed shifts which files are left to read)
+// returns bytes written to buffer, 0 once the closing text is sent
+//
+size_t Results_FillJSON(ResultsStream& stream, uint8_t* buffer, size_t maxLen)
+{
+  size_t len = 0;
+  File file;
+  int fileCarIdx = -1;
+  while(len < maxLen)
+  {
+    // formatted text first
+    if(stream.textSent < stream.textLen)
+    {
+      size_t count = stream.textLen - stream.textSent;
+      count = count < maxLen - len ? count : maxLen - len;
+      memcpy(&buffer[len], &stream.text[stream.textSent], count);
+      stream.textSent += count;
+      len += count;
+      continue;
+    }
+    if(stream.finished)
+    {
+      break;
+    }
+    BufferPrint out(stream.text, sizeof(stream.text));
+    if(!stream.started)
+    {
+      out.print("{\"records\":[");
+      stream.started = true;
+    }
+    else if((stream.carIdx >= carCount) || (stream.recordCount >= RESULTS_JSON_MAX))
+    {
+      out.print("]}");
+      stream.finished = true;
+    }
+    else if((stream.carID >= 0) && (cars[stream.carIdx].carID != stream.carID))
+    {
+      stream.carIdx++;
+      stream.fileOffset = 0;
+    }
+    else
+    {
+      if(fileCarIdx != stream.carIdx)
+      {
+        char fileName[32];
+        if(file)
+        {
+          file.close();
+        }
+        sprintf(fileName, "/py_temps_%d.txt", cars[stream.carIdx].carID);
+        file = SD.open(fileName, FILE_READ);
+        if(!file || !file.seek(stream.fileOffset))
+        {
+          stream.carIdx++;
+          stream.fileOffset = 0;
+          continue;
+        }
+        fileCarIdx = stream.carIdx;
+        Line_Begin(stream.reader, file);
+      }
+      char* line = Line_Read(stream.reader);
+      // bytes read ahead into the reader buffer are not consumed yet
+      stream.fileOffset = file.position() - (stream.reader.end - stream.reader.start);
+      if(strlen(line) == 0)
+      {
+        file.close();
+        fileCarIdx = -1;
+        stream.carIdx++;
+        stream.fileOffset = 0;
+        continue;
+      }
+      MeasureRecord record;
+      // cheap integer compare, no time text parsing
+      if(ReadMeasurementFile(line, record) && (record.epochMs >= stream.fromMs) && (record.epochMs <= stream.toMs))
+      {
+        Results_WriteJSONRecord(out, cars[stream.carIdx].carID, record, stream.recordCount == 0);
+        // a record too long for the text buffer is left out
+        stream.recordCount += out.overflow ? 0 : 1;
+      }
+    }
+    stream.textLen = out.overflow ? 0 : out.len;
+    stream.textSent = 0;
+  }
+  if(file)
+  {
+    file.close();
+  }
+  return len;
+}
+
+//
+// checksum (FNV-1a) of a journal entry up to the checksum field
+//
+uint32_t Journal_Checksum(const JournalEntry& entry)
+{
+  const uint8_t* bytes = (const uint8_t*)&entry;
+  uint32_t hash = 2166136261UL;
+  for(size_t idx = 0; idx < offsetof(JournalEntry, checksum); idx++)
+  {
+    hash = (hash ^ bytes[idx]) * 16777619UL;
+  }
+  return hash;
+}
+//
+// seal and write one journal entry, mode FILE_WRITE starts a new journal, FILE_APPEND adds to it
+// the file is closed after each entry so LittleFS commits it
+//
+bool Journal_Write(JournalEntry& entry, const char* mode)
+{
+  entry.magic = JOURNAL_MAGIC;
+  entry.checksum = Journal_Checksum(entry);
+  File file = LittleFS.open(JOURNAL_PATH, mode);
+  if(!file)
+  {
+    #ifdef DEBUG_VERBOSE
+    Serial.println("failed to open measurement journal");
+    #endif
+    return false;
+  }
+  bool isWritten = file.write((const uint8_t*)&entry, sizeof(entry)) == sizeof(entry);
+  file.close();
+  return isWritten;
+}
+//
+// start a new journal for a car measurement session
+//
+void Journal_Start(int carID, int tireCount, int positionCount)
+{
+  JournalEntry entry;
+  memset(&entry, 0, sizeof(entry));
+  entry.type = JOURNAL_START;
+  entry.carID = carID;
+  entry.tireCount = tireCount;
+  entry.positionCount = positionCount;
+  entry.epochMs = Clock_EpochMs();
+  Journal_Write(entry, FILE_WRITE);
+}
+//
+// append a stable reading to the journal
+//
+void Journal_Append(int tempIdx, TempCenti temp, uint32_t settleMs, uint64_t epochMs, uint8_t flags)
+{
+  JournalEntry entry;
+  memset(&entry, 0, sizeof(entry));
+  entry.type = JOURNAL_READING;
+  entry.tempIdx = tempIdx;
+  entry.carID = cars[selectedCar].carID;
+  entry.tireCount = cars[selectedCar].tireCount;
+  entry.positionCount = cars[selectedCar].positionCount;
+  entry.temp = temp;
+  entry.settleMs = settleMs;
+  entry.epochMs = epochMs;
+  entry.flags = flags;
+  Journal_Write(entry, FILE_APPEND);
+}
+//
+// remove the journal once its session is in the results file (or discarded)
+//
+void Journal_Clear()
+{
+  if(LittleFS.exists(JOURNAL_PATH))
+  {
+    LittleFS.remove(JOURNAL_PATH);
+  }
+}
+//
+// replay the journal into tireTemps/tireTimes/tireSettleMs/tireFlags
+// stops at the first torn or corrupt entry, tires with missing positions are cleared
+// (measurement resumes a whole tire at a time)
+// returns true with the car index and restored reading count if there is a session to resume
+//
+bool Journal_Load(int& carIdx, int& readingCount)
+{
+  JournalEntry entry;
+  JournalEntry start;
+  bool isStarted = false;
+  readingCount = 0;
+  carIdx = -1;
+  File file = LittleFS.open(JOURNAL_PATH, FILE_READ);
+  if(!file)
+  {
+    return false;
+  }
+  Measure_Clear();
+  while(file.read((uint8_t*)&entry, sizeof(entry)) == sizeof(entry))
+  {
+    if((entry.magic != JOURNAL_MAGIC) || (entry.checksum != Journal_Checksum(entry)))
+    {
+      break;
+    }
+    if(entry.type == JOURNAL_START)
+    {
+      start = entry;
+      isStarted = true;
+    }
+    else if((entry.type == JOURNAL_READING) && isStarted &&
+            (entry.tempIdx < start.tireCount * start.positionCount) && (entry.tempIdx < measureCapacity))
+    {
+      tireTemps[entry.tempIdx] = entry.temp;
+      tireTimes[entry.tempIdx] = entry.epochMs;
+      tireSettleMs[entry.tempIdx] = entry.settleMs;
+      tireFlags[entry.tempIdx] = entry.flags;
+    }
+  }
+  file.close();
+  if(!isStarted)
+  {
+    return false;
+  }
+  // car must still exist with the same layout
+  for(int idx = 0; idx < carCount; idx++)
+  {
+    if((cars[idx].carID == start.carID) &&
+       (cars[idx].tireCount == start.tireCount) &&
+       (cars[idx].positionCount == start.positionCount))
+    {
+      carIdx = idx;
+      break;
+    }
+  }
+  if(carIdx < 0)
+  {
+    return false;
+  }
+  for(int tireIdx = 0; tireIdx < start.tireCount; tireIdx++)
+  {
+    bool isComplete = true;
+    for(int posIdx = 0; posIdx < start.positionCount; posIdx++)
+    {
+      isComplete = isComplete && (tireTimes[(tireIdx * start.positionCount) + posIdx] != 0);
+    }
+    for(int posIdx = 0; posIdx < start.positionCount; posIdx++)
+    {
+      int tempIdx = (tireIdx * start.positionCount) + posIdx;
+      if(!isComplete)
+      {
+        tireTemps[tempIdx] = 0;
+        tireTimes[tempIdx] = 0;
+        tireSettleMs[tempIdx] = 0;
+        tireFlags[tempIdx] = 0;
+      }
+      else
+      {
+        readingCount++;
+      }
+    }
+  }
+  return readingCount > 0;
+}
+//
+// at boot, offer to resume an interrupted measurement session
+// returns true if the user chose to resume (selectedCar and tire temps restored)
+//
+bool Journal_Resume()
+{
+  int carIdx;
+  int readingCount;
+  if(!Journal_Load(carIdx, readingCount))
+  {
+    Measure_Clear();
+    Journal_Clear();
+    return false;
+  }
+  char outStr[MENU_TEXT_SIZE];
+  MenuChoice resumeYN[2];
+  snprintf(outStr, sizeof(outStr), "Resume %s (%d of %d)", Pool_Get(carNames, cars[carIdx].carName),
+                                   readingCount, cars[carIdx].tireCount * cars[carIdx].positionCount);
+  resumeYN[0].description = outStr;             resumeYN[0].result = 1;
+  resumeYN[1].description = "Discard readings"; resumeYN[1].result = 0;
+  if(MenuSelect(deviceSettings.fontPoints, resumeYN, 2, 1) == 1)
+  {
+    selectedCar = carIdx;
+    return true;
+  }
+  Measure_Clear();
+  Journal_Clear();
+  return false;
+}
+
+// TIRE TEMPERATURE MEASUREMENT AND DISPLAY
+//
+// measure temperatures on a single tire
+//
+int MeasureTireTemps(int tireIdx)
+{
+  char outStr[512];
+  // location of text
+  textPosition[0] = 5;
+  textPosition[1] = 0;//fontHeight;
+
+  bool armed = false;
+  // measure location - O, M, I
+  measIdx = 0;  
+  // reset tire temps to 0 (not measured)
+  for(int idx = 0; idx < cars[selectedCar].positionCount; idx++)
+  {
+    tireTemps[(tireIdx * cars[selectedCar].positionCount) + idx] = 0;
+    tireTimes[(tireIdx * cars[selectedCar].positionCount) + idx] = 0;
+    tireSettleMs[(tireIdx * cars[selectedCar].positionCount) + idx] = 0;
+    tireFlags[(tireIdx * cars[selectedCar].positionCount) + idx] = 0;
+  }
+  armed = false;
+  unsigned long priorTime = millis();
+  unsigned long curTime = millis();
+  // text position on screen
+  // measuring until all positions are measured
+  bool drawStars = true;
+
+  while(measIdx < cars[selectedCar].positionCount)
+  {
+    // measIdx counts positions measured, posIdx follows the tire's position order
+    int posIdx = Car_PositionAt(cars[selectedCar], tireIdx, measIdx);
+    if(drawStars)
+    {
+      textPosition[1] = fontHeight;
+      sprintf(outStr,"%s %s        ",  Pool_Get(carNames, cars[selectedCar].tireLongName[tireIdx]),  Pool_Get(carNames, cars[selectedCar].positionLongName[posIdx]));
+      tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);      
+      textPosition[1] += 2* fontHeight;
+
+      sprintf(outStr,"        ****                          ");
+      tftDisplay.setFreeFont(FSS24); // max font
+      tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);      
+      SetFont(deviceSettings.fontPoints);
+      drawStars = false;
+    }
+    // get time and process buttons for press/release
+    curTime = millis();
+    CheckButtons(curTime);
+    // button 0 release arms probe
+    // prior to arm, display ****, after display temp as it stabilizes
+    if (buttons[0].buttonReleased)
+    {
+      armed = true;
+      buttons[0].buttonReleased = false;
+    }
+    // check for button 1 or 2 release (tire selection) before measure starts
+    else if (((buttons[1].buttonReleased) || (buttons[2].buttonReleased))  && (measIdx == 0))
+    {
+
+      sprintf(outStr,"        ****        ");
+      tftDisplay.setFreeFont(FSS24); // max font
+      tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);      
+      SetFont(deviceSettings.fontPoints);
+    }
+    // if not armed wait for button
+    if(!armed)
+    {
+      WaitButtonEvent(100);
+      continue;
+    }
+    // sleep until the probe touches the tire, up/down disarms
+    if(!Thermo_WaitContact(textPosition[1] + (2 * fontHeight)))
+    {
+      armed = false;
+      continue;
+    }
+    // wait for stable temp after arming
+    int tempIdx = (tireIdx * cars[selectedCar].positionCount) + posIdx;
+    unsigned long settleStart = millis();
+    float stableTemp = 0.0F;
+    Trace_Start(tempIdx);
+    int reading = GetStableTemp(posIdx, textPosition[0], textPosition[1], stableTemp);
+    Trace_End(reading, stableTemp);
+    Trace_Flush();
+    // disarm after stable temp (or fault)
+    armed = false;
+    if(reading == READING_FAULT)
+    {
+      // show the fault, then wait to be armed again on the same position
+      sprintf(outStr, "%s - check probe        ", thermoFaultNames[thermoFault]);
+      tftDisplay.drawString(outStr, textPosition[0], textPosition[1] + (2 * fontHeight), GFXFF);
+      Power_IdleDelay(FAULT_SHOW_MS);
+      sprintf(outStr, "                                        ");
+      tftDisplay.drawString(outStr, textPosition[0], textPosition[1] + (2 * fontHeight), GFXFF);
+      drawStars = true;
+      continue;
+    }
+    // stable temps are found in display units, stored in C
+    tireTemps[tempIdx] = Temp_FromDisplay(stableTemp, deviceSettings.tempUnits);
+    tireSettleMs[tempIdx] = millis() - settleStart;
+    tireTimes[tempIdx] = Clock_EpochMs();
+    tireFlags[tempIdx] = reading == READING_ESTIMATE ? RECORD_FLAG_ESTIMATE : 0;
+    Journal_Append(tempIdx, tireTemps[tempIdx], tireSettleMs[tempIdx], tireTimes[tempIdx], tireFlags[tempIdx]);
+    // next position
+    measIdx++;
+    drawStars = true;
+  }
+  Serial.println("Exit MeasureTireTemps");
+  return 1;
+}
+//
+// display current probe temp until user cancels
+//
+void InstantTemp()
+{
+  unsigned long priorTime = 0;
+  unsigned long curTime = millis();
+  char outStr[128];
+  char timeStr[RTC_STRING_SIZE];
+  char dateStr[RTC_STRING_SIZE];
+  float instant_temp = 0.0;
+  // location of text
+  textPosition[0] = 5;
+  textPosition[1] = 0;
+  randomSeed(100);
+  tftDisplay.fillScreen(TFT_WHITE);
+  YamuraBanner();
+  SetFont(deviceSettings.fontPoints);
+  tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+  sprintf(outStr, "Temperature at %s %s", RTC_GetStringTime(timeStr, sizeof(timeStr)), RTC_GetStringDate(dateStr, sizeof(dateStr)));
+  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+  textPosition[1] +=  fontHeight;
+  sprintf(outStr, " ");
+  SetFont(24);
+  textPosition[0] = tftDisplay.width()/2;
+  textPosition[1] = tftDisplay.height()/2;
+  tftDisplay.setTextDatum(TC_DATUM);
+ 
+  while(true)
+  {
+    curTime = millis();
+    if(curTime - priorTime > 1000)
+    {
+      textPosition[0] = 5;
+      textPosition[1] = 0;
+      SetFont(deviceSettings.fontPoints);
+      tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+      sprintf(outStr, "Temperature at %s %s", RTC_GetStringTime(timeStr, sizeof(timeStr)), RTC_GetStringDate(dateStr, sizeof(dateStr)));
+      tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+      textPosition[1] +=  fontHeight;
+      sprintf(outStr, " ");
+      SetFont(24);
+      textPosition[0] = tftDisplay.width()/2;
+      textPosition[1] = tftDisplay.height()/2;
+      tftDisplay.setTextDatum(TC_DATUM);
+
+      priorTime = curTime;
+      // read temp
+      instant_temp = Thermo_GetTemp();
+      // full width, fault text is wider than a temp
+      tftDisplay.fillRect(0, textPosition[1], tftDisplay.width(), fontHeight, TFT_WHITE);
+      if(thermoFault != THERMO_OK)
+      {
+        sprintf(outStr, "%s", thermoFaultNames[thermoFault]);
+      }
+      else
+      {
+        sprintf(outStr, "%0.2f", instant_temp);
+      }
+      tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
+    }
+    CheckButtons(curTime);
+    // any button released, exit
+    if ((buttons[0].buttonReleased) || (buttons[1].buttonReleased) || (buttons[2].buttonReleased))
+    {
+      buttons[0].buttonReleased = false;
+      buttons[1].buttonReleased = false;
+      buttons[2].buttonReleased = false;
+      break;
+    }
+    // sleep until next update or button
+    curTime = millis();
+    WaitButtonEvent(curTime - priorTime < 1000 ? 1000 - (curTime - priorTime) : 0);
+  }
+  SetFont(deviceSettings.fontPoints);
+}
+//
+// draw grid for tire measurement (computed in ComputeGridLayout)
+//
+void DrawTireMeasureGrid(const GridLayout& layout)
+{
+  int left = layout.lineV[0];
+  int right = layout.lineV[layout.lineVCount - 1];
+  // horizontal lines
+  for(int idx = 0; idx <= layout.rowCount; idx++)
+  {
+    tftDisplay.drawWideLine(left, layout.lineH[idx], right, layout.lineH[idx], 1, TFT_BLACK, TFT_WHITE);
+  }
+  // vertical Lines
+  for(int idx = 0; idx < layout.lineVCount; idx++)
+  {
+    tftDisplay.drawWideLine(layout.lineV[idx], layout.lineH[0], layout.lineV[idx], layout.lineH[layout.rowCount], 1, TFT_BLACK, TFT_WHITE);
+  }
+}
+//
+// compute grid layouts for all cars so the first display doesn't pay for it
+//
+void SetupTireMeasureGrid()
+{
+  for(int carIdx = 0; carIdx < carCount; carIdx++)
+  {
+    GetGridLayout(cars[carIdx].tireCount, cars[carIdx].positionCount);
+  }
+}
+//
+// get grid layout for a tire/position count, computing it if not cached
+// cached layouts are recomputed if the screen size (rotation) or font size changed
+//
+GridLayout* GetGridLayout(int tireCount, int positionCount)
+{
+  int width = tftDisplay.width();
+  int height = tftDisplay.height();
+  for(int idx = 0; idx < GRID_LAYOUT_CACHE; idx++)
+  {
+    if(gridLayouts[idx].valid &&
+       (gridLayouts[idx].tireCount == tireCount) &&
+       (gridLayouts[idx].positionCount == positionCount) &&
+       (gridLayouts[idx].requestedFont == deviceSettings.fontPoints) &&
+       (gridLayouts[idx].screenWidth == width) &&
+       (gridLayouts[idx].screenHeight == height))
+    {
+      return &gridLayouts[idx];
+    }
+  }
+  GridLayout* layout = &gridLayouts[gridLayoutNext];
+  gridLayoutNext = (gridLayoutNext + 1) % GRID_LAYOUT_CACHE;
+  ComputeGridLayout(*layout, tireCount, positionCount);
+  return layout;
+}
+//
+// set up grid lines and text locations for tire measurement based on tire and position counts,
+// screen size and font size. picks the largest font (up to 12 point) that fits, with 2 tires
+// per row if they fit side by side, else 1 tire per row
+//
+// V               V               V
+// 0               1               2
+// ================================= H0
+// | 0,0  0,1  0,2 | 0,5  0,4  0,3 |
+// | 1,0  1,1  1,2 | 1,5  1,4  1,3 |
+// ================================= H1
+// | 2,0  2,1  2,2 | 2,5  2,4  2,3 |
+// | 3,0  3,1  3,2 | 3,5  3,4  3,3 |
+// ================================= H2
+//               DONE
+//
+// note that cell order in right hand column is reversed so measure order matches orientation on car
+//
+void ComputeGridLayout(GridLayout& layout, int tireCount, int positionCount)
+{
+  int fontSizes[2] = {12, 9};
+  tireCount = tireCount < 1 ? 1 : (tireCount > GRID_MAX_TIRES ? GRID_MAX_TIRES : tireCount);
+  positionCount = positionCount < 1 ? 1 : (positionCount > GRID_MAX_POSITIONS ? GRID_MAX_POSITIONS : positionCount);
+  layout.tireCount = tireCount;
+  layout.positionCount = positionCount;
+  layout.requestedFont = deviceSettings.fontPoints;
+  layout.screenWidth = tftDisplay.width();
+  layout.screenHeight = tftDisplay.height();
+  // banner at bottom of screen
+  SetFont(9);
+  int bannerHeight = fontHeight;
+  int maxFont = deviceSettings.fontPoints <= 12 ? deviceSettings.fontPoints : 12;
+  bool fits = false;
+  for(int fontIdx = 0; (fontIdx < 2) && !fits; fontIdx++)
+  {
+    if(fontSizes[fontIdx] > maxFont)
+    {
+      continue;
+    }
+    SetFont(fontSizes[fontIdx]);
+    layout.fontPoints = fontSizes[fontIdx];
+    layout.cellHeight = tftDisplay.fontHeight(GFXFF);
+    layout.cellWidth = tftDisplay.textWidth("000.0") + 6;
+    for(int perRow = 2; (perRow >= 1) && !fits; perRow--)
+    {
+      int colWidth = (layout.screenWidth - 6) / perRow;
+      int rows = (tireCount + perRow - 1) / perRow;
+      int gridTop = layout.cellHeight + 10;
+      layout.tiresPerRow = perRow;
+      fits = (positionCount * layout.cellWidth + 5 <= colWidth) &&
+             (gridTop + rows * (2 * layout.cellHeight + 12) <= layout.screenHeight - bannerHeight);
+    }
+  }
+  // nothing fits, squeeze smallest font into the space available
+  if(!fits)
+  {
+    layout.tiresPerRow = (positionCount * layout.cellWidth + 5 <= (layout.screenWidth - 6) / 2) ? 2 : 1;
+  }
+  layout.rowCount = (tireCount + layout.tiresPerRow - 1) / layout.tiresPerRow;
+  int gridTop = layout.cellHeight + 10;
+  int rowHeight = 2 * layout.cellHeight + 12;
+  if(gridTop + layout.rowCount * rowHeight > layout.screenHeight - bannerHeight)
+  {
+    rowHeight = (layout.screenHeight - bannerHeight - gridTop) / layout.rowCount;
+  }
+  // horizontal grid lines
+  for(int rowIdx = 0; rowIdx <= layout.rowCount; rowIdx++)
+  {
+    layout.lineH[rowIdx] = gridTop + rowIdx * rowHeight;
+  }
+  // vertical grid lines, left, (center), right
+  layout.lineVCount = layout.tiresPerRow + 1;
+  layout.lineV[0] = 1;
+  layout.lineV[layout.lineVCount - 1] = layout.screenWidth - 5;
+  if(layout.tiresPerRow == 2)
+  {
+    layout.lineV[1] = (layout.lineV[0] + layout.lineV[2]) / 2;
+  }
+  // text columns, evenly spaced in each tire column
+  int colWidth = layout.lineV[1] - layout.lineV[0];
+  int pitch = (colWidth - 5) / positionCount;
+  for(int posIdx = 0; posIdx < positionCount; posIdx++)
+  {
+    layout.cellX[posIdx] = layout.lineV[0] + 5 + posIdx * pitch;
+    if(layout.tiresPerRow == 2)
+    {
+      layout.cellX[positionCount + posIdx] = layout.lineV[1] + 5 + (positionCount - 1 - posIdx) * pitch;
+    }
+  }
+  // text rows, name row and temp row per tire row, DONE row below grid
+  for(int rowIdx = 0; rowIdx < layout.rowCount; rowIdx++)
+  {
+    layout.cellY[rowIdx * 2] = layout.lineH[rowIdx] + 5;
+    layout.cellY[rowIdx * 2 + 1] = layout.lineH[rowIdx] + layout.cellHeight + 5;
+  }
+  layout.cellY[layout.rowCount * 2] = layout.lineH[layout.rowCount] + 10;
+  layout.valid = true;
+
+  SetFont(deviceSettings.fontPoints);
+}
+//
+// show all values for last measurement
+//
+void DisplayAllTireTemps(const MeasureRecord& record)
+{
+  unsigned long curTime = millis();
+  unsigned long priorTime = millis();
+  // location of text
+  textPosition[0] = 5;
+  textPosition[1] = 0;
+  int row = 0;
+  int col = 0;
+  char outStr[255];
+  char padStr[3];
+  TempCenti maxTemp = 0;
+  TempCenti minTemp = TEMP_CENTI_MAX;
+  uint32_t probeStart = Probe_Start();
+  // initial clear of screen
+  tftDisplay.fillScreen(TFT_WHITE);
+  YamuraBanner();
+  GridLayout* layout = GetGridLayout(record.tireCount, record.positionCount);
+  DrawTireMeasureGrid(*layout);
+
+  char timeStr[RECORD_TIME_SIZE];
+  sprintf(outStr, "%s %s", record.carName, Results_TimeText(record, timeStr, sizeof(timeStr)));
+  SetFont(layout->fontPoints);
+  tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+  tftDisplay.drawString(outStr, 5, 0, GFXFF);
+
+  for(int idxTire = 0; idxTire < record.tireCount; idxTire++)
+  {
+    // get min/max temps
+    maxTemp = 0;
+    for(int tirePosIdx = 0; tirePosIdx < record.positionCount; tirePosIdx++)
+    {
+      maxTemp = record.temps[(idxTire * record.positionCount) + tirePosIdx] > maxTemp ? record.temps[(idxTire * record.positionCount) + tirePosIdx] : maxTemp;
+      minTemp = record.temps[(idxTire * record.positionCount) + tirePosIdx] < minTemp ? record.temps[(idxTire * record.positionCount) + tirePosIdx] : minTemp;
+    }    
+	for(int tirePosIdx = 0; tirePosIdx < record.positionCount; tirePosIdx++)
+    {
+      // draw tire position name
+      row = ((idxTire / layout->tiresPerRow) * 2);
+      col = tirePosIdx + ((idxTire % layout->tiresPerRow) * record.positionCount);
+      int32_t displayTemp = Temp_ToUnits(record.temps[(idxTire * record.positionCount) + tirePosIdx], deviceSettings.tempUnits);
+      if(displayTemp >= 10000)
+      {
+        padStr[0] = '\0';
+      }
+      else if(displayTemp >= 1000)
+      {
+        sprintf(padStr, " ");
+      }
+      else
+      {
+        sprintf(padStr, "  ");
+      }
+      if(tirePosIdx == 0)
+      {
+        sprintf(outStr, "%s %s", record.tireNames[idxTire],
+                                 record.positionNames[tirePosIdx]);
+      }
+      else
+      {
+        sprintf(outStr, "%s", record.positionNames[tirePosIdx]);
+      }
+	  // tire name, position
+      DrawCellText(*layout, row, col, outStr, TFT_BLACK, TFT_WHITE);
+      row++;
+      Temp_Format(outStr, sizeof(outStr), record.temps[(idxTire * record.positionCount) + tirePosIdx], deviceSettings.tempUnits, 1);
+      // '~' marks a reading that timed out before it was stable
+      if(record.hasFlags && (record.flags[(idxTire * record.positionCount) + tirePosIdx] & RECORD_FLAG_ESTIMATE))
+      {
+        strcat(outStr, "~");
+      }
+      if(record.temps[(idxTire * record.positionCount) + tirePosIdx] == maxTemp)
+      {
+        DrawCellText(*layout, row, col, outStr, TFT_BLACK, TFT_RED);
+      }
+      else if(record.temps[(idxTire * record.positionCount) + tirePosIdx] == minTemp)
+      {
+        DrawCellText(*layout, row, col, outStr, TFT_BLACK, TFT_BLUE);
+      }
+      else
+      {
+        DrawCellText(*layout, row, col, outStr, TFT_BLACK, TFT_WHITE);
+      }
+    }
+  }
+  Probe_Stop(PROBE_DISPLAY_TEMPS, probeStart);
+  priorTime = curTime;
+  while(true)
+  {
+    curTime = millis();
+    CheckButtons(curTime);
+    // select button released, go to next tire
+    if (buttons[0].buttonReleased)
+    {
+      buttons[0].buttonReleased = false;
+      break;
+    }
+    // cancel button released, return
+    else if (buttons[1].buttonReleased)
+    {
+      buttons[1].buttonReleased = false;
+      break;
+    }
+    else if ((buttons[2].buttonReleased) || (buttons[3].buttonReleased)) 
+    {
+      buttons[2].buttonReleased = false;
+    }
+    WaitButtonEvent(100);
+  }
+}
+//
+// measure all tires/positions until Done selected
+//
+void MeasureAllTireTemps(bool resume, bool inRunGroup)
+{
+  unsigned long curTime = millis();
+  unsigned long priorTime = millis();
+  char outStr[255];
+  char padStr[3];
+  int selTire = 0;
+  bool startMeasure = false;
+  bool measureDone = false;
+  int row = 0;
+  int col = 0;
+
+  TempCenti maxTemp = 0;
+  TempCenti minTemp = TEMP_CENTI_MAX;
+  // matrix is sized when cars load, only fails if the heap could not grow it
+  if((carCount == 0) || !Measure_Resize() ||
+     (cars[selectedCar].tireCount * cars[selectedCar].positionCount > measureCapacity))
+  {
+    tftDisplay.fillScreen(TFT_WHITE);
+    YamuraBanner();
+    tftDisplay.drawString("No memory for readings", 5, 0, GFXFF);
+    tftDisplay.drawString("Select another car", 5, fontHeight, GFXFF);
+    delay(5000);
+    return;
+  }
+  if(resume)
+  {
+    // readings restored by Journal_Resume, continue at first unmeasured tire
+    selTire = GetNextTire(-1, 1);
+  }
+  else
+  {
+    // initial clear of screen
+    for(int idxTire = 0; idxTire < cars[selectedCar].tireCount; idxTire++)
+    {
+      for(int tirePosIdx = 0; tirePosIdx < cars[selectedCar].positionCount; tirePosIdx++)
+      {
+        tireTemps[(idxTire * cars[selectedCar].positionCount) + tirePosIdx] = 0;
+        tireTimes[(idxTire * cars[selectedCar].positionCount) + tirePosIdx] = 0;
+        tireSettleMs[(idxTire * cars[selectedCar].positionCount) + tirePosIdx] = 0;
+        tireFlags[(idxTire * cars[selectedCar].positionCount) + tirePosIdx] = 0;
+      }
+    }
+    Journal_Start(cars[selectedCar].carID, cars[selectedCar].tireCount, cars[selectedCar].positionCount);
+    // first tire on the car's walk
+    selTire = cars[selectedCar].walkOrder[0];
+  }
+
+  tftDisplay.fillScreen(TFT_WHITE);
+  YamuraBanner();
+  SetFont(deviceSettings.fontPoints);
+  while(true)
+  {
+    //sprintf(outStr, "%s", cars[selectedCar].carName);
+    tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+    //tftDisplay.drawString(outStr, 5, 0, GFXFF);
+
+    if(!startMeasure)
+    {
+      // tires
+      for(int idxTire = 0; idxTire < cars[selectedCar].tireCount; idxTire++)
+      {
+        // tires
+        col = (idxTire % 2);
+        maxTemp = 0;
+        minTemp = TEMP_CENTI_MAX;
+        for(int tirePosIdx = 0; tirePosIdx < cars[selectedCar].positionCount; tirePosIdx++)
+        {
+          maxTemp = tireTemps[(idxTire * cars[selectedCar].positionCount) + tirePosIdx] > maxTemp ? tireTemps[(idxTire * cars[selectedCar].positionCount) + tirePosIdx] : maxTemp;
+          minTemp = tireTemps[(idxTire * cars[selectedCar].positionCount) + tirePosIdx] < minTemp ? tireTemps[(idxTire * cars[selectedCar].positionCount) + tirePosIdx] : minTemp;
+        }
+      }
+      // do measurements for tire
+      if(selTire < cars[selectedCar].tireCount)
+      {
+        int nextDirection = MeasureTireTemps(selTire);
+        selTire = GetNextTire(selTire, nextDirection);
+        if(selTire ==  cars[selectedCar].tireCount)
+        {
+          break;
+        }
+        continue;
+      }
+    }
+    priorTime = curTime;
+    startMeasure = false;
+    measureDone = false;
+    while(true)
+    {
+      curTime = millis();
+      CheckButtons(curTime);
+      // select button released, go to next tire
+      if (buttons[0].buttonReleased)
+      {
+        if(selTire < cars[selectedCar].tireCount)
+        {
+          startMeasure = true;
+        }
+        else
+        {
+          measureDone = true;
+        }
+        buttons[0].buttonReleased = false;
+        break;
+      }
+      // cancel button released, return
+      else if (buttons[1].buttonReleased)
+      {
+        selTire = GetNextTire(selTire, 1);
+        buttons[1].buttonReleased = false;
+        break;
+      }
+      else if ((buttons[2].buttonReleased)) 
+      {
+        selTire = GetNextTire(selTire, -1);
+        buttons[2].buttonReleased = false;
+        break;
+      }
+      WaitButtonEvent(100);
+    }
+    if(measureDone)
+    {
+      break;
+    }
+  }
+  tftDisplay.fillScreen(TFT_WHITE);
+  YamuraBanner();
+  SetFont(deviceSettings.fontPoints);
+  tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+  // location of text
+  textPosition[0] = 5;
+  textPosition[1] = 0;
+  tftDisplay.drawString("Done", textPosition[0], textPosition[1], GFXFF);
+  textPosition[1] += fontHeight;
+  tftDisplay.drawString("Storing results...", textPosition[0], textPosition[1], GFXFF);
+  textPosition[1] += fontHeight;
+  WriteMeasurementFile(inRunGroup);
+  // session is in the results file (or staging file) now
+  Journal_Clear();
+  if(inRunGroup)
+  {
+    // next car confirm follows, results page waits for the end of the group
+    return;
+  }
+  // results page regenerates when idle
+  htmlPending |= HTML_RESULTS;
+  MeasureRecord record;
+  Car_GetRecord(cars[selectedCar], measureEpochMs, record);
+  DisplayAllTireTemps(record);
+}
+//
+// move to next tire after measurement of a tire is complete, 
+// or if user selects next or prior tire in list
+//
+int GetNextTire(int selTire, int nextDirection)        
+{
+  const CarSettings& car = cars[selectedCar];
+  // steps follow the car walk order, step tireCount is 'done'
+  int step = car.tireCount;
+  if(selTire < 0)
+  {
+    step = -1;
+  }
+  else if(selTire < car.tireCount)
+  {
+    step = Car_WalkStep(car, selTire);
+  }
+  step += nextDirection;
+  while(true)
+  {
+    if(step < 0)
+    {
+      step = car.tireCount;
+    }
+    if(step > car.tireCount)
+    {
+      step = 0;
+    }
+  	// stop on 'done'
+    if(step == car.tireCount)
+    {
+      return car.tireCount;
+    }
+  	// stop on first measure of tire == 0 (never measured)
+    int tireIdx = car.walkOrder[step];
+    if (tireTemps[(tireIdx * car.positionCount) + Car_PositionAt(car, tireIdx, 0)] == 0)
+    {
+      return tireIdx;
+    }
+    step += nextDirection;
+  }
+}
+//
+// grid lines enclose 2 rows of cells, one cell per measure position
+// top row is T (tire name) and measure position (O, M, I). This row is highlighted when selected during measure
+// bottom row is the 3 temperatures
+// up to 2 grid cells per axle (for cars) or 2 grid cells for front/rear for motorcycles
+//   ------------------------------------
+//  | T O    M    I    | I    M    T O  |
+//  | temp   temp temp | temp temp temp |
+//   ------------------------------------
+//
+void DrawCellText(const GridLayout& layout, int row, int col, char* outStr, uint16_t textColor, uint16_t backColor)
+{
+  tftDisplay.setTextColor(backColor, backColor);
+  if(strlen(outStr) > 1)
+  {
+    tftDisplay.fillRect(layout.cellX[col], layout.cellY[row], layout.cellWidth - 6, layout.cellHeight - 4, backColor);
+  }
+  tftDisplay.setTextColor(textColor, backColor);
+  tftDisplay.drawString(outStr, layout.cellX[col], layout.cellY[row], GFXFF);
+  tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
+}
+//
+// rotate display for right or left hand use
+//
+void RotateDisplay(bool rotateButtons)
+{
+  tftDisplay.setRotation(deviceSettings.screenRotation == 0 ? 1 : 3);
+  tftDisplay.fillScreen(TFT_WHITE);
+  if(rotateButtons)
+  {
+    int reverseButtons[BUTTON_COUNT];
+    for(int btnIdx = 0; btnIdx < BUTTON_COUNT; btnIdx++)
+    {
+      reverseButtons[BUTTON_COUNT - (btnIdx + 1)] = buttons[btnIdx].buttonPin;
+    }
+    for(int btnIdx = 0; btnIdx < BUTTON_COUNT; btnIdx++)
+    {
+      buttons[btnIdx].buttonPin = reverseButtons[btnIdx];
+    }
+  }
+}
+//
+// wait until temperature at probe stabilizes, up to STABLE_TIMEOUT_MS
+// returns READING_STABLE, READING_ESTIMATE (timed out, stableTemp is the best estimate so far)
+// or READING_FAULT (probe or amplifier fault, see thermoFault)
+//
+int GetStableTemp(int positionIdx, int row, int col, float& stableTemp)
+{
+  Serial.println("Start GetStableTemp");
+  uint32_t probeStart = Probe_Start();
+  char outStr[512];
+  float averageTemp = 0;
+  int rVal = READING_STABLE;
+  float temperature;
+  // assume the user put temp band in using correct units
+  // convert deviation band to F if needed
+  //if(deviceSettings.tempUnits == 0)
+  //{
+  //  for(int idx = 0; idx < 2; idx++)
+  //  {
+  //    deviceSettings.stableBand[idx] = CtoCRelative(deviceSettings.stableBand[idx]);
+  //  }
+  //}
+  // set initial buffer temps to 15C or 60F
+  averageTemp = deviceSettings.tempUnits == 0 ? 60.0 : 15.0;
+  Stable_BandBegin(bandDetector, deviceSettings.stableBuffer, averageTemp);
+  unsigned long startTime = millis();
+  float variance = 0.0F;
+  Stable_SlopeBegin(slopeDetector, deviceSettings.stableBuffer);
+  Stable_KalmanBegin(kalmanEstimator, deviceSettings.kalmanNoise, deviceSettings.kalmanRate);
+  Thermo_SetFilter(deviceSettings.stableMethod == STABLE_KALMAN ? THERMO_FILTER_KALMAN : THERMO_FILTER_DEFAULT);
+  // samples start every stableDelay ms, however long reading and drawing take
+  Sched_Begin(sampleSchedule, deviceSettings.stableDelay);
+  while(true)
+  {
+    temperature = Thermo_GetTemp();
+    Sched_Sample(sampleSchedule);
+    Trace_Sample();
+    if(thermoFault != THERMO_OK)
+    {
+      rVal = READING_FAULT;
+      break;
+    }
+    if(millis() - startTime >= STABLE_TIMEOUT_MS)
+    {
+      rVal = READING_ESTIMATE;
+      break;
+    }
+    if(deviceSettings.stableMethod == STABLE_KALMAN)
+    {
+      sprintf(outStr, "        %0.2f (%.2F +/-%.2F)         ", temperature, averageTemp, sqrtf(variance));
+    }
+    else
+    {
+      sprintf(outStr, "        %0.2f (%.2F)         ", temperature, averageTemp);
+    }
+    // draw current temp
+    tftDisplay.setFreeFont(FSS24); // max font
+    tftDisplay.drawString(outStr, row, col, GFXFF);      
+    SetFont(deviceSettings.fontPoints);
+    // slope method - least squares dT/dt over the window, reported temp is the fit at the newest sample
+    if(deviceSettings.stableMethod == STABLE_SLOPE)
+    {
+      if(Stable_SlopeCheck(slopeDetector, (millis() - startTime) / 1000.0F, temperature, deviceSettings.stableSlope, averageTemp))
+      {
+        break;
+      }
+      Sched_WaitNext(sampleSchedule);
+      continue;
+    }
+    // kalman method - temp and rate estimate, stable when readings stay within the band of the prediction and the rate is small
+    if(deviceSettings.stableMethod == STABLE_KALMAN)
+    {
+      if(Stable_KalmanCheck(kalmanEstimator, (millis() - startTime) / 1000.0F, temperature,
+                            deviceSettings.stableBand[1], deviceSettings.stableSlope, averageTemp, variance))
+      {
+        break;
+      }
+      Sched_WaitNext(sampleSchedule);
+      continue;
+    }
+    // band method - spread of the window around its mean inside the stable band
+    if(Stable_BandCheck(bandDetector, temperature, deviceSettings.stableBand[0], deviceSettings.stableBand[1], averageTemp))
+    {
+      break;
+    }
+    Sched_WaitNext(sampleSchedule);
+  }
+  #ifdef DEBUG_VERBOSE
+  Serial.printf("stable temp %lu samples %0.2f Hz, %lu overruns\n", sampleSchedule.samples, Sched_RateHz(sampleSchedule), sampleSchedule.overruns);
+  if(rVal != READING_STABLE)
+  {
+    Serial.printf("stable temp %s, %s\n", rVal == READING_FAULT ? "fault" : "timed out", thermoFaultNames[thermoFault]);
+  }
+  #endif
+  Probe_Stop(PROBE_STABLE_TEMP, probeStart);
+  stableTemp = averageTemp;
+  return rVal;
+}
+//
+// draw the Yamura banner at bottom of screen
+//
+void YamuraBanner()
+{
+  tftDisplay.setTextColor(TFT_BLACK, TFT_YELLOW);
+  SetFont(9);
+  int xPos = tftDisplay.width()/2;
+  int yPos = tftDisplay.height() - fontHeight/2;
+  tftDisplay.setTextDatum(BC_DATUM);
+  tftDisplay.drawString("  Yamura Motors LLC Recording Pyrometer  ",xPos, yPos, GFXFF);    // Print the font name onto the TFT screen
+  tftDisplay.setTextDatum(TL_DATUM);
+}
+//
+// set font for TFT display, update fontHeight used for vertical stepdown by line
+//
+void SetFont(int fontSize)
+{
+  switch(fontSize)
+  {
+    case 9:
+      tftDisplay.setFreeFont(FSS9);
+      break;
+    case 12:
+      tftDisplay.setFreeFont(FSS12);
+      break;
+    case 18:
+      tftDisplay.setFreeFont(FSS18);
+      break;
+    case 24:
+      tftDisplay.setFreeFont(FSS24); // was FSS18
+      break;
+    default:
+      tftDisplay.setFreeFont(FSS12);
+      break;
+  }
+  tftDisplay.setTextDatum(TL_DATUM);
+  fontHeight = tftDisplay.fontHeight(GFXFF);
+  fontWidth = tftDisplay.textWidth("X");
+}
+//
+// COMMON FUNCTION DEFINITIONS
+// these functions could be used as is in other applications
+// or at least are not specific to pyrometer functions
+//
+
+//
+// convert temperature from C to F
+//
+float CtoFAbsolute(float tempC)
+{
+  return (tempC * 1.8) + 32; 
+}
+//
+// convert temperature difference from C to F
+//
+float CtoFRelative(float tempC)
+{
+  return (tempC * 1.8); 
+}
+//
+// convert temperature from C to F
+//
+float FtoCAbsolute(float tempF)
+{
+  return (tempF - 32) / 1.8; 
+}
+//
+// convert temperature difference from C to F
+//
+float FtoCRelative(float tempF)
+{
+  return tempF / 1.8; 
+}
+//
+// returns true if time is PM (for 12 hour display)
+// requires RTC
+//
+bool RTC_IsPM()
+{
+  DateTime now;
+  now = Clock_Now();
+  return now.isPM();
+}
+//
+// get HH:MM from RTC time into buf (RTC_STRING_SIZE), returns buf
+// requires RTC
+//
+char* RTC_GetStringTime(char* buf, int bufSize)
+{
+  DateTime now;
+  now = Clock_Now();
+	int hour = now.hour();
+	int minute = now.minute();
+  bool isPM = now.isPM();
+  if(deviceSettings.is12Hour)
+  {
+    if(isPM)
+    {
+      if(hour > 12)
+      {
+        hour -= 12;
+      }
+    } 
+  }
+  if(deviceSettings.is12Hour)
+  {
+    snprintf(buf, bufSize, "%02d:%02d%s", hour, minute, ampmStr[isPM ? 1 : 0]);
+  }
+  else
+  {
+    if((isPM) && (hour < 12))
+    {
+      hour += 12;
+    }
+    snprintf(buf, bufSize, "%02d:%02d", hour, minute);
+  }
+  return buf;
+}
+//
+// get MM/DD/YYYY from RTC date into buf (RTC_STRING_SIZE), returns buf
+// requires RTC
+//
+char* RTC_GetStringDate(char* buf, int bufSize)
+{
+	DateTime now;
+  now = Clock_Now();
+  int year = now.year();
+  int month = now.month();
+  int day = now.day();
+  snprintf(buf, bufSize, "%02d/%02d/%02d", month, day, year);
+  return buf;
+}
+//
+// Set date time
+// pass in a year, month, date, hour, minute, second as integer values
+//
+void RTC_SetDateTime(int year, int month, int date, int hour, int minute, int second)
+{
+  rtc.adjust(DateTime(year, month, date, hour, minute, second));
+  Clock_Sync();
+}
+//
+// Set date time
+// pass in a DateTime structure
+//
+void RTC_SetDateTime(DateTime timeVal)
+{
+  rtc.adjust(timeVal);
+  Clock_Sync();
+}
+//
+// get time from RTC
+// make it easier to change RTC modules if libraries need
+// different calls
+// return as a DateTime structure
+//
+DateTime RTC_GetDateTime()
+{
+  return rtc.now();
+}
+//
+// any initialization required for RTC module, return TRUE for sucess, FALSE for fail
+//
+bool RTC_Setup()
+{
+  bool rVal = rtc.begin();
+  // When the RTC was stopped and stays connected to the battery, it has
+  // to be restarted by clearing the STOP bit. Let's do this to ensure
+  // the RTC is running.
+  #ifdef RTC_8563
+  if(rVal) 
+  {
+    rtc.start();
+  };
+  #endif
+  #ifdef RTC_SQW_PIN
+  if(rVal)
+  {
+    // 1 Hz square wave, falling edge at each seconds rollover (open drain, needs pullup)
+    rtc.writeSqwPinMode(DS3231_SquareWave1Hz);
+    pinMode(RTC_SQW_PIN, INPUT_PULLUP);
+    attachInterrupt(RTC_SQW_PIN, Clock_SqwISR, FALLING);
+  }
+  #endif
+  return rVal;
+}
+//
+// sync cached clock from RTC - polls until the RTC seconds roll over so the
+// millis() reference is on a seconds boundary, up to 1 second of I2C reads
+// requires RTC
+//
+void Clock_Sync()
+{
+  DateTime first = RTC_GetDateTime();
+  DateTime now = first;
+  unsigned long startMs = millis();
+  while((now.unixtime() == first.unixtime()) && (millis() - startMs < 1100))
+  {
+    vTaskDelay(pdMS_TO_TICKS(5));
+    now = RTC_GetDateTime();
+  }
+  clockState.syncEpoch = now.unixtime();
+  clockState.syncMs = millis();
+  clockState.checkMs = clockState.syncMs;
+  clockState.edgeMs = 0;
+  clockState.synced = true;
+}
+//
+// compare cached clock to RTC every CLOCK_CHECK_MS (one I2C read), call when idle
+// pulls the cached clock back inside the RTC second it reads
+// requires RTC
+//
+void Clock_Check()
+{
+  if(!clockState.synced || (millis() - clockState.checkMs < CLOCK_CHECK_MS))
+  {
+    return;
+  }
+  clockState.checkMs = millis();
+  uint64_t rtcMs = (uint64_t)RTC_GetDateTime().unixtime() * 1000;
+  uint64_t clockMs = Clock_EpochMs();
+  #ifdef RTC_SQW_PIN
+  // phase comes from SQW edges, only whole seconds can be off
+  // skip just after a rollover where the RTC read and clock may straddle the edge
+  int32_t secondsOff = (int32_t)(rtcMs / 1000) - (int32_t)(clockMs / 1000);
+  if((secondsOff != 0) && (clockMs % 1000 > 20))
+  {
+    clockState.syncEpoch += secondsOff;
+  }
+  #else
+  if(clockMs < rtcMs)
+  {
+    clockState.syncMs -= (unsigned long)(rtcMs - clockMs);
+  }
+  else if(clockMs >= rtcMs + 1000)
+  {
+    clockState.syncMs += (unsigned long)(clockMs - (rtcMs + 999));
+  }
+  #endif
+  #ifdef DEBUG_VERBOSE
+  Serial.printf("clock check rtc %llu clock %llu\n", rtcMs, clockMs);
+  #endif
+}
+//
+// current time in unix epoch milliseconds, no bus traffic
+// extrapolated from the last sync with millis(), re-phased at each SQW edge when RTC_SQW_PIN is wired
+//
+uint64_t Clock_EpochMs()
+{
+  unsigned long nowMs = millis();
+  if(!clockState.synced)
+  {
+    return nowMs;
+  }
+  unsigned long edgeMs = clockState.edgeMs;
+  unsigned long sinceSync = edgeMs - clockState.syncMs;
+  if((edgeMs != 0) && (sinceSync < 0x80000000UL) && (nowMs - edgeMs < 0x80000000UL))
+  {
+    // edges fall on seconds rollovers, missed edges (light sleep) just round away
+    uint32_t edgeEpoch = clockState.syncEpoch + ((sinceSync + 500) / 1000);
+    return ((uint64_t)edgeEpoch * 1000) + (nowMs - edgeMs);
+  }
+  return ((uint64_t)clockState.syncEpoch * 1000) + (nowMs - clockState.syncMs);
+}
+//
+// current time as a DateTime from the cached clock
+//
+DateTime Clock_Now()
+{
+  return DateTime((uint32_t)(Clock_EpochMs() / 1000));
+}
+//
+// format epoch ms as HH:MM:SS(am/pm) MM/DD/YYYY (RECORD_TIME_SIZE), returns buf
+//
+char* Clock_FormatEpoch(uint64_t epochMs, char* buf, int bufSize)
+{
+  DateTime timeVal((uint32_t)(epochMs / 1000));
+  if(deviceSettings.is12Hour)
+  {
+    snprintf(buf, bufSize, "%02d:%02d:%02d%s %02d/%02d/%04d", timeVal.twelveHour(), timeVal.minute(), timeVal.second(),
+                                                        ampmStr[timeVal.isPM() ? 1 : 0],
+                                                        timeVal.month(), timeVal.day(), timeVal.year());
+  }
+  else
+  {
+    snprintf(buf, bufSize, "%02d:%02d:%02d %02d/%02d/%04d", timeVal.hour(), timeVal.minute(), timeVal.second(),
+                                                      timeVal.month(), timeVal.day(), timeVal.year());
+  }
+  return buf;
+}
+//
+// DS3231 SQW falling edge, once per second
+//
+void IRAM_ATTR Clock_SqwISR()
+{
+  clockState.edgeMs = millis();
+}
+//
+// read probe temp in display units, sets thermoFault
+// returns -100 on a fault, a missing amplifier is retried every THERMO_RETRY_MS
+//
+float Thermo_GetTemp()
+{
+  if(!thermoPresent && (millis() - thermoRetryMs >= THERMO_RETRY_MS))
+  {
+    thermoRetryMs = millis();
+    Thermo_Begin();
+  }
+  if(!thermoPresent)
+  {
+    thermoFault = THERMO_NO_AMP;
+    return -100.0F;
+  }
+  //float temperature = tempSensor.getThermocoupleTemp();
+  uint32_t probeStart = Probe_Start();
+  float temperature = tempSensor.readThermocouple();
+  #ifdef THERMO_MCP9601
+  uint8_t status = tempSensor.getStatus();
+  #endif
+  Probe_Stop(PROBE_THERMO_READ, probeStart);
+  thermoHotC = temperature;
+  thermoStatus = 0;
+  thermoFault = THERMO_OK;
+  #ifdef THERMO_MCP9601
+  thermoStatus = status;
+  // open/short detection, reported right away instead of waiting for a reading that never settles
+  if(status & MCP9601_STATUS_OPENCIRCUIT)
+  {
+    thermoFault = THERMO_OPEN;
+  }
+  else if(status & MCP9601_STATUS_SHORTCIRCUIT)
+  {
+    thermoFault = THERMO_SHORT;
+  }
+  #endif
+  if((thermoFault == THERMO_OK) && isnan(temperature))
+  {
+    thermoFault = THERMO_NO_READ;
+  }
+  if(thermoFault != THERMO_OK)
+  {
+    return -100.0F;
+  }
+  // probe calibration, thermoHotC stays raw
+  temperature = Cal_Apply(calTable, temperature);
+  // convert to F if required
+  if(deviceSettings.tempUnits == 0)
+  {
+    temperature = CtoFAbsolute(temperature);
+  }
+  return temperature;
+}
+//
+// find and configure the amplifier, THERMO_BEGIN_TRIES attempts
+// without it boot carries on and Thermo_GetTemp keeps trying
+//
+void Thermo_Setup()
+{
+  char outStr[256];
+  #ifdef THERMO_ALERT_PIN
+  // open drain alert output, needs pullup
+  pinMode(THERMO_ALERT_PIN, INPUT_PULLUP);
+  attachInterrupt(THERMO_ALERT_PIN, Thermo_AlertISR, FALLING);
+  #endif
+  for(int tryIdx = 0; (tryIdx < THERMO_BEGIN_TRIES) && !Thermo_Begin(); tryIdx++)
+  {
+    vTaskDelay(pdMS_TO_TICKS(100));
+  }
+  thermoRetryMs = millis();
+  if(thermoPresent)
+  {
+    #ifdef DEBUG_VERBOSE
+    Serial.println("Thermocouple acknowledged");
+    #endif
+    BootLog("Thermocouple acknowledged");
+  }
+  else 
+  {
+    #ifdef DEBUG_VERBOSE
+    Serial.println("Thermocouple did not acknowledge");
+    #endif
+    BootLog("Thermocouple did not acknowledge");
+    return;
+  }
+  Serial.print("ADC resolution set to ");
+  switch (tempSensor.getADCresolution()) 
+  {
+    case MCP9600_ADCRESOLUTION_18:   
+      Serial.print("18"); 
+      break;
+    case MCP9600_ADCRESOLUTION_16:   
+      Serial.print("16"); 
+      break;
+    case MCP9600_ADCRESOLUTION_14:   
+      Serial.print("14"); 
+      break;
+    case MCP9600_ADCRESOLUTION_12:   
+      Serial.print("12"); 
+      break;
+  }
+  Serial.println(" bits");
+   //make sure the type was set correctly!
+  switch(tempSensor.getThermocoupleType())
+  {
+    case MCP9600_TYPE_K:
+      sprintf(outStr,"Type K ");
+      break;
+    case MCP9600_TYPE_J:
+      sprintf(outStr,"Thermocouple set failed (Type J");
+      break;
+    case MCP9600_TYPE_T:
+      sprintf(outStr,"Thermocouple set failed (Type T");
+      break;
+    case MCP9600_TYPE_N:
+      sprintf(outStr,"Thermocouple set failed (Type N");
+      break;
+    case MCP9600_TYPE_S:
+      sprintf(outStr,"Thermocouple set failed (Type S");
+      break;
+    case MCP9600_TYPE_E:
+      sprintf(outStr,"Thermocouple set failed (Type E");
+      break;
+    case MCP9600_TYPE_B:
+      sprintf(outStr,"Thermocouple set failed (Type B");
+      break;
+    case MCP9600_TYPE_R:
+      sprintf(outStr,"Thermocouple set failed (Type R");
+      break;
+    default:
+      sprintf(outStr,"Thermocouple set failed (unknown type");
       break;
-    }
-    Serial.println(buf);
   }
-  Serial.println("Done");
-  fileIn.close();
-  #endif
+  Serial.println(outStr);
+  BootLog(outStr);
 
+  sprintf(outStr,"Temp: C: %0.2FC/%0.2FF H: %0.2FC/%0.2FF",tempSensor.readAmbient(), CtoFAbsolute(tempSensor.readAmbient()),
+                                                           tempSensor.readThermocouple(), CtoFAbsolute(tempSensor.readThermocouple()));
+  BootLog(outStr);
 }
 //
-// write current measurement to by car results file
-// (easier than trying to sore the results while writing the HTML....)
-//
-void WriteMeasurementFile()
-{
-  char outStr[255];
-  #ifdef HAS_RTC
-  String curTimeStr;
-  curTimeStr = RTC_GetStringTime();
-  strcpy(cars[selectedCar].dateTime, curTimeStr.c_str());
-  curTimeStr += " ";
-  curTimeStr += RTC_GetStringDate();
-  sprintf(outStr, "%s;%s;%d;%d", curTimeStr.c_str(), 
-                                 cars[selectedCar].carName,
-                                 cars[selectedCar].tireCount, 
-                                 cars[selectedCar].positionCount);
-  #else
-  sprintf(outStr, "%d;%s;%d;%d", millis(), 
-                                 cars[selectedCar].carName, 
-                                 cars[selectedCar].tireCount, 
-                                 cars[selectedCar].positionCount);
-  #endif
-  // find file to write
-  String fileLine = outStr;
-  for(int idxTire = 0; idxTire < cars[selectedCar].tireCount; idxTire++)
-  {
-    for(int idxPosition = 0; idxPosition < cars[selectedCar].positionCount; idxPosition++)
-    {
-      fileLine += ';';
-      fileLine += tireTemps[(idxTire * cars[selectedCar].positionCount) + idxPosition];
-    }
-  }
-  for(int idxTire = 0; idxTire < cars[selectedCar].tireCount; idxTire++)
-  {
-    fileLine += ';';
-    fileLine += cars[selectedCar].tireShortName[idxTire];
-  }
-  for(int idxPosition = 0; idxPosition < cars[selectedCar].positionCount; idxPosition++)
-  {
-    fileLine += ';';
-    fileLine += cars[selectedCar].positionShortName[idxPosition];
-  }
-  for(int idxTire = 0; idxTire < cars[selectedCar].tireCount; idxTire++)
-  {
-    fileLine += ';';
-    fileLine += cars[selectedCar].maxTemp[idxTire];
-  }
-  sprintf(outStr, "/py_temps_%d.txt", cars[selectedCar].carID);
-  AppendFile(SD, outStr, fileLine.c_str());
-}
-//
-// parse measurement file (single read of all tires/positions)
-//
-void ReadMeasurementFile(char buf[], CarSettings &currentResultCar)
-{
-  int tokenIdx = 0;
-  int measureIdx = 0;
-  int tireIdx = 0;
-  int positionIdx = 0;
-  int tempCnt = 0;
-  int maxTempIdx = 0;
-  int measureRange[2] = {99, 99};
-  int tireNameRange[2] = {99, 99};
-  int posNameRange[2] = {99, 99};
-  int maxTempRange[2] = {99, 99};
-  char* token;
-  // parse the current line and add to a measurment structure for display
-  token = strtok(buf, ";");
-  while(token != NULL)
-  {
-    // tokenIdx 0 is date/time
-    // 0 - timestamp
-    if(tokenIdx == 0)
-    {
-      strcpy(currentResultCar.dateTime, token);
-    }
-    // 1 - car info
-    if(tokenIdx == 1)
-    {
-      strcpy(currentResultCar.carName, token);
-    }
-    // 2 - tire count
-    else if(tokenIdx == 2)
-    {
-      currentResultCar.tireCount = atoi(token);
-    }
-    // 3 - position count
-    else if(tokenIdx == 3)
-    {
-      currentResultCar.positionCount = atoi(token);
-      tempCnt = currentResultCar.tireCount * currentResultCar.positionCount;
-      measureRange[0]  = tokenIdx + 1;  // measurements start at next token
-      measureRange[1]  = measureRange[0] +  (currentResultCar.tireCount *  currentResultCar.positionCount) - 1;
-      tireNameRange[0] = measureRange[1];                                                                     
-      tireNameRange[1] = tireNameRange[0] + currentResultCar.tireCount;                                       
-      posNameRange[0]  = tireNameRange[1];                                                                    
-      posNameRange[1]  = posNameRange[0] + currentResultCar.positionCount;                                    
-      maxTempRange[0]  = posNameRange[1];                                                                    
-      maxTempRange[1]  = maxTempRange[0] + currentResultCar.tireCount;                                   
-    }
-    // tire temps
-    else if((tokenIdx >= measureRange[0]) && (tokenIdx <= measureRange[1]))
-    {
-      tireTemps[measureIdx] = atof(token);
-      currentTemps[measureIdx] = tireTemps[measureIdx];
-      measureIdx++;
-    }
-    // tire names
-    else if((tokenIdx >= tireNameRange[0]) && (tokenIdx <= tireNameRange[1]))
-    {
-      strcpy(currentResultCar.tireShortName[tireIdx], token);
-      strcpy(currentResultCar.tireLongName[tireIdx], token);
-      tireIdx++;
-    }
-    // position names
-    else if((tokenIdx >= posNameRange[0]) && (tokenIdx <= posNameRange[1]))
-    {
-      strcpy(currentResultCar.positionShortName[positionIdx], token);
-      strcpy(currentResultCar.positionLongName[positionIdx], token);
-      positionIdx++;
-    }
-    // max temps
-    else if((tokenIdx >= maxTempRange[0]) && (tokenIdx <= maxTempRange[1]))
-    {
-      currentResultCar.maxTemp[maxTempIdx] = atof(token);
-      maxTempIdx++;
-    }
-    token = strtok(NULL, ";");
-    tokenIdx++;
-  }
-}
-
-// TIRE TEMPERATURE MEASUREMENT AND DISPLAY
-//
-// measure temperatures on a single tire
+// begin the amplifier and set 18 bit resolution, type K and the default filter
+// returns false (thermoPresent false, thermoFault THERMO_NO_AMP) if it does not acknowledge
 //
-int MeasureTireTemps(int tireIdx)
+bool Thermo_Begin()
 {
-  char outStr[512];
-  // location of text
-  textPosition[0] = 5;
-  textPosition[1] = 0;//fontHeight;
-
-  bool armed = false;
-  // measure location - O, M, I
-  measIdx = 0;  
-  // reset tire temps to 0.0
-  for(int idx = 0; idx < cars[selectedCar].positionCount; idx++)
-  {
-    tireTemps[(tireIdx * cars[selectedCar].positionCount) + idx] = 0.0;
-  }
-  armed = false;
-  unsigned long priorTime = millis();
-  unsigned long curTime = millis();
-  // text position on screen
-  // measuring until all positions are measured
-  bool drawStars = true;
-
-  while(measIdx < cars[selectedCar].positionCount)
+  thermoPresent = tempSensor.begin(I2C_ADDRESS_THERMO);
+  if(!thermoPresent)
   {
-    if(drawStars)
-    {
-      textPosition[1] = fontHeight;
-      sprintf(outStr,"%s %s        ",  cars[selectedCar].tireLongName[tireIdx],  cars[selectedCar].positionLongName[measIdx]);
-      tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);      
-      textPosition[1] += 2* fontHeight;
-
-      sprintf(outStr,"        ****                          ");
-      tftDisplay.setFreeFont(FSS24); // max font
-      tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);      
-      SetFont(deviceSettings.fontPoints);
-      drawStars = false;
-    }
-    // get time and process buttons for press/release
-    curTime = millis();
-    CheckButtons(curTime);
-    // button 0 release arms probe
-    // prior to arm, display ****, after display temp as it stabilizes
-    if (buttons[0].buttonReleased)
-    {
-      armed = true;
-      buttons[0].buttonReleased = false;
-    }
-    // check for button 1 or 2 release (tire selection) before measure starts
-    else if (((buttons[1].buttonReleased) || (buttons[2].buttonReleased))  && (measIdx == 0))
-    {
-
-      sprintf(outStr,"        ****        ");
-      tftDisplay.setFreeFont(FSS24); // max font
-      tftDisplay.drawString(outStr,textPosition[0], textPosition[1], GFXFF);      
-      SetFont(deviceSettings.fontPoints);
-    }
-    // if not armed continue
-    if(!armed)
-    {
-      curTime = millis();
-      continue;
-    }
-    // wait for stable temp after arming
-    tireTemps[(tireIdx * cars[selectedCar].positionCount) + measIdx] = GetStableTemp(measIdx, textPosition[0], textPosition[1]);
-    // disarm after stable temp
-    armed = false;
-    // next position
-    measIdx++;
-    drawStars = true;
+    thermoFault = THERMO_NO_AMP;
+    return false;
   }
-  Serial.println("Exit MeasureTireTemps");
-  return 1;
+  tempSensor.setADCresolution(MCP9600_ADCRESOLUTION_18);
+  tempSensor.setThermocoupleType(MCP9600_TYPE_K);
+  // amplifier was (re)started, filter and alerts are back at their power on values
+  thermoFilter = -1;
+  thermoAlertArmed = false;
+  Thermo_SetFilter(THERMO_FILTER_DEFAULT);
+  thermoFault = THERMO_OK;
+  return true;
 }
 //
-// display current probe temp until user cancels
+// set amplifier filter coefficient (0 off .. 7 heaviest), skipped if already set or no amplifier
 //
-void InstantTemp()
+void Thermo_SetFilter(int coefficient)
 {
-  unsigned long priorTime = 0;
-  unsigned long curTime = millis();
-  char outStr[128];
-  float instant_temp = 0.0;
-  // location of text
-  textPosition[0] = 5;
-  textPosition[1] = 0;
-  randomSeed(100);
-  tftDisplay.fillScreen(TFT_WHITE);
-  YamuraBanner();
-  SetFont(deviceSettings.fontPoints);
-  tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
-  sprintf(outStr, "Temperature at %s %s", RTC_GetStringTime(), RTC_GetStringDate());
-  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
-  textPosition[1] +=  fontHeight;
-  sprintf(outStr, " ");
-  SetFont(24);
-  textPosition[0] = tftDisplay.width()/2;
-  textPosition[1] = tftDisplay.height()/2;
-  tftDisplay.setTextDatum(TC_DATUM);
- 
-  while(true)
+  if(!thermoPresent || (coefficient == thermoFilter))
   {
-    curTime = millis();
-    if(curTime - priorTime > 1000)
-    {
-      textPosition[0] = 5;
-      textPosition[1] = 0;
-      SetFont(deviceSettings.fontPoints);
-      tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
-      sprintf(outStr, "Temperature at %s %s", RTC_GetStringTime(), RTC_GetStringDate());
-      tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
-      textPosition[1] +=  fontHeight;
-      sprintf(outStr, " ");
-      SetFont(24);
-      textPosition[0] = tftDisplay.width()/2;
-      textPosition[1] = tftDisplay.height()/2;
-      tftDisplay.setTextDatum(TC_DATUM);
-
-      priorTime = curTime;
-      // read temp
-      instant_temp = Thermo_GetTemp();
-      if(deviceSettings.tempUnits == 1)
-      {
-        instant_temp = FtoCAbsolute(instant_temp);
-      }
-      sprintf(outStr, "0000.00000");
-      tftDisplay.fillRect(textPosition[0], textPosition[1], tftDisplay.textWidth(outStr), fontHeight, TFT_WHITE);
-      sprintf(outStr, "%0.2f", instant_temp);
-      tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
-    }
-    CheckButtons(curTime);
-    // any button released, exit
-    if ((buttons[0].buttonReleased) || (buttons[1].buttonReleased) || (buttons[2].buttonReleased))
-    {
-      buttons[0].buttonReleased = false;
-      buttons[1].buttonReleased = false;
-      buttons[2].buttonReleased = false;
-      break;
-    }
+    return;
   }
-  SetFont(deviceSettings.fontPoints);
+  tempSensor.setFilterCoefficient(coefficient);
+  thermoFilter = coefficient;
+  #ifdef DEBUG_VERBOSE
+  Serial.print("Thermocouple filter coefficient value set to: ");
+  Serial.println(tempSensor.getFilterCoefficient());
+  #endif
 }
 //
-// draw grid for tire measurement (set up in SetupTireMeasureGrid)
+// arm or disarm the contact alert - comparator mode, active low, asserted while the hot junction
+// is THERMO_CONTACT_RISE above the cold junction (threshold set from ambient each time it is armed)
 //
-void DrawTireMeasureGrid(int tireCount)
+void Thermo_AlertArm(bool arm)
 {
-  // horizontal lines
-  int maxY = 0;
-  for(int idx = 0; idx <= (tireCount/2 + tireCount%2); idx++)
+  thermoAlertArmed = false;
+  #ifdef THERMO_ALERT_PIN
+  if(!thermoPresent)
   {
-    tftDisplay.drawWideLine(  gridLineH[idx][0][0], gridLineH[idx][0][1], gridLineH[idx][1][0], gridLineH[idx][1][1], 1, TFT_BLACK, TFT_WHITE);
-    maxY = gridLineH[idx][0][1];
+    return;
   }
-  // vertical Lines
-  for(int idx = 0; idx < 3; idx++)
+  if(arm)
   {
-    gridLineV[idx][1][1] = maxY;
-    tftDisplay.drawWideLine(  gridLineV[idx][0][0], gridLineV[idx][0][1], gridLineV[idx][1][0], gridLineV[idx][1][1], 1, TFT_BLACK, TFT_WHITE);
+    tempSensor.setAlertTemperature(THERMO_ALERT_NUM, tempSensor.readAmbient() + THERMO_CONTACT_RISE);
   }
+  // enable, rising, hot junction, active low, comparator (follows the temp, no latch to clear)
+  tempSensor.configureAlert(THERMO_ALERT_NUM, arm, true, false, false, false);
+  thermoAlertArmed = arm;
+  #endif
 }
 //
-// set up grid lines for tire measurement based on tire and position counts and font size
+// true while the armed contact alert output is asserted
 //
-void SetupTireMeasureGrid(int fontHeight)
+bool Thermo_AlertActive()
 {
-  SetFont(fontHeight <= 12 ? fontHeight : 12);
-	int gridHeight = tftDisplay.fontHeight(GFXFF);
-  // 4 horizontal grid lines
-  // x = 1 (start) 475 (end)
-  // at y = 
-  gridLineH[0][0][0] = 1;      gridLineH[0][0][1] = gridHeight +   10;
-  gridLineH[0][1][0] = 475;    gridLineH[0][1][1] = gridHeight +   10;
-  
-  gridLineH[1][0][0] = 1;      gridLineH[1][0][1] = gridHeight +   80;
-  gridLineH[1][1][0] = 475;    gridLineH[1][1][1] = gridHeight +   80;
-  
-  gridLineH[2][0][0] = 1;      gridLineH[2][0][1] = gridHeight +  150;
-  gridLineH[2][1][0] = 475;    gridLineH[2][1][1] = gridHeight +  150;
-  
-  gridLineH[3][0][0] = 1;      gridLineH[3][0][1] = gridHeight +  220;
-  gridLineH[3][1][0] = 475;    gridLineH[3][1][1] = gridHeight +  220;
-  
-  // 3 vertical grid lines
-  // at x = 
-  // 1
-  // 237
-  // 475
-  gridLineV[0][0][0] = 1;       gridLineV[0][0][1] = gridHeight +  10;
-  gridLineV[0][1][0] = 1;       gridLineV[0][1][1] = gridHeight + 220;
-  gridLineV[1][0][0] = 237;     gridLineV[1][0][1] = gridHeight +  10;
-  gridLineV[1][1][0] = 237;     gridLineV[1][1][1] = gridHeight + 220;
-  gridLineV[2][0][0] = 475;     gridLineV[2][0][1] = gridHeight +  10;
-  gridLineV[2][1][0] = 475;     gridLineV[2][1][1] = gridHeight + 220;
-  // V               V               V
-  // 0               1               2
-  // ==G0===============G1============  H0
-  // | 0,0  0,1  0,2 | 0,5  0,4  0,3 |
-  // | 1,0  1,1  1,2 | 1,5  1,4  1,3 |
-  // ==G2===============G3============  H1
-  // | 2,0  2,1  2,2 | 2,5  2,4  2,3 |
-  // | 3,0  3,1  3,2 | 3,5  3,4  3,3 |
-  // ==G4===============G5============  H2
-  // | 4,0  4,1  4,2 | 4,5  4,4  4,3 |
-  // | 5,0  5,1  5,2 | 5,5  5,4  5,3 |
-  // =================================  H3
-  //               DONE
-  //  
-  //
-  // 36 text locations in grid boxes
-  // not that cell order in col 1 is reversed so measure order matches orientation on car
-  //
-  // grid row 0
-  // cell row 0
-  cellPoint[0][0][0] = gridLineV[0][0][0] +   5;              cellPoint[0][0][1] = gridLineH[0][0][1] + 5;
-  cellPoint[0][1][0] = gridLineV[0][0][0] +  75;              cellPoint[0][1][1] = gridLineH[0][0][1] + 5;
-  cellPoint[0][2][0] = gridLineV[0][0][0] + 145;              cellPoint[0][2][1] = gridLineH[0][0][1] + 5;
-  cellPoint[0][3][0] = gridLineV[1][0][0] + 145;              cellPoint[0][3][1] = gridLineH[0][0][1] + 5;
-  cellPoint[0][4][0] = gridLineV[1][0][0] +  75;              cellPoint[0][4][1] = gridLineH[0][0][1] + 5;
-  cellPoint[0][5][0] = gridLineV[1][0][0] +   5;              cellPoint[0][5][1] = gridLineH[0][0][1] + 5;
-  // cell row 1
-  cellPoint[1][0][0] = gridLineV[0][0][0] +   5;              cellPoint[1][0][1] = gridLineH[0][0][1] + gridHeight + 5;
-  cellPoint[1][1][0] = gridLineV[0][0][0] +  75;              cellPoint[1][1][1] = gridLineH[0][0][1] + gridHeight + 5;
-  cellPoint[1][2][0] = gridLineV[0][0][0] + 145;              cellPoint[1][2][1] = gridLineH[0][0][1] + gridHeight + 5;
-  cellPoint[1][3][0] = gridLineV[1][0][0] + 145;              cellPoint[1][3][1] = gridLineH[0][0][1] + gridHeight + 5;
-  cellPoint[1][4][0] = gridLineV[1][0][0] +  75;              cellPoint[1][4][1] = gridLineH[0][0][1] + gridHeight + 5;
-  cellPoint[1][5][0] = gridLineV[1][0][0] +   5;              cellPoint[1][5][1] = gridLineH[0][0][1] + gridHeight + 5;
-  // grid row 1
-  // cell row 2
-  cellPoint[2][0][0] = gridLineV[0][0][0] +   5;              cellPoint[2][0][1] = gridLineH[1][0][1] + 5;
-  cellPoint[2][1][0] = gridLineV[0][0][0] +  75;              cellPoint[2][1][1] = gridLineH[1][0][1] + 5;
-  cellPoint[2][2][0] = gridLineV[0][0][0] + 145;              cellPoint[2][2][1] = gridLineH[1][0][1] + 5;
-  cellPoint[2][3][0] = gridLineV[1][0][0] + 145;              cellPoint[2][3][1] = gridLineH[1][0][1] + 5;
-  cellPoint[2][4][0] = gridLineV[1][0][0] +  75;              cellPoint[2][4][1] = gridLineH[1][0][1] + 5;
-  cellPoint[2][5][0] = gridLineV[1][0][0] +   5;              cellPoint[2][5][1] = gridLineH[1][0][1] + 5;
-  // cell row 3
-  cellPoint[3][0][0] = gridLineV[0][0][0] +   5;              cellPoint[3][0][1] = gridLineH[1][0][1] + gridHeight + 5;
-  cellPoint[3][1][0] = gridLineV[0][0][0] +  75;              cellPoint[3][1][1] = gridLineH[1][0][1] + gridHeight + 5;
-  cellPoint[3][2][0] = gridLineV[0][0][0] + 145;              cellPoint[3][2][1] = gridLineH[1][0][1] + gridHeight + 5;
-  cellPoint[3][3][0] = gridLineV[1][0][0] + 145;              cellPoint[3][3][1] = gridLineH[1][0][1] + gridHeight + 5;
-  cellPoint[3][4][0] = gridLineV[1][0][0] +  75;              cellPoint[3][4][1] = gridLineH[1][0][1] + gridHeight + 5;
-  cellPoint[3][5][0] = gridLineV[1][0][0] +   5;              cellPoint[3][5][1] = gridLineH[1][0][1] + gridHeight + 5;
-  // grid row 2
-  // cell row 4
-  cellPoint[4][0][0] = gridLineV[0][0][0] +   5;              cellPoint[4][0][1] = gridLineH[2][0][1] + 5;
-  cellPoint[4][1][0] = gridLineV[0][0][0] +  75;              cellPoint[4][1][1] = gridLineH[2][0][1] + 5;
-  cellPoint[4][2][0] = gridLineV[0][0][0] + 145;              cellPoint[4][2][1] = gridLineH[2][0][1] + 5;
-  cellPoint[4][3][0] = gridLineV[1][0][0] + 145;              cellPoint[4][3][1] = gridLineH[2][0][1] + 5;
-  cellPoint[4][4][0] = gridLineV[1][0][0] +  75;              cellPoint[4][4][1] = gridLineH[2][0][1] + 5;
-  cellPoint[4][5][0] = gridLineV[1][0][0] +   5;              cellPoint[4][5][1] = gridLineH[2][0][1] + 5;
-  // cell row 5
-  cellPoint[5][0][0] = gridLineV[0][0][0] +   5;              cellPoint[5][0][1] = gridLineH[2][0][1] + gridHeight + 5;
-  cellPoint[5][1][0] = gridLineV[0][0][0] +  75;              cellPoint[5][1][1] = gridLineH[2][0][1] + gridHeight + 5;
-  cellPoint[5][2][0] = gridLineV[0][0][0] + 145;              cellPoint[5][2][1] = gridLineH[2][0][1] + gridHeight + 5;
-  cellPoint[5][3][0] = gridLineV[1][0][0] + 145;              cellPoint[5][3][1] = gridLineH[2][0][1] + gridHeight + 5;
-  cellPoint[5][4][0] = gridLineV[1][0][0] +  75;              cellPoint[5][4][1] = gridLineH[2][0][1] + gridHeight + 5;
-  cellPoint[5][5][0] = gridLineV[1][0][0] +   5;              cellPoint[5][5][1] = gridLineH[2][0][1] + gridHeight + 5;
-  // cell row 6
-  cellPoint[6][0][0] = gridLineV[0][0][0] +   5;              cellPoint[6][0][1] = gridLineH[3][0][1] + gridHeight + 10;
-  cellPoint[6][1][0] = gridLineV[0][0][0] +  75;              cellPoint[6][1][1] = gridLineH[3][0][1] + gridHeight + 10;
-  cellPoint[6][2][0] = gridLineV[0][0][0] + 145;              cellPoint[6][2][1] = gridLineH[3][0][1] + gridHeight + 10;
-  cellPoint[6][3][0] = gridLineV[1][0][0] + 145;              cellPoint[6][3][1] = gridLineH[3][0][1] + gridHeight + 10;
-  cellPoint[6][4][0] = gridLineV[1][0][0] +  75;              cellPoint[6][4][1] = gridLineH[3][0][1] + gridHeight + 10;
-  cellPoint[6][5][0] = gridLineV[1][0][0] +   5;              cellPoint[6][5][1] = gridLineH[3][0][1] + gridHeight + 10;
-
-  SetFont(fontHeight);
+  #ifdef THERMO_ALERT_PIN
+  return thermoAlertArmed && (digitalRead(THERMO_ALERT_PIN) == LOW);
+  #else
+  return false;
+  #endif
 }
 //
-// show all values for last measurement
+// after arming, sleep until the probe touches the tire (contact alert) or select starts it by hand
+// a probe still hot from the last position must leave the tire (alert off) first, so sampling does
+// not start on a probe cooling in the air, status text is drawn at row
+// returns false if cancelled with up/down, true right away without THERMO_ALERT_PIN or amplifier
 //
-void DisplayAllTireTemps(CarSettings currentResultCar)
+bool Thermo_WaitContact(int row)
 {
-  unsigned long curTime = millis();
-  unsigned long priorTime = millis();
-  // location of text
-  textPosition[0] = 5;
-  textPosition[1] = 0;
-  int row = 0;
-  int col = 0;
-  char outStr[255];
-  char padStr[3];
-  float maxTemp = 0.0F;
-  float minTemp = 999.0F;
-  // initial clear of screen
-  tftDisplay.fillScreen(TFT_WHITE);
-  YamuraBanner();
-  DrawTireMeasureGrid(currentResultCar.tireCount);
-
-  sprintf(outStr, "%s %s", currentResultCar.carName, currentResultCar.dateTime);
-  SetFont(deviceSettings.fontPoints <= 12 ? deviceSettings.fontPoints : 12);
-  tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
-  tftDisplay.drawString(outStr, 5, 0, GFXFF);
-
-  for(int idxTire = 0; idxTire < currentResultCar.tireCount; idxTire++)
+  #ifdef THERMO_ALERT_PIN
+  Thermo_AlertArm(true);
+  if(!thermoAlertArmed)
   {
-    // get min/max temps
-    maxTemp = 0.0F;
-    for(int tirePosIdx = 0; tirePosIdx < currentResultCar.positionCount; tirePosIdx++)
-    {
-      maxTemp = tireTemps[(idxTire * currentResultCar.positionCount) + tirePosIdx] > maxTemp ? tireTemps[(idxTire * currentResultCar.positionCount) + tirePosIdx] : maxTemp;
-      minTemp = tireTemps[(idxTire * currentResultCar.positionCount) + tirePosIdx] < minTemp ? tireTemps[(idxTire * currentResultCar.positionCount) + tirePosIdx] : minTemp;
-    }    
-	for(int tirePosIdx = 0; tirePosIdx < currentResultCar.positionCount; tirePosIdx++)
-    {
-      // draw tire position name
-      row = ((idxTire / 2) * 2);
-      col = tirePosIdx + ((idxTire % 2) * 3);
-      if(tireTemps[(idxTire * currentResultCar.positionCount) + tirePosIdx] >= 100.0F)
-      {
-        padStr[0] = '\0';
-      }
-      else if(tireTemps[(idxTire * currentResultCar.positionCount) + tirePosIdx] >= 10.0F)
-      {
-        sprintf(padStr, " ");
-      }
-      else
-      {
-        sprintf(padStr, "  ");
-      }
-      if(tirePosIdx == 0)
-      {
-        sprintf(outStr, "%s %s", currentResultCar.tireShortName[idxTire],
-                                 currentResultCar.positionShortName[tirePosIdx]);
-      }
-      else
-      {
-        sprintf(outStr, "%s", currentResultCar.positionShortName[tirePosIdx]);
-      }
-	  // tire name, position
-      DrawCellText(row, col, outStr, TFT_BLACK, TFT_WHITE);
-      row++;
-      sprintf(outStr, "%3.1F", tireTemps[(idxTire * currentResultCar.positionCount) + tirePosIdx]);
-      if(tireTemps[(idxTire * currentResultCar.positionCount) + tirePosIdx] == maxTemp)
-      {
-        DrawCellText(row, col, outStr, TFT_BLACK, TFT_RED);
-      }
-      else if(tireTemps[(idxTire * currentResultCar.positionCount) + tirePosIdx] == minTemp)
-      {
-        DrawCellText(row, col, outStr, TFT_BLACK, TFT_BLUE);
-      }
-      else
-      {
-        DrawCellText(row, col, outStr, TFT_BLACK, TFT_WHITE);
-      }
-    }
+    return true;
   }
-  priorTime = curTime;
-  while(true)
+  bool isContact = true;
+  bool lifted = !Thermo_AlertActive();
+  tftDisplay.drawString(lifted ? "Touch probe to tire (select to start)    " : "Lift probe from tire (select to start)   ",
+                        textPosition[0], row, GFXFF);
+  while(!lifted || !Thermo_AlertActive())
   {
-    curTime = millis();
-    CheckButtons(curTime);
-    // select button released, go to next tire
-    if (buttons[0].buttonReleased)
+    if(!lifted && !Thermo_AlertActive())
     {
-      buttons[0].buttonReleased = false;
-      break;
+      lifted = true;
+      tftDisplay.drawString("Touch probe to tire (select to start)    ", textPosition[0], row, GFXFF);
     }
-    // cancel button released, return
-    else if (buttons[1].buttonReleased)
+    CheckButtons(millis());
+    if(buttons[0].buttonReleased)
     {
-      buttons[1].buttonReleased = false;
+      buttons[0].buttonReleased = false;
       break;
     }
-    else if ((buttons[2].buttonReleased) || (buttons[3].buttonReleased)) 
+    if(buttons[1].buttonReleased || buttons[2].buttonReleased)
     {
+      buttons[1].buttonReleased = false;
       buttons[2].buttonReleased = false;
+      isContact = false;
+      break;
     }
-    delay(50);
+    // light sleeps, the alert level (contact, or lift while still hot) or a button wakes it
+    thermoAlertWake = lifted ? LOW : HIGH;
+    WaitButtonEvent(lifted ? THERMO_CONTACT_POLL : THERMO_LIFT_POLL);
   }
+  thermoAlertWake = LOW;
+  tftDisplay.drawString("                                         ", textPosition[0], row, GFXFF);
+  #ifdef DEBUG_VERBOSE
+  Serial.printf("contact wait %s, alert edge %lu ms ago\n", isContact ? "done" : "cancelled", millis() - thermoAlertMs);
+  #endif
+  Thermo_AlertArm(false);
+  return isContact;
+  #else
+  return true;
+  #endif
 }
 //
-// measure all tires/positions until Done selected
+// contact alert edge - queued as an edge on the alert pin so a waiting WaitButtonEvent returns
+// (CheckButtons drops it, no button has that pin)
 //
-void MeasureAllTireTemps()
+void IRAM_ATTR Thermo_AlertISR()
 {
-  unsigned long curTime = millis();
-  unsigned long priorTime = millis();
-  char outStr[255];
-  char padStr[3];
-  int selTire = 0;
-  bool startMeasure = false;
-  bool measureDone = false;
-  int row = 0;
-  int col = 0;
-
-  float maxTemp = 0.0F;
-  float minTemp = 999.0F;
-  // initial clear of screen
-  for(int idxTire = 0; idxTire < cars[selectedCar].tireCount; idxTire++)
+  #ifdef THERMO_ALERT_PIN
+  ButtonEdge edge;
+  BaseType_t taskWoken = pdFALSE;
+  thermoAlertMs = millis();
+  edge.buttonPin = THERMO_ALERT_PIN;
+  edge.level = LOW;
+  edge.edgeTime = thermoAlertMs;
+  if(buttonQueue != NULL)
   {
-    for(int tirePosIdx = 0; tirePosIdx < cars[selectedCar].positionCount; tirePosIdx++)
-    {
-      tireTemps[(idxTire * cars[selectedCar].positionCount) + tirePosIdx] = 0.0F;
-    }
+    xQueueSendFromISR(buttonQueue, &edge, &taskWoken);
   }
-
-  tftDisplay.fillScreen(TFT_WHITE);
-  YamuraBanner();
-  SetFont(deviceSettings.fontPoints);
-  while(true)
+  if(taskWoken)
   {
-    //sprintf(outStr, "%s", cars[selectedCar].carName);
-    tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
-    //tftDisplay.drawString(outStr, 5, 0, GFXFF);
-
-    if(!startMeasure)
+    portYIELD_FROM_ISR();
+  }
+  #endif
+}
+//
+// button interrupts on both edges, edges queued for CheckButtons to debounce
+//
+void ButtonSetup()
+{
+  buttonQueue = xQueueCreate(BUTTON_QUEUE_SIZE, sizeof(ButtonEdge));
+  for(int idx = 0; idx < BUTTON_COUNT; idx++)
+  {
+    pinMode(buttons[idx].buttonPin, INPUT_PULLUP);
+    // up/down repeat while held, select does not
+    buttons[idx].autoRepeat = (idx != BUTTON_1);
+    attachInterruptArg(buttons[idx].buttonPin, ButtonISR, (void*)(uintptr_t)buttons[idx].buttonPin, CHANGE);
+  }
+}
+//
+// button edge interrupt - pin is passed as arg since RotateDisplay swaps pins between buttons
+//
+void IRAM_ATTR ButtonISR(void* arg)
+{
+  ButtonEdge edge;
+  BaseType_t taskWoken = pdFALSE;
+  edge.buttonPin = (uint8_t)(uintptr_t)arg;
+  edge.level = gpio_get_level((gpio_num_t)edge.buttonPin);
+  edge.edgeTime = millis();
+  xQueueSendFromISR(buttonQueue, &edge, &taskWoken);
+  if(taskWoken)
+  {
+    portYIELD_FROM_ISR();
+  }
+}
+//
+// check all buttons for new press or release
+// queued edges are debounced in order, then current pin state is checked to catch a bounce that
+// settled after its last edge, and to generate long press and auto-repeat for held buttons
+//
+void CheckButtons(unsigned long curTime)
+{
+  ButtonEdge edge;
+  while((buttonQueue != NULL) && (xQueueReceive(buttonQueue, &edge, 0) == pdTRUE))
+  {
+    for(int btnIdx = 0; btnIdx < BUTTON_COUNT; btnIdx++)
     {
-      // tires
-      for(int idxTire = 0; idxTire < cars[selectedCar].tireCount; idxTire++)
-      {
-        // tires
-        col = (idxTire % 2);
-        maxTemp = 0.0F;
-        minTemp = 999.0F;
-        for(int tirePosIdx = 0; tirePosIdx < cars[selectedCar].positionCount; tirePosIdx++)
-        {
-          maxTemp = tireTemps[(idxTire * cars[selectedCar].positionCount) + tirePosIdx] > maxTemp ? tireTemps[(idxTire * cars[selectedCar].positionCount) + tirePosIdx] : maxTemp;
-          minTemp = tireTemps[(idxTire * cars[selectedCar].positionCount) + tirePosIdx] < minTemp ? tireTemps[(idxTire * cars[selectedCar].positionCount) + tirePosIdx] : minTemp;
-        }
-      }
-      // do measurements for tire
-      if(selTire < cars[selectedCar].tireCount)
+      if(buttons[btnIdx].buttonPin == edge.buttonPin)
       {
-        int nextDirection = MeasureTireTemps(selTire);
-        selTire = GetNextTire(selTire, nextDirection);
-        if(selTire ==  cars[selectedCar].tireCount)
-        {
-          break;
-        }
-        continue;
+        UpdateButton(btnIdx, ButtonState(edge.level), edge.edgeTime);
+        break;
       }
     }
-    priorTime = curTime;
-    startMeasure = false;
-    measureDone = false;
-    while(true)
+  }
+  // edges may be newer than the caller's time
+  curTime = millis();
+  for(byte btnIdx = 0; btnIdx < BUTTON_COUNT; btnIdx++)
+  {
+    UpdateButton(btnIdx, ButtonState(digitalRead(buttons[btnIdx].buttonPin)), curTime);
+    if(buttons[btnIdx].buttonLast != BUTTON_PRESSED)
     {
-      curTime = millis();
-      CheckButtons(curTime);
-      // select button released, go to next tire
-      if (buttons[0].buttonReleased)
-      {
-        if(selTire < cars[selectedCar].tireCount)
-        {
-          startMeasure = true;
-        }
-        else
-        {
-          measureDone = true;
-        }
-        buttons[0].buttonReleased = false;
-        break;
-      }
-      // cancel button released, return
-      else if (buttons[1].buttonReleased)
-      {
-        selTire = GetNextTire(selTire, 1);
-        buttons[1].buttonReleased = false;
-        break;
-      }
-      else if ((buttons[2].buttonReleased)) 
+      continue;
+    }
+    // long press, first repeat
+    if((!buttons[btnIdx].buttonLongPress) && (buttons[btnIdx].pressDuration >= BUTTON_LONGPRESS_DELAY))
+    {
+      buttons[btnIdx].buttonLongPress = true;
+      buttons[btnIdx].lastRepeat = curTime;
+      if(buttons[btnIdx].autoRepeat)
       {
-        selTire = GetNextTire(selTire, -1);
-        buttons[2].buttonReleased = false;
-        break;
+        buttons[btnIdx].buttonReleased = 1;
+        buttons[btnIdx].repeatCount++;
       }
-      delay(50);
     }
-    if(measureDone)
+    // auto-repeat
+    else if(buttons[btnIdx].buttonLongPress && buttons[btnIdx].autoRepeat &&
+            ((curTime - buttons[btnIdx].lastRepeat) >= BUTTON_REPEAT_DELAY))
     {
-      break;
+      buttons[btnIdx].buttonReleased = 1;
+      buttons[btnIdx].lastRepeat = curTime;
+      buttons[btnIdx].repeatCount++;
     }
   }
-  tftDisplay.fillScreen(TFT_WHITE);
-  YamuraBanner();
-  SetFont(deviceSettings.fontPoints);
-  tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
-  // location of text
-  textPosition[0] = 5;
-  textPosition[1] = 0;
-  tftDisplay.drawString("Done", textPosition[0], textPosition[1], GFXFF);
-  textPosition[1] += fontHeight;
-  tftDisplay.drawString("Storing results...", textPosition[0], textPosition[1], GFXFF);
-  textPosition[1] += fontHeight;
-  WriteMeasurementFile();
-  tftDisplay.drawString("Updating results HTML...", textPosition[0], textPosition[1], GFXFF);
-  textPosition[1] += fontHeight;
-  WriteResultsHTML(/*LittleFS*/SD);  
-  DisplayAllTireTemps(cars[selectedCar]);
 }
 //
-// move to next tire after measurement of a tire is complete, 
-// or if user selects next or prior tire in list
+// BUTTON_PRESSED or BUTTON_RELEASED for a pin level
 //
-int GetNextTire(int selTire, int nextDirection)        
+byte ButtonState(int level)
 {
-  selTire += nextDirection;
-  while(true)
+  return level == BUTTON_ACTIVE_LEVEL ? BUTTON_PRESSED : BUTTON_RELEASED;
+}
+//
+// debounce a single button state at curTime (BUTTON_PRESSED or BUTTON_RELEASED, see ButtonState)
+//
+void UpdateButton(int btnIdx, byte curState, unsigned long curTime)
+{
+  if(((curTime - buttons[btnIdx].lastChange) > BUTTON_DEBOUNCE_DELAY) && 
+     (curState != buttons[btnIdx].buttonLast))
   {
-    if(selTire < 0)
+    buttons[btnIdx].lastChange = curTime;
+    if(curState == BUTTON_PRESSED)
     {
-      selTire = cars[selectedCar].tireCount;
+      // keep the soft-AP joinable for a while (Power_CanSleep)
+      powerStats.awakeMs = curTime;
+      buttons[btnIdx].buttonPressed = 1;
+      buttons[btnIdx].buttonReleased = 0;
+      buttons[btnIdx].buttonLast = BUTTON_PRESSED;
+      buttons[btnIdx].pressDuration = 0;
+      buttons[btnIdx].buttonLongPress = false;
+      buttons[btnIdx].repeatCount = 0;
     }
-    if(selTire > cars[selectedCar].tireCount)
+    else if (curState == BUTTON_RELEASED)
     {
-      selTire = 0;
+      buttons[btnIdx].buttonPressed =  0;
+      // release after auto-repeat was already reported
+      buttons[btnIdx].buttonReleased = buttons[btnIdx].repeatCount == 0 ? 1 : 0;
+      buttons[btnIdx].buttonLast = BUTTON_RELEASED;
+      buttons[btnIdx].releaseDuration = 0;
     }
-  	// stop on 'done'
-    if(selTire == cars[selectedCar].tireCount)
+  }
+  else if((long)(curTime - buttons[btnIdx].lastChange) >= 0)
+  {
+    if(curState == BUTTON_PRESSED)
     {
-      break;
+      buttons[btnIdx].pressDuration = curTime - buttons[btnIdx].lastChange;
     }
-  	// stop on first measure of selTire == 0.0 (never measured)
-    if (tireTemps[(selTire * cars[selectedCar].positionCount)] == 0.0)
+    else if (curState == BUTTON_RELEASED)
     {
-      break;
+      buttons[btnIdx].releaseDuration = curTime - buttons[btnIdx].lastChange;
     }
-    selTire += nextDirection;
-  }
-  return selTire;
-}
-//
-// grid lines enclose 2 rows of 3 cells each
-// top row is T (tire name) and measure position (O, M, I). This row is highlighted when selected during measure
-// bottom row is the 3 temperatures
-// up to 2 grid cells per axle (for cars) or 2 grid cells for front/rear for motorcycles
-//   ------------------------------------
-//  | T O    M    I    | I    M    T O  |
-//  | temp   temp temp | temp temp temp |
-//   ------------------------------------
-//
-void DrawCellText(int row, int col, char* outStr, uint16_t textColor, uint16_t backColor)
-{
-  String blankStr = "00000";
-  tftDisplay.setTextColor(backColor, backColor);
-  if(strlen(outStr) > 1)
-  {
-    tftDisplay.fillRect(cellPoint[row][col][0], cellPoint[row][col][1], tftDisplay.textWidth(blankStr.c_str()), fontHeight - 4, backColor);
   }
-  tftDisplay.setTextColor(textColor, backColor);
-  tftDisplay.drawString(outStr, cellPoint[row][col][0], cellPoint[row][col][1], GFXFF);
-  tftDisplay.setTextColor(TFT_BLACK, TFT_WHITE);
 }
 //
-// rotate display for right or left hand use
+// block until a button edge is queued or timeout (ms) expires, CPU idles meanwhile
+// returns true if an edge is waiting for CheckButtons
+// wakes early while a button is held or bouncing so long press/repeat/debounce happen on time
+// light sleeps (Power_LightSleep) instead of blocking if allowed, a button press wakes it
+// pending HTML pages are written here before any waiting, web forms are applied at the main menu
+// spiMutex is released only for the wait itself
 //
-void RotateDisplay(bool rotateButtons)
+bool WaitButtonEvent(unsigned long timeout)
 {
-  tftDisplay.setRotation(deviceSettings.screenRotation == 0 ? 1 : 3);
-  tftDisplay.fillScreen(TFT_WHITE);
-  if(rotateButtons)
+  ButtonEdge edge;
+  bool buttonActive = false;
+  for(int btnIdx = 0; btnIdx < BUTTON_COUNT; btnIdx++)
   {
-    int reverseButtons[BUTTON_COUNT];
-    for(int btnIdx = 0; btnIdx < BUTTON_COUNT; btnIdx++)
+    if(ButtonState(digitalRead(buttons[btnIdx].buttonPin)) != buttons[btnIdx].buttonLast)
     {
-      reverseButtons[BUTTON_COUNT - (btnIdx + 1)] = buttons[btnIdx].buttonPin;
+      timeout = timeout < BUTTON_DEBOUNCE_DELAY ? timeout : BUTTON_DEBOUNCE_DELAY;
+      buttonActive = true;
     }
-    for(int btnIdx = 0; btnIdx < BUTTON_COUNT; btnIdx++)
+    else if(buttons[btnIdx].buttonLast == BUTTON_PRESSED)
     {
-      buttons[btnIdx].buttonPin = reverseButtons[btnIdx];
+      timeout = timeout < BUTTON_REPEAT_DELAY / 2 ? timeout : BUTTON_REPEAT_DELAY / 2;
+      buttonActive = true;
     }
   }
+  #ifdef HAS_RTC
+  Clock_Check();
+  #endif
+  // web edits wait for the main menu (Web_ApplyForms)
+  if((deviceState == DISPLAY_MENU) && !buttonActive)
+  {
+    Web_ApplyForms();
+  }
+  // deferred page updates use idle time, not a contact wait (an SD page write would delay the probe)
+  if(((htmlPending != 0) || resultsHTML.active) && !buttonActive && !runGroupActive && !thermoAlertArmed)
+  {
+    UpdatePendingHTML();
+    return (buttonQueue != NULL) && (uxQueueMessagesWaiting(buttonQueue) > 0);
+  }
+  // web server may use the SD card while the loop task waits
+  bool edgeWaiting = false;
+  xSemaphoreGive(spiMutex);
+  if(buttonQueue == NULL)
+  {
+    delay(timeout);
+  }
+  else if(Power_CanSleep(timeout))
+  {
+    edgeWaiting = Power_LightSleep(timeout, true) || (uxQueueMessagesWaiting(buttonQueue) > 0);
+  }
+  else
+  {
+    edgeWaiting = xQueuePeek(buttonQueue, &edge, pdMS_TO_TICKS(timeout)) == pdTRUE;
+  }
+  xSemaphoreTake(spiMutex, portMAX_DELAY);
+  return edgeWaiting;
 }
 //
-// wait until temperature at probe stabilizes
+// true if an idle wait of timeout ms should light sleep
+// no sleep while stations are connected, or within AP_AWAKE_MS of boot, a button press or a station
+// leaving, so the soft-AP keeps beaconing and a phone can join
 //
-float GetStableTemp(int positionIdx, int row, int col)
+bool Power_CanSleep(unsigned long timeout)
 {
-  Serial.println("Start GetStableTemp");
-  char outStr[512];
-  float minMax[2] = {5000.0, -5000.0};
-  float averageTemp = 0;
-  bool rVal = true;
-  float temperature;
-  int countTemperature = 0;
-  // assume the user put temp band in using correct units
-  // convert deviation band to F if needed
-  //if(deviceSettings.tempUnits == 0)
-  //{
-  //  for(int idx = 0; idx < 2; idx++)
-  //  {
-  //    deviceSettings.stableBand[idx] = CtoCRelative(deviceSettings.stableBand[idx]);
-  //  }
-  //}
-  // set initial buffer temps to 15C or 60F
-  for(int idx = 0; idx < deviceSettings.stableBuffer; idx++)
-  {
-    tempValues[idx] = deviceSettings.tempUnits == 0 ? 60.0 : 15.0;
-  }
-  averageTemp = tempValues[0];
-  while(true)
+  #ifdef POWER_SAVE
+  Power_UpdateWiFi();
+  return (timeout >= IDLE_SLEEP_MIN) && (powerStats.apClients == 0) && (millis() - powerStats.awakeMs >= AP_AWAKE_MS);
+  #else
+  return false;
+  #endif
+}
+//
+// light sleep for up to timeout ms (capped at IDLE_SLEEP_MAX), optionally waking on any button (and the armed contact alert)
+// returns true if a button (or the alert) woke the device
+//
+bool Power_LightSleep(unsigned long timeout, bool wakeOnButtons)
+{
+  unsigned long sleepStart = millis();
+  timeout = timeout < IDLE_SLEEP_MAX ? timeout : IDLE_SLEEP_MAX;
+  esp_sleep_enable_timer_wakeup((uint64_t)timeout * 1000ULL);
+  if(wakeOnButtons)
   {
-    temperature = Thermo_GetTemp();
-    sprintf(outStr, "        %0.2f (%.2F)         ", temperature, averageTemp);
-    // draw current temp
-    tftDisplay.setFreeFont(FSS24); // max font
-    tftDisplay.drawString(outStr, row, col, GFXFF);      
-    SetFont(deviceSettings.fontPoints);
-    // get average temp in circular buffer
-    if(countTemperature >= deviceSettings.stableBuffer)
+    // wake on level away from released, this replaces the pin's edge interrupt while asleep
+    // the interrupt is off until the edge type is back, a level interrupt would re-fire the ISR
+    // for as long as the button is held - CheckButtons reads the level after waking
+    for(int btnIdx = 0; btnIdx < BUTTON_COUNT; btnIdx++)
     {
-      countTemperature = 0;
+      gpio_intr_disable((gpio_num_t)buttons[btnIdx].buttonPin);
+      gpio_wakeup_enable((gpio_num_t)buttons[btnIdx].buttonPin, BUTTON_ACTIVE_LEVEL == HIGH ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
     }
-    tempValues[countTemperature] = temperature;
-    countTemperature++;
-    averageTemp = 0.0;
-    for(int idx = 0; idx < deviceSettings.stableBuffer; idx++)
+    #ifdef THERMO_ALERT_PIN
+    // probe contact (or lift, thermoAlertWake) wakes it too while waiting for contact, Thermo_WaitContact reads the level
+    if(thermoAlertArmed)
     {
-      averageTemp += tempValues[idx];
+      gpio_intr_disable((gpio_num_t)THERMO_ALERT_PIN);
+      gpio_wakeup_enable((gpio_num_t)THERMO_ALERT_PIN, thermoAlertWake == LOW ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
     }
-    averageTemp = averageTemp / (float)deviceSettings.stableBuffer;
-    // check deviations, exit if within +/- 0.25
-    minMax[0] = 5000.0;  
-    minMax[1] = -5000.0;
-    for(int idx = 0; idx < deviceSettings.stableBuffer; idx++)
+    #endif
+    esp_sleep_enable_gpio_wakeup();
+  }
+  esp_light_sleep_start();
+  if(wakeOnButtons)
+  {
+    // restore edge interrupts
+    for(int btnIdx = 0; btnIdx < BUTTON_COUNT; btnIdx++)
     {
-      minMax[0] = (averageTemp - tempValues[idx]) < minMax[0] ? (averageTemp - tempValues[idx]) : minMax[0];
-      minMax[1] = (averageTemp - tempValues[idx]) > minMax[1] ? (averageTemp - tempValues[idx]) : minMax[1];
+      gpio_wakeup_disable((gpio_num_t)buttons[btnIdx].buttonPin);
+      gpio_set_intr_type((gpio_num_t)buttons[btnIdx].buttonPin, GPIO_INTR_ANYEDGE);
+      gpio_intr_enable((gpio_num_t)buttons[btnIdx].buttonPin);
     }
-    if(((minMax[1] - minMax[0]) >= deviceSettings.stableBand[0]) &&
-       ((minMax[1] - minMax[0]) <=  deviceSettings.stableBand[1]))
+    #ifdef THERMO_ALERT_PIN
+    if(thermoAlertArmed)
     {
-      break;
+      gpio_wakeup_disable((gpio_num_t)THERMO_ALERT_PIN);
+      gpio_set_intr_type((gpio_num_t)THERMO_ALERT_PIN, GPIO_INTR_NEGEDGE);
+      gpio_intr_enable((gpio_num_t)THERMO_ALERT_PIN);
     }
-    delay(deviceSettings.stableDelay);
+    #endif
   }
-  return averageTemp;
-}
-//
-// draw the Yamura banner at bottom of screen
-//
-void YamuraBanner()
-{
-  tftDisplay.setTextColor(TFT_BLACK, TFT_YELLOW);
-  SetFont(9);
-  int xPos = tftDisplay.width()/2;
-  int yPos = tftDisplay.height() - fontHeight/2;
-  tftDisplay.setTextDatum(BC_DATUM);
-  tftDisplay.drawString("  Yamura Motors LLC Recording Pyrometer  ",xPos, yPos, GFXFF);    // Print the font name onto the TFT screen
-  tftDisplay.setTextDatum(TL_DATUM);
+  powerStats.sleepMs += millis() - sleepStart;
+  powerStats.sleepCount++;
+  return esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO;
 }
 //
-// set font for TFT display, update fontHeight used for vertical stepdown by line
+// wait timeout ms, light sleeping if allowed (buttons are not checked)
 //
-void SetFont(int fontSize)
+void Power_IdleDelay(unsigned long timeout)
 {
-  switch(fontSize)
+  unsigned long deadline = millis() + timeout;
+  unsigned long remaining = timeout;
+  while(Power_CanSleep(remaining))
   {
-    case 9:
-      tftDisplay.setFreeFont(FSS9);
-      break;
-    case 12:
-      tftDisplay.setFreeFont(FSS12);
-      break;
-    case 18:
-      tftDisplay.setFreeFont(FSS18);
-      break;
-    case 24:
-      tftDisplay.setFreeFont(FSS24); // was FSS18
-      break;
-    default:
-      tftDisplay.setFreeFont(FSS12);
-      break;
+    Power_LightSleep(remaining, false);
+    remaining = (long)(deadline - millis()) > 0 ? deadline - millis() : 0;
   }
-  tftDisplay.setTextDatum(TL_DATUM);
-  fontHeight = tftDisplay.fontHeight(GFXFF);
-  fontWidth = tftDisplay.textWidth("X");
+  if(remaining > 0)
+  {
+    delay(remaining);
+  }
+}
+//
+// start a fixed rate schedule, first deadline is one period from now
+//
+void Sched_Begin(SampleSchedule& schedule, unsigned long periodMs)
+{
+  schedule.periodMs = periodMs > 0 ? periodMs : 1;
+  schedule.startMs = millis();
+  schedule.nextMs = schedule.startMs;
+  schedule.firstMs = schedule.startMs;
+  schedule.lastMs = schedule.startMs;
+  schedule.samples = 0;
+  schedule.overruns = 0;
 }
 //
-// COMMON FUNCTION DEFINITIONS
-// these functions could be used as is in other applications
-// or at least are not specific to pyrometer functions
+// count a sample taken now, for Sched_RateHz
 //
-
+void Sched_Sample(SampleSchedule& schedule)
+{
+  unsigned long now = millis();
+  if(schedule.samples == 0)
+  {
+    schedule.firstMs = now;
+  }
+  schedule.lastMs = now;
+  schedule.samples++;
+}
 //
-// convert temperature from C to F
+// wait for the next deadline (startMs + n * periodMs), sleeping where possible
+// deadlines already past are skipped so the sample grid does not drift
 //
-float CtoFAbsolute(float tempC)
+void Sched_WaitNext(SampleSchedule& schedule)
 {
-  return (tempC * 1.8) + 32; 
+  schedule.nextMs += schedule.periodMs;
+  unsigned long now = millis();
+  if((long)(schedule.nextMs - now) <= 0)
+  {
+    schedule.overruns++;
+    schedule.nextMs += ((now - schedule.nextMs) / schedule.periodMs + 1) * schedule.periodMs;
+  }
+  Power_IdleDelay(schedule.nextMs - now);
 }
 //
-// convert temperature difference from C to F
+// effective sample rate, sample intervals over the time from the first to the last sample
 //
-float CtoFRelative(float tempC)
+float Sched_RateHz(const SampleSchedule& schedule)
 {
-  return (tempC * 1.8); 
+  unsigned long elapsed = schedule.lastMs - schedule.firstMs;
+  return (schedule.samples > 1) && (elapsed > 0) ? ((schedule.samples - 1) * 1000.0F) / elapsed : 0.0F;
 }
 //
-// convert temperature from C to F
+// start tracing a position if deviceSettings.traceSamples, settings go in the TraceStart record
 //
-float FtoCAbsolute(float tempF)
+void Trace_Start(int tempIdx)
 {
-  return (tempF - 32) / 1.8; 
+  traceActive = false;
+  if(!deviceSettings.traceSamples)
+  {
+    return;
+  }
+  if(traceData == NULL)
+  {
+    traceData = (uint8_t*)malloc(TRACE_BUFFER_SIZE);
+    Trace_BufferBegin(traceBuffer, traceData, TRACE_BUFFER_SIZE);
+  }
+  traceBuffer.dropped = 0;
+  memset(&traceStart, 0, sizeof(traceStart));
+  traceStart.type = TRACE_START;
+  traceStart.method = deviceSettings.stableMethod;
+  traceStart.tempIdx = tempIdx;
+  traceStart.positionCount = cars[selectedCar].positionCount;
+  traceStart.carID = cars[selectedCar].carID;
+  traceStart.epochMs = Clock_EpochMs();
+  traceStart.stableBand[0] = deviceSettings.stableBand[0];
+  traceStart.stableBand[1] = deviceSettings.stableBand[1];
+  traceStart.stableSlope = deviceSettings.stableSlope;
+  traceStart.kalmanNoise = deviceSettings.kalmanNoise;
+  traceStart.kalmanRate = deviceSettings.kalmanRate;
+  traceStart.stableDelay = deviceSettings.stableDelay;
+  traceStart.stableBuffer = deviceSettings.stableBuffer;
+  traceStart.tempUnits = deviceSettings.tempUnits ? 1 : 0;
+  traceActive = Trace_Put(traceBuffer, &traceStart, sizeof(traceStart));
 }
 //
-// convert temperature difference from C to F
+// add the last Thermo_GetTemp reading to the trace, one extra I2C read for the cold junction
+// never waits, a full ring drops the sample
 //
-float FtoCRelative(float tempF)
+void Trace_Sample()
 {
-  return tempF / 1.8; 
+  if(!traceActive)
+  {
+    return;
+  }
+  // samples leave room for the end record
+  if(traceBuffer.size - traceBuffer.used < sizeof(TraceSample) + sizeof(TraceEnd))
+  {
+    traceBuffer.dropped++;
+    return;
+  }
+  TraceSample sample;
+  sample.type = TRACE_SAMPLE;
+  sample.status = thermoStatus;
+  sample.coldCenti = thermoPresent ? (int16_t)lroundf(tempSensor.readAmbient() * 100.0F) : 0;
+  sample.timeMs = (uint32_t)(Clock_EpochMs() - traceStart.epochMs);
+  sample.hot = thermoFault == THERMO_NO_AMP ? NAN : thermoHotC;
+  Trace_Put(traceBuffer, &sample, sizeof(sample));
 }
 //
-// returns true if time is PM (for 12 hour display)
-// requires RTC
+// close the traced position with the reported result
 //
-bool RTC_IsPM()
+void Trace_End(int result, float temp)
 {
-  DateTime now;
-  now = RTC_GetDateTime();
-  return now.isPM();
+  if(!traceActive)
+  {
+    return;
+  }
+  TraceEnd end;
+  end.type = TRACE_END;
+  end.result = result;
+  end.fault = thermoFault;
+  end.reserved = 0;
+  end.timeMs = (uint32_t)(Clock_EpochMs() - traceStart.epochMs);
+  end.temp = temp;
+  end.dropped = traceBuffer.dropped;
+  Trace_Put(traceBuffer, &end, sizeof(end));
+  traceActive = false;
 }
 //
-// get HH:MM:SS from RTC time
-// requires RTC
+// write the trace ring to TRACE_PATH on SD, call between positions (not while sampling)
 //
-String RTC_GetStringTime()
+void Trace_Flush()
 {
-  bool h12Flag;
-  bool pmFlag;
-  String rVal;
-  char buf[512];
-  int ampm;
-  DateTime now;
-  now = RTC_GetDateTime();
-  int year = now.year();
-  int month = now.month();
-  int day = now.day();
-  int dayOfWeek = now.dayOfTheWeek();
-	int hour = now.hour();
-	int minute = now.minute();
-	int second = now.second();
-  bool isPM = now.isPM();
-  if(deviceSettings.is12Hour)
+  const uint8_t* bytes;
+  if((traceData == NULL) || (traceBuffer.used == 0))
   {
-    if(isPM)
-    {
-      if(hour > 12)
-      {
-        hour -= 12;
-      }
-    } 
+    return;
   }
-  if(deviceSettings.is12Hour)
+  if(SD.cardType() == CARD_NONE)
   {
-    sprintf(buf, "%02d:%02d%s", hour, minute, ampmStr[isPM ? 1 : 0]);
+    Trace_Consume(traceBuffer, traceBuffer.used);
+    return;
   }
-  else
+  // records are only appended to a file of the same version, an older file is started over
+  if(!traceFileChecked && SD.exists(TRACE_PATH))
   {
-    if((isPM) && (hour < 12))
+    TraceHeader header;
+    File file = SD.open(TRACE_PATH, FILE_READ);
+    bool isCurrent = file && (file.read((uint8_t*)&header, sizeof(header)) == sizeof(header)) &&
+                     (header.magic == TRACE_MAGIC) && (header.version == TRACE_VERSION);
+    file.close();
+    if(!isCurrent)
     {
-      hour += 12;
+      DeleteFile(SD, TRACE_PATH);
     }
-    sprintf(buf, "%02d:%02d", hour, minute);
   }
-  rVal = buf;
-  return rVal;
-}
-//
-// get MM/DD/YYYY from RTC date
-// requires RTC
-//
-String RTC_GetStringDate()
-{
-  bool century = false;
-  String rVal;
-  char buf[512];
-	DateTime now;
-  now = RTC_GetDateTime();
-  int year = now.year();
-  int month = now.month();
-  int day = now.day();
-  sprintf(buf, "%02d/%02d/%02d", month, day, year);
-  rVal = buf;
-  return rVal;
+  traceFileChecked = true;
+  File file = SD.open(TRACE_PATH, FILE_APPEND);
+  if(!file)
+  {
+    return;
+  }
+  if(file.size() == 0)
+  {
+    TraceHeader header;
+    header.magic = TRACE_MAGIC;
+    header.version = TRACE_VERSION;
+    header.reserved = 0;
+    file.write((const uint8_t*)&header, sizeof(header));
+  }
+  uint32_t count;
+  while((count = Trace_Peek(traceBuffer, bytes)) > 0)
+  {
+    file.write(bytes, count);
+    Trace_Consume(traceBuffer, count);
+  }
+  file.close();
 }
 //
-// Set date time
-// pass in a year, month, date, hour, minute, second as integer values
+// track soft-AP stations, any station (or one leaving) restarts the AP_AWAKE_MS window
+// (modem power save does not apply to the soft-AP, the CPU staying awake is what keeps it joinable)
 //
-void RTC_SetDateTime(int year, int month, int date, int hour, int minute, int second)
+void Power_UpdateWiFi()
 {
-  rtc.adjust(DateTime(year, month, date, hour, minute, second));
+  int clients = WiFi.softAPgetStationNum();
+  if((clients > 0) || (clients != powerStats.apClients))
+  {
+    powerStats.awakeMs = millis();
+  }
+  if(clients == powerStats.apClients)
+  {
+    return;
+  }
+  #ifdef DEBUG_VERBOSE
+  Serial.printf("soft-AP clients %d\n", clients);
+  #endif
+  powerStats.apClients = clients;
 }
 //
-// Set date time
-// pass in a DateTime structure
+// estimated battery life in hours from full charge at the awake/asleep ratio seen since boot
 //
-void RTC_SetDateTime(DateTime timeVal)
+float Power_BatteryHours()
 {
-  rtc.adjust(timeVal);
+  unsigned long upTime = millis();
+  float sleepFraction = upTime > 0 ? (float)powerStats.sleepMs / (float)upTime : 0.0F;
+  float averageCurrent = (CURRENT_ACTIVE_MA * (1.0F - sleepFraction)) + (CURRENT_SLEEP_MA * sleepFraction);
+  return (float)BATTERY_CAPACITY_MAH / averageCurrent;
 }
 //
-// get time from RTC
-// make it easier to change RTC modules if libraries need
-// different calls
-// return as a DateTime structure
+// start a timing probe, returns start time for Probe_Stop
 //
-DateTime RTC_GetDateTime()
+uint32_t Probe_Start()
 {
-  return rtc.now();
+  return micros();
 }
 //
-// any initialization required for RTC module, return TRUE for sucess, FALSE for fail
+// record elapsed time since startUs in a timing probe
 //
-bool RTC_Setup()
+void Probe_Stop(int probeIdx, uint32_t startUs)
 {
-  bool rVal = rtc.begin();
-  // When the RTC was stopped and stays connected to the battery, it has
-  // to be restarted by clearing the STOP bit. Let's do this to ensure
-  // the RTC is running.
-  #ifdef RTC_8563
-  if(rVal) 
-  {
-    rtc.start();
-  };
-  #endif
-  return rVal;
+  uint32_t elapsed = micros() - startUs;
+  TimingProbe& probe = timingProbes[probeIdx];
+  probe.lastUs = elapsed;
+  probe.maxUs = elapsed > probe.maxUs ? elapsed : probe.maxUs;
+  probe.totalUs += elapsed;
+  probe.count++;
 }
 //
+// write timing probes as JSON, times in microseconds
 //
-//
-float Thermo_GetTemp()
+void Probe_WriteJSON(Print& out)
 {
-  //float temperature = tempSensor.getThermocoupleTemp();
-  float temperature = tempSensor.readThermocouple();
-  if (isnan(temperature)) 
-  {
-    return -100.0F;
-  }
-  // convert to F if required
-  if(deviceSettings.tempUnits == 0)
+  out.printf("{\"uptime_ms\":%lu,\"free_heap\":%u,\"sleep_ms\":%lu,\"probes\":[", millis(), ESP.getFreeHeap(), powerStats.sleepMs);
+  for(int probeIdx = 0; probeIdx < PROBE_COUNT; probeIdx++)
   {
-    temperature = CtoFAbsolute(temperature);
+    TimingProbe& probe = timingProbes[probeIdx];
+    out.printf("%s{\"name\":\"%s\",\"count\":%u,\"last_us\":%u,\"avg_us\":%u,\"max_us\":%u}",
+               probeIdx == 0 ? "" : ",",
+               probe.name,
+               probe.count,
+               probe.lastUs,
+               probe.count > 0 ? (uint32_t)(probe.totalUs / probe.count) : 0,
+               probe.maxUs);
   }
-  return temperature;
+  out.printf("],\"sample_period_ms\":%lu,\"sample_hz\":%0.3f,\"samples\":%lu,\"sample_overruns\":%lu}",
+             sampleSchedule.periodMs, Sched_RateHz(sampleSchedule), sampleSchedule.samples, sampleSchedule.overruns);
 }
 //
+// start buffered line reads from an open file
+// requires a file system of some kind = LittleFS or SD
 //
-//
-void Thermo_Setup()
+void Line_Begin(LineReader& reader, File& file)
 {
-  char outStr[256];
-  if(tempSensor.begin(I2C_ADDRESS_THERMO))
-  {
-    #ifdef DEBUG_VERBOSE
-    Serial.println("Thermocouple acknowledged");
-    #endif
-    tftDisplay.drawString("Thermocouple acknowledged", textPosition[0], textPosition[1], GFXFF);
-    textPosition[1] += fontHeight;
-  }
-  else 
-  {
-    #ifdef DEBUG_VERBOSE
-    Serial.println("Thermocouple did not acknowledge");
-    #endif
-    tftDisplay.drawString("Thermocouple did not acknowledge", textPosition[0], textPosition[1], GFXFF);
-    textPosition[1] += fontHeight;
-    while(1); //hang forever
-  }
-  tempSensor.setADCresolution(MCP9600_ADCRESOLUTION_18);
-  Serial.print("ADC resolution set to ");
-  switch (tempSensor.getADCresolution()) 
-  {
-    case MCP9600_ADCRESOLUTION_18:   
-      Serial.print("18"); 
-      break;
-    case MCP9600_ADCRESOLUTION_16:   
-      Serial.print("16"); 
-      break;
-    case MCP9600_ADCRESOLUTION_14:   
-      Serial.print("14"); 
-      break;
-    case MCP9600_ADCRESOLUTION_12:   
-      Serial.print("12"); 
-      break;
-  }
-  Serial.println(" bits");
-  //change the thermocouple type being used
-  Serial.println("Setting Thermocouple Type!");
-  tempSensor.setThermocoupleType(MCP9600_TYPE_K);
-   //make sure the type was set correctly!
-  switch(tempSensor.getThermocoupleType())
-  {
-    case MCP9600_TYPE_K:
-      sprintf(outStr,"Type K ");
-      break;
-    case MCP9600_TYPE_J:
-      sprintf(outStr,"Thermocouple set failed (Type J");
-      break;
-    case MCP9600_TYPE_T:
-      sprintf(outStr,"Thermocouple set failed (Type T");
-      break;
-    case MCP9600_TYPE_N:
-      sprintf(outStr,"Thermocouple set failed (Type N");
-      break;
-    case MCP9600_TYPE_S:
-      sprintf(outStr,"Thermocouple set failed (Type S");
-      break;
-    case MCP9600_TYPE_E:
-      sprintf(outStr,"Thermocouple set failed (Type E");
-      break;
-    case MCP9600_TYPE_B:
-      sprintf(outStr,"Thermocouple set failed (Type B");
-      break;
-    case MCP9600_TYPE_R:
-      sprintf(outStr,"Thermocouple set failed (Type R");
-      break;
-    default:
-      sprintf(outStr,"Thermocouple set failed (unknown type");
-      break;
-  }
-  Serial.println(outStr);
-  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
-  textPosition[1] += fontHeight;
-
-  tempSensor.setFilterCoefficient(3);
-  Serial.print("Thermocouple filter coefficient value set to: ");
-  Serial.println(tempSensor.getFilterCoefficient());
-
-
-  sprintf(outStr,"Temp: C: %0.2FC/%0.2FF H: %0.2FC/%0.2FF",tempSensor.readAmbient(), CtoFAbsolute(tempSensor.readAmbient()),
-                                                           tempSensor.readThermocouple(), CtoFAbsolute(tempSensor.readThermocouple()));
-  tftDisplay.drawString(outStr, textPosition[0], textPosition[1], GFXFF);
-  textPosition[1] += fontHeight;
-
-
-  for(int idx = 0; idx < deviceSettings.stableBuffer; idx++)
-  {
-    tempValues[idx] = -100.0;
-  }
+  reader.file = &file;
+  reader.start = 0;
+  reader.end = 0;
+  reader.eof = false;
+  reader.skip = false;
+  reader.buf[0] = '\0';
 }
 //
-// check all buttons for new press or release
+// read the next line from a file opened with Line_Begin
+// file is read LINE_BLOCK_SIZE bytes at a time, the line is NUL terminated in place
+// and returned as a pointer into the reader buffer - valid until the next Line_Read
+// control characters are dropped, lines longer than LINE_MAX_LENGTH are truncated
+// returns an empty string at end of file
 //
-void CheckButtons(unsigned long curTime)
+char* Line_Read(LineReader& reader)
 {
-  byte curState;
-  for(byte btnIdx = 0; btnIdx < BUTTON_COUNT; btnIdx++)
+  char* line;
+  char* lineEnd;
+  while(true)
   {
-    curState = digitalRead(buttons[btnIdx].buttonPin);
-    if(((curTime - buttons[btnIdx].lastChange) > BUTTON_DEBOUNCE_DELAY) && 
-       (curState != buttons[btnIdx].buttonLast))
+    char* data = &reader.buf[reader.start];
+    int count = reader.end - reader.start;
+    char* newLine = (char*)memchr(data, '\n', count);
+    if(reader.skip)
     {
-      buttons[btnIdx].lastChange = curTime;
-      if(curState == BUTTON_PRESSED)
+      // discarding the tail of an over-long line
+      if(newLine != NULL)
       {
-        buttons[btnIdx].buttonPressed = 1;
-        buttons[btnIdx].buttonReleased = 0;
-        buttons[btnIdx].buttonLast = BUTTON_PRESSED;
-        buttons[btnIdx].pressDuration = 0;
+        reader.start = (newLine - reader.buf) + 1;
+        reader.skip = false;
+        continue;
       }
-      else if (curState == BUTTON_RELEASED)
+      reader.start = reader.end;
+      if(reader.eof)
       {
-        buttons[btnIdx].buttonPressed =  0;
-        buttons[btnIdx].buttonReleased = 1;
-        buttons[btnIdx].buttonLast = BUTTON_RELEASED;
-        buttons[btnIdx].releaseDuration = 0;
+        reader.skip = false;
+        continue;
       }
     }
-    else
+    else if(newLine != NULL)
     {
-      if(curState == BUTTON_PRESSED)
-      {
-        buttons[btnIdx].pressDuration = curTime - buttons[btnIdx].lastChange;
-      }
-      else if (curState == BUTTON_RELEASED)
-      {
-        buttons[btnIdx].releaseDuration = curTime - buttons[btnIdx].lastChange;
-      }
+      line = data;
+      lineEnd = (newLine - data) > LINE_MAX_LENGTH ? data + LINE_MAX_LENGTH : newLine;
+      reader.start = (newLine - reader.buf) + 1;
+      break;
     }
-  }
-}
-//
-// read a line from an open file
-// requires a file system of some kind = LittleFS or SD
-//
-void ReadLine(File file, char* buf)
-{  
-  char c;
-  int bufIdx = 0;
-  buf[0] = '\0';
-  do
-  {
-    if(!file.available())
+    else if(count >= LINE_MAX_LENGTH)
     {
-      return;
+      // over-long line, return the first LINE_MAX_LENGTH bytes and skip the rest
+      line = data;
+      lineEnd = data + LINE_MAX_LENGTH;
+      reader.start = reader.end;
+      reader.skip = true;
+      break;
     }
-    c = file.read();
-    if(c < 0x20)
+    else if(reader.eof)
     {
-      if(c != 0x0A)
-      {
-        continue;
-      }
+      // last line without a newline, or empty string at end of file
+      line = data;
+      lineEnd = &reader.buf[reader.end];
+      reader.start = reader.end;
       break;
     }
-    buf[bufIdx] = c;
-    bufIdx++;
-    buf[bufIdx] = '\0';
-  } while (c != 0x10);
-  return;
+    // move partial line to front of buffer and read the next block behind it
+    if(reader.start > 0)
+    {
+      count = reader.end - reader.start;
+      memmove(reader.buf, &reader.buf[reader.start], count);
+      reader.start = 0;
+      reader.end = count;
+    }
+    int readCount = reader.file->read((uint8_t*)&reader.buf[reader.end], LINE_BUFFER_SIZE - reader.end);
+    if(readCount <= 0)
+    {
+      reader.eof = true;
+    }
+    else
+    {
+      reader.end += readCount;
+    }
+  }
+  // drop control characters (CR, tabs) in place
+  char* outChar = line;
+  for(char* inChar = line; inChar < lineEnd; inChar++)
+  {
+    if((unsigned char)*inChar >= 0x20)
+    {
+      *outChar++ = *inChar;
+    }
+  }
+  *outChar = '\0';
+  return line;
 }
 //
 // append to a file - this function opens, writes line and closes the file
 // requires a file system of some kind = LittleFS or SD
+// returns false if the file can't be opened or the line is not fully written
 //
-void AppendFile(fs::FS &fs, const char * path, const char * message)
+bool AppendFile(fs::FS &fs, const char * path, const char * message)
 {
   File file = fs.open(path, FILE_APPEND);
   if(!file)
   {
-    return;
+    return false;
   }
-  file.println(message);
+  bool written = file.println(message) == strlen(message) + 2;
   file.close();
+  return written;
 }
 //
 // delete a file
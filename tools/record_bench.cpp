@@ -0,0 +1,302 @@
+/*
+  YamuraLog Recording Tire Pyrometer
+  host benchmark - measurement record codec (PyroRecord.h) against the original
+  strtok/atof/strcpy parser and String += formatter
+  the codec keeps temps as whole hundredths of a degree C (TempCenti), the original as float
+
+  build and run from the sketch folder:
+    g++ -O2 -std=c++11 -o record_bench tools/record_bench.cpp && ./record_bench
+*/
+#include <chrono>
+#include <string>
+#include "../PyroRecord.h"
+
+// the fields ReadMeasurementFile fills, same sizes as CarSettings
+struct BenchCar
+{
+  char carName[64];
+  char dateTime[32];
+  int tireCount;
+  char tireShortName[6][16];
+  char tireLongName[6][32];
+  int positionCount;
+  char positionShortName[6][16];
+  char positionLongName[6][32];
+  float maxTemp[6];
+};
+float tireTemps[RECORD_MAX_TEMPS];
+TempCenti tireCenti[RECORD_MAX_TEMPS];
+
+//
+// original parser (strtok, atof, strcpy)
+//
+void OriginalParse(char buf[], BenchCar &currentResultCar)
+{
+  int tokenIdx = 0;
+  int measureIdx = 0;
+  int tireIdx = 0;
+  int positionIdx = 0;
+  int maxTempIdx = 0;
+  int measureRange[2] = {99, 99};
+  int tireNameRange[2] = {99, 99};
+  int posNameRange[2] = {99, 99};
+  int maxTempRange[2] = {99, 99};
+  char* token = strtok(buf, ";");
+  while(token != NULL)
+  {
+    if(tokenIdx == 0)
+    {
+      strcpy(currentResultCar.dateTime, token);
+    }
+    if(tokenIdx == 1)
+    {
+      strcpy(currentResultCar.carName, token);
+    }
+    else if(tokenIdx == 2)
+    {
+      currentResultCar.tireCount = atoi(token);
+    }
+    else if(tokenIdx == 3)
+    {
+      currentResultCar.positionCount = atoi(token);
+      measureRange[0]  = tokenIdx + 1;
+      measureRange[1]  = measureRange[0] +  (currentResultCar.tireCount *  currentResultCar.positionCount) - 1;
+      tireNameRange[0] = measureRange[1];
+      tireNameRange[1] = tireNameRange[0] + currentResultCar.tireCount;
+      posNameRange[0]  = tireNameRange[1];
+      posNameRange[1]  = posNameRange[0] + currentResultCar.positionCount;
+      maxTempRange[0]  = posNameRange[1];
+      maxTempRange[1]  = maxTempRange[0] + currentResultCar.tireCount;
+    }
+    else if((tokenIdx >= measureRange[0]) && (tokenIdx <= measureRange[1]))
+    {
+      tireTemps[measureIdx] = atof(token);
+      measureIdx++;
+    }
+    else if((tokenIdx >= tireNameRange[0]) && (tokenIdx <= tireNameRange[1]))
+    {
+      strcpy(currentResultCar.tireShortName[tireIdx], token);
+      strcpy(currentResultCar.tireLongName[tireIdx], token);
+      tireIdx++;
+    }
+    else if((tokenIdx >= posNameRange[0]) && (tokenIdx <= posNameRange[1]))
+    {
+      strcpy(currentResultCar.positionShortName[positionIdx], token);
+      strcpy(currentResultCar.positionLongName[positionIdx], token);
+      positionIdx++;
+    }
+    else if((tokenIdx >= maxTempRange[0]) && (tokenIdx <= maxTempRange[1]))
+    {
+      currentResultCar.maxTemp[maxTempIdx] = atof(token);
+      maxTempIdx++;
+    }
+    token = strtok(NULL, ";");
+    tokenIdx++;
+  }
+}
+//
+// new parser plus the copies ReadMeasurementFile still makes into CarSettings
+//
+void CodecParse(char buf[], BenchCar &currentResultCar)
+{
+  MeasureRecord record;
+  if(!Record_Parse(buf, record))
+  {
+    return;
+  }
+  strncpy(currentResultCar.dateTime, record.dateTime, sizeof(currentResultCar.dateTime) - 1);
+  strncpy(currentResultCar.carName, record.carName, sizeof(currentResultCar.carName) - 1);
+  currentResultCar.tireCount = record.tireCount;
+  currentResultCar.positionCount = record.positionCount;
+  memcpy(tireCenti, record.temps, record.tireCount * record.positionCount * sizeof(TempCenti));
+  for(int tireIdx = 0; tireIdx < record.tireCount; tireIdx++)
+  {
+    strncpy(currentResultCar.tireShortName[tireIdx], record.tireNames[tireIdx], sizeof(currentResultCar.tireShortName[tireIdx]) - 1);
+    strncpy(currentResultCar.tireLongName[tireIdx], record.tireNames[tireIdx], sizeof(currentResultCar.tireLongName[tireIdx]) - 1);
+    currentResultCar.maxTemp[tireIdx] = record.maxTemps[tireIdx] / 100.0f;
+  }
+  for(int positionIdx = 0; positionIdx < record.positionCount; positionIdx++)
+  {
+    strncpy(currentResultCar.positionShortName[positionIdx], record.positionNames[positionIdx], sizeof(currentResultCar.positionShortName[positionIdx]) - 1);
+    strncpy(currentResultCar.positionLongName[positionIdx], record.positionNames[positionIdx], sizeof(currentResultCar.positionLongName[positionIdx]) - 1);
+  }
+}
+//
+// original formatter - Arduino String += float is dtostrf(2 decimals) then a heap append
+//
+std::string OriginalFormat(const BenchCar& car, const char* timeStr)
+{
+  char outStr[255];
+  char floatStr[33];
+  sprintf(outStr, "%s;%s;%d;%d", timeStr, car.carName, car.tireCount, car.positionCount);
+  std::string fileLine = outStr;
+  for(int idx = 0; idx < car.tireCount * car.positionCount; idx++)
+  {
+    fileLine += ';';
+    snprintf(floatStr, sizeof(floatStr), "%.2f", tireTemps[idx]);
+    fileLine += std::string(floatStr);
+  }
+  for(int idx = 0; idx < car.tireCount; idx++)
+  {
+    fileLine += ';';
+    fileLine += car.tireShortName[idx];
+  }
+  for(int idx = 0; idx < car.positionCount; idx++)
+  {
+    fileLine += ';';
+    fileLine += car.positionShortName[idx];
+  }
+  for(int idx = 0; idx < car.tireCount; idx++)
+  {
+    fileLine += ';';
+    snprintf(floatStr, sizeof(floatStr), "%.2f", car.maxTemp[idx]);
+    fileLine += std::string(floatStr);
+  }
+  return fileLine;
+}
+int CodecFormat(const BenchCar& car, const char* timeStr, char* out, int outSize)
+{
+  MeasureRecord record;
+  record.dateTime = timeStr;
+  record.epochMs = 0;
+  record.hasReadingTimes = false;
+  record.hasFlags = false;
+  record.legacyTemps = false;
+  record.carName = car.carName;
+  record.tireCount = car.tireCount;
+  record.positionCount = car.positionCount;
+  memcpy(record.temps, tireCenti, car.tireCount * car.positionCount * sizeof(TempCenti));
+  for(int idx = 0; idx < car.tireCount; idx++)
+  {
+    record.tireNames[idx] = car.tireShortName[idx];
+    record.maxTemps[idx] = Temp_FromC(car.maxTemp[idx]);
+  }
+  for(int idx = 0; idx < car.positionCount; idx++)
+  {
+    record.positionNames[idx] = car.positionShortName[idx];
+  }
+  return Record_Format(record, out, outSize);
+}
+
+int main()
+{
+  const int iterations = 200000;
+  const char* sample = "07:08:12PM 09/05/2023;Jody P34;6;3;77.56;77.67;77.67;77.56;77.45;77.67;77.56;77.56;77.56;77.56;77.56;77.45;-3.25;0.00;0.00;177.56;77.56;77.56;RF;RM;LF;LM;LR;RR;O;M;I;150.00;150.00;150.00;150.00;175.50;175.50";
+  char line[RECORD_LINE_SIZE];
+  BenchCar car;
+  memset(&car, 0, sizeof(car));
+  double checksum = 0;
+
+  // parse both ways, results must match (codec temps in hundredths)
+  BenchCar originalCar;
+  memset(&originalCar, 0, sizeof(originalCar));
+  strcpy(line, sample);
+  OriginalParse(line, originalCar);
+  strcpy(line, sample);
+  CodecParse(line, car);
+  bool isSame = true;
+  for(int idx = 0; idx < car.tireCount * car.positionCount; idx++)
+  {
+    isSame = isSame && (lroundf(tireTemps[idx] * 100.0f) == tireCenti[idx]);
+  }
+  for(int idx = 0; idx < car.tireCount; idx++)
+  {
+    isSame = isSame && (fabsf(originalCar.maxTemp[idx] - car.maxTemp[idx]) < 0.005f);
+    originalCar.maxTemp[idx] = car.maxTemp[idx];
+  }
+  if(!isSame || (memcmp(&car, &originalCar, sizeof(car)) != 0))
+  {
+    printf("parse mismatch\n");
+    return 1;
+  }
+  // older record in F - decimal temps convert to C, not measured stays 0
+  MeasureRecord legacyRecord;
+  strcpy(line, sample);
+  Record_Parse(line, legacyRecord);
+  Record_LegacyToC(legacyRecord, false);
+  for(int idx = 0; idx < car.tireCount * car.positionCount; idx++)
+  {
+    TempCenti expected = tireCenti[idx] == 0 ? 0 : Temp_FromDisplay(tireCenti[idx] / 100.0f, false);
+    if((legacyRecord.temps[idx] != expected) || legacyRecord.legacyTemps)
+    {
+      printf("legacy conversion mismatch at %d: %d, expected %d\n", idx, legacyRecord.temps[idx], expected);
+      return 1;
+    }
+  }
+  // codec line reads back the same
+  char codecCopy[RECORD_LINE_SIZE];
+  MeasureRecord codecRecord;
+  CodecFormat(car, "07:08:12PM 09/05/2023", line, sizeof(line));
+  strcpy(codecCopy, line);
+  if(!Record_Parse(codecCopy, codecRecord) || codecRecord.legacyTemps ||
+     (memcmp(codecRecord.temps, tireCenti, sizeof(TempCenti) * car.tireCount * car.positionCount) != 0))
+  {
+    printf("format mismatch\n%s\n", line);
+    return 1;
+  }
+
+  // epoch time record with reading and settle times survives a format/parse round trip
+  MeasureRecord timedRecord;
+  strcpy(line, sample);
+  Record_Parse(line, timedRecord);
+  timedRecord.epochMs = 1725562092000ULL;
+  timedRecord.hasReadingTimes = true;
+  timedRecord.hasFlags = true;
+  for(int idx = 0; idx < timedRecord.tireCount * timedRecord.positionCount; idx++)
+  {
+    timedRecord.readingMs[idx] = (idx == 5) ? 0 : timedRecord.epochMs - 90000 + (idx * 1250);
+    timedRecord.settleMs[idx] = (idx == 5) ? 0 : 800 + idx;
+    timedRecord.flags[idx] = (idx == 7) ? RECORD_FLAG_ESTIMATE : 0;
+  }
+  char timedLine[RECORD_LINE_SIZE];
+  char timedCopy[RECORD_LINE_SIZE];
+  Record_Format(timedRecord, timedLine, sizeof(timedLine));
+  strcpy(timedCopy, timedLine);
+  MeasureRecord parsedRecord;
+  if(!Record_Parse(timedCopy, parsedRecord) || !parsedRecord.hasReadingTimes || (parsedRecord.epochMs != timedRecord.epochMs) ||
+     (memcmp(parsedRecord.readingMs, timedRecord.readingMs, sizeof(uint64_t) * timedRecord.tireCount * timedRecord.positionCount) != 0) ||
+     (memcmp(parsedRecord.settleMs, timedRecord.settleMs, sizeof(uint32_t) * timedRecord.tireCount * timedRecord.positionCount) != 0) ||
+     !parsedRecord.hasFlags || (memcmp(parsedRecord.flags, timedRecord.flags, timedRecord.tireCount * timedRecord.positionCount) != 0))
+  {
+    printf("timed record mismatch\n%s\n", timedLine);
+    return 1;
+  }
+
+  auto startTime = std::chrono::steady_clock::now();
+  for(int idx = 0; idx < iterations; idx++)
+  {
+    strcpy(line, sample);
+    OriginalParse(line, car);
+    checksum += tireTemps[idx % 18];
+  }
+  auto originalParseTime = std::chrono::steady_clock::now() - startTime;
+  startTime = std::chrono::steady_clock::now();
+  for(int idx = 0; idx < iterations; idx++)
+  {
+    strcpy(line, sample);
+    CodecParse(line, car);
+    checksum += tireCenti[idx % 18];
+  }
+  auto codecParseTime = std::chrono::steady_clock::now() - startTime;
+  startTime = std::chrono::steady_clock::now();
+  for(int idx = 0; idx < iterations; idx++)
+  {
+    checksum += OriginalFormat(car, "07:08:12PM 09/05/2023").size();
+  }
+  auto originalFormatTime = std::chrono::steady_clock::now() - startTime;
+  startTime = std::chrono::steady_clock::now();
+  for(int idx = 0; idx < iterations; idx++)
+  {
+    checksum += CodecFormat(car, "07:08:12PM 09/05/2023", line, sizeof(line));
+  }
+  auto codecFormatTime = std::chrono::steady_clock::now() - startTime;
+
+  auto perRecord = [iterations](std::chrono::steady_clock::duration elapsed)
+  {
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+  };
+  printf("parse   original %8.1f ns/record  codec %8.1f ns/record\n", perRecord(originalParseTime), perRecord(codecParseTime));
+  printf("format  original %8.1f ns/record  codec %8.1f ns/record\n", perRecord(originalFormatTime), perRecord(codecFormatTime));
+  printf("(checksum %g)\n", checksum);
+  return 0;
+}
@@ -0,0 +1,361 @@
+/*
+  YamuraLog Recording Tire Pyrometer
+  host benchmark - replays probe traces through the stable temp detectors (PyroStable.h) the way
+  GetStableTemp runs them and scores each method and setting
+
+  build and run from the sketch folder:
+    g++ -O2 -std=c++11 -o stable_replay tools/stable_replay.cpp && ./stable_replay [py_trace.bin ...]
+
+  synthetic traces (always run): probe lagging the tread temp (first order, time constant tau)
+  from ambient, gaussian reading noise and amplifier resolution, settling traces where the tread
+  holds a plateau and drifting traces where the tread cools while it is measured
+  recorded traces (py_trace.bin from the device): the plateau is the mean of the last samples,
+  settings sampling faster than the trace was recorded are skipped, a trace that ends before
+  the detector is stable counts as no result
+
+  per method and setting:
+    time     mean and 90th percentile seconds from arming to a reading (timeouts included)
+    error    mean |reading - plateau| of readings taken stable
+    false    stable readings more than FALSE_STABLE_ERROR from the plateau, percent of traces
+    timeout  traces that reached STABLE_TIMEOUT_MS (best estimate reading), percent of traces
+  the device defaults are marked with '*'
+*/
+#include <stdio.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "../PyroStable.h"
+#include "../PyroTrace.h"
+
+#define FALSE_STABLE_ERROR  1.0f                  // degrees from the plateau
+#define AMP_RESOLUTION_F    0.1125f               // 18 bit MCP960x, 0.0625C
+#define SIM_STEP_SEC        0.01f                 // synthetic probe model step
+#define SIM_LENGTH_SEC      40.0f                 // longer than STABLE_TIMEOUT_MS
+#define PLATEAU_SAMPLES     5                     // recorded trace tail averaged for the plateau
+
+// one probe trace, display units (F)
+struct ProbeTrace
+{
+  std::vector<float> timeSec;
+  std::vector<float> temp;
+  std::vector<float> truth;                   // tread temp at each sample (plateau)
+  unsigned long recordedDelay;                // ms between recorded samples, 0 for synthetic
+  float seed;                                 // value the band window starts full of
+};
+// detector settings under test
+struct StableConfig
+{
+  int method;
+  float band;                                 // stableBand[1], stableBand[0] is -band
+  unsigned long delay;                        // stableDelay ms
+  int buffer;                                 // stableBuffer samples
+  float slope;                                // stableSlope
+  float kalmanNoise;
+  float kalmanRate;
+};
+// outcome of one replay
+struct ReplayResult
+{
+  bool valid;                                 // false if the trace ended first
+  bool stable;                                // false for a timeout estimate
+  float timeSec;
+  float temp;
+  float truth;
+};
+// scores for a config over a set of traces
+struct ConfigScore
+{
+  int runs = 0;
+  int stableCount = 0;
+  int falseCount = 0;
+  int timeoutCount = 0;
+  double errorSum = 0.0;
+  std::vector<float> times;
+};
+
+const char* methodNames[] = {"band", "slope", "kalman"};
+
+//
+// synthetic probe - tread at plateau (minus driftPerSec * t), probe lags with time constant tau
+//
+ProbeTrace MakeTrace(float ambient, float plateau, float tau, float noiseSigma, float driftPerSec, std::mt19937& rng)
+{
+  ProbeTrace trace;
+  std::normal_distribution<float> noise(0.0f, noiseSigma);
+  float probe = ambient;
+  trace.recordedDelay = 0;
+  trace.seed = 60.0f;
+  for(float timeSec = 0.0f; timeSec < SIM_LENGTH_SEC; timeSec += SIM_STEP_SEC)
+  {
+    float tread = plateau - (driftPerSec * timeSec);
+    probe += (tread - probe) * (SIM_STEP_SEC / tau);
+    float reading = probe + noise(rng);
+    trace.timeSec.push_back(timeSec);
+    trace.temp.push_back(roundf(reading / AMP_RESOLUTION_F) * AMP_RESOLUTION_F);
+    trace.truth.push_back(tread);
+  }
+  return trace;
+}
+//
+// the standard synthetic set, settling and drifting
+//
+std::vector<ProbeTrace> SyntheticTraces()
+{
+  std::vector<ProbeTrace> traces;
+  std::mt19937 rng(1234);
+  const float plateaus[] = {120.0f, 160.0f, 200.0f};
+  const float taus[] = {1.0f, 3.0f, 8.0f};
+  const float noises[] = {0.05f, 0.25f};
+  const float drifts[] = {0.0f, 0.05f};
+  for(float plateau : plateaus)
+  {
+    for(float tau : taus)
+    {
+      for(float noiseSigma : noises)
+      {
+        for(float drift : drifts)
+        {
+          for(int repeat = 0; repeat < 3; repeat++)
+          {
+            traces.push_back(MakeTrace(70.0f, plateau, tau, noiseSigma, drift, rng));
+          }
+        }
+      }
+    }
+  }
+  return traces;
+}
+//
+// positions from a device trace file, hot junction converted to the units it was measured in
+//
+bool LoadTraceFile(const char* path, std::vector<ProbeTrace>& traces)
+{
+  FILE* file = fopen(path, "rb");
+  if(file == NULL)
+  {
+    fprintf(stderr, "can't open %s\n", path);
+    return false;
+  }
+  std::vector<uint8_t> data;
+  uint8_t block[4096];
+  size_t count;
+  while((count = fread(block, 1, sizeof(block), file)) > 0)
+  {
+    data.insert(data.end(), block, block + count);
+  }
+  fclose(file);
+  TraceHeader header;
+  if(data.size() < sizeof(header))
+  {
+    return false;
+  }
+  memcpy(&header, data.data(), sizeof(header));
+  if((header.magic != TRACE_MAGIC) || (header.version != TRACE_VERSION))
+  {
+    fprintf(stderr, "%s: not a version %d trace file\n", path, TRACE_VERSION);
+    return false;
+  }
+  ProbeTrace trace;
+  TraceStart start;
+  bool isStarted = false;
+  size_t pos = sizeof(header);
+  while(pos < data.size())
+  {
+    uint8_t type = data[pos];
+    size_t size = Trace_RecordSize(type);
+    if((size == 0) || (pos + size > data.size()))
+    {
+      break;
+    }
+    if(type == TRACE_START)
+    {
+      memcpy(&start, &data[pos], sizeof(start));
+      trace = ProbeTrace();
+      trace.recordedDelay = start.stableDelay;
+      trace.seed = start.tempUnits ? 15.0f : 60.0f;
+      isStarted = true;
+    }
+    else if((type == TRACE_SAMPLE) && isStarted)
+    {
+      TraceSample sample;
+      memcpy(&sample, &data[pos], sizeof(sample));
+      if(!isnan(sample.hot))
+      {
+        trace.timeSec.push_back(sample.timeMs / 1000.0f);
+        trace.temp.push_back(start.tempUnits ? sample.hot : (sample.hot * 1.8f) + 32.0f);
+      }
+    }
+    else if((type == TRACE_END) && isStarted)
+    {
+      isStarted = false;
+      // too short to tell where it settled
+      if(trace.temp.size() >= PLATEAU_SAMPLES)
+      {
+        float plateau = 0.0f;
+        for(size_t idx = trace.temp.size() - PLATEAU_SAMPLES; idx < trace.temp.size(); idx++)
+        {
+          plateau += trace.temp[idx];
+        }
+        plateau /= PLATEAU_SAMPLES;
+        trace.truth.assign(trace.temp.size(), plateau);
+        traces.push_back(trace);
+      }
+    }
+    pos += size;
+  }
+  return true;
+}
+//
+// run a trace through a detector at the config's sample period (Stable_Replay, same as GetStableTemp)
+//
+ReplayResult Replay(const ProbeTrace& trace, const StableConfig& config)
+{
+  // first trace sample at or after each sample deadline
+  std::vector<float> times;
+  std::vector<float> temps;
+  std::vector<size_t> sampleIdxs;
+  size_t sampleIdx = 0;
+  for(unsigned long deadlineMs = 0; ; deadlineMs += config.delay)
+  {
+    float deadlineSec = deadlineMs / 1000.0f;
+    while((sampleIdx < trace.timeSec.size()) && (trace.timeSec[sampleIdx] < deadlineSec - 0.0005f))
+    {
+      sampleIdx++;
+    }
+    if(sampleIdx >= trace.timeSec.size())
+    {
+      break;
+    }
+    times.push_back(trace.timeSec[sampleIdx]);
+    temps.push_back(trace.temp[sampleIdx]);
+    sampleIdxs.push_back(sampleIdx);
+  }
+  StableParams params = {config.method, config.buffer, -config.band, config.band, config.slope,
+                         config.kalmanNoise, config.kalmanRate, trace.seed};
+  ReplayResult result;
+  int lastIdx;
+  int status = times.empty() ? REPLAY_ENDED : Stable_Replay(times.data(), temps.data(), times.size(), 1, params, result.temp, lastIdx);
+  result.valid = status != REPLAY_ENDED;
+  result.stable = status == REPLAY_STABLE;
+  if(result.valid)
+  {
+    result.timeSec = times[lastIdx];
+    result.truth = trace.truth[sampleIdxs[lastIdx]];
+  }
+  return result;
+}
+//
+// replay every trace through a config
+//
+ConfigScore Score(const std::vector<ProbeTrace>& traces, const StableConfig& config)
+{
+  ConfigScore score;
+  for(const ProbeTrace& trace : traces)
+  {
+    if((trace.recordedDelay != 0) && (config.delay < trace.recordedDelay))
+    {
+      continue;
+    }
+    ReplayResult result = Replay(trace, config);
+    if(!result.valid)
+    {
+      continue;
+    }
+    score.runs++;
+    score.times.push_back(result.timeSec);
+    if(!result.stable)
+    {
+      score.timeoutCount++;
+      continue;
+    }
+    float error = fabsf(result.temp - result.truth);
+    score.stableCount++;
+    score.errorSum += error;
+    score.falseCount += error > FALSE_STABLE_ERROR ? 1 : 0;
+  }
+  return score;
+}
+//
+// methods x settings grid, defaults from DeviceSettings included
+//
+std::vector<StableConfig> ConfigGrid()
+{
+  std::vector<StableConfig> configs;
+  const float bands[] = {0.25f, 0.5f, 1.0f};
+  const unsigned long delays[] = {250, 500, 1000};
+  const int buffers[] = {5, 10, 20};
+  const float slopes[] = {0.02f, 0.05f, 0.1f};
+  for(unsigned long delay : delays)
+  {
+    for(float band : bands)
+    {
+      for(int buffer : buffers)
+      {
+        configs.push_back({STABLE_BAND, band, delay, buffer, 0.05f, 0.25f, 0.05f});
+      }
+    }
+    for(float slope : slopes)
+    {
+      for(int buffer : buffers)
+      {
+        configs.push_back({STABLE_SLOPE, 0.25f, delay, buffer, slope, 0.25f, 0.05f});
+      }
+    }
+    for(float band : bands)
+    {
+      for(float slope : slopes)
+      {
+        configs.push_back({STABLE_KALMAN, band, delay, 10, slope, 0.25f, 0.05f});
+      }
+    }
+  }
+  std::stable_sort(configs.begin(), configs.end(), [](const StableConfig& a, const StableConfig& b) { return a.method < b.method; });
+  return configs;
+}
+//
+// one table of scores
+//
+void Report(const char* title, const std::vector<ProbeTrace>& traces)
+{
+  printf("\n%s (%zu traces)\n", title, traces.size());
+  printf("  method  band  delay buffer slope   runs  time mean/p90 s  error   false  timeout\n");
+  for(const StableConfig& config : ConfigGrid())
+  {
+    ConfigScore score = Score(traces, config);
+    bool isDefault = (config.band == 0.25f) && (config.delay == 500) && (config.buffer == 10) && (config.slope == 0.05f);
+    if(score.runs == 0)
+    {
+      printf("%c %-6s %5.2f %6lu %6d %5.2f      -\n", isDefault ? '*' : ' ', methodNames[config.method],
+             config.band, config.delay, config.buffer, config.slope);
+      continue;
+    }
+    std::sort(score.times.begin(), score.times.end());
+    double timeSum = 0.0;
+    for(float timeSec : score.times)
+    {
+      timeSum += timeSec;
+    }
+    float p90 = score.times[std::min(score.times.size() - 1, (score.times.size() * 9) / 10)];
+    printf("%c %-6s %5.2f %6lu %6d %5.2f %6d  %6.1f %6.1f  %7.3f %6.1f%% %6.1f%%\n", isDefault ? '*' : ' ', methodNames[config.method],
+           config.band, config.delay, config.buffer, config.slope, score.runs,
+           timeSum / score.times.size(), p90,
+           score.stableCount > 0 ? score.errorSum / score.stableCount : 0.0,
+           (100.0 * score.falseCount) / score.runs, (100.0 * score.timeoutCount) / score.runs);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  std::vector<ProbeTrace> synthetic = SyntheticTraces();
+  Report("synthetic traces", synthetic);
+  std::vector<ProbeTrace> recorded;
+  for(int argIdx = 1; argIdx < argc; argIdx++)
+  {
+    LoadTraceFile(argv[argIdx], recorded);
+  }
+  if(!recorded.empty())
+  {
+    Report("recorded traces", recorded);
+  }
+  return 0;
+}
@@ -0,0 +1,103 @@
+/*
+  YamuraLog Recording Tire Pyrometer
+  host decoder - raw sample trace (py_trace.bin, see PyroTrace.h) to comma separated text
+
+  build and run from the sketch folder:
+    g++ -O2 -std=c++11 -o trace_decode tools/trace_decode.cpp && ./trace_decode py_trace.bin > trace.csv
+
+  one line per sample:
+    car,reading,time_ms,hot_c,cold_c,status
+  each position starts with a "# start" line holding the stable temp settings and ends with a
+  "# end" line holding the result, a position cut off by power loss has no "# end" line
+*/
+#include <stdio.h>
+#include <vector>
+#include "../PyroTrace.h"
+
+const char* methodNames[] = {"band", "slope", "kalman"};
+const char* resultNames[] = {"stable", "estimate", "fault"};
+
+int main(int argc, char* argv[])
+{
+  if(argc < 2)
+  {
+    fprintf(stderr, "usage: %s py_trace.bin\n", argv[0]);
+    return 1;
+  }
+  FILE* file = fopen(argv[1], "rb");
+  if(file == NULL)
+  {
+    fprintf(stderr, "can't open %s\n", argv[1]);
+    return 1;
+  }
+  std::vector<uint8_t> data;
+  uint8_t block[4096];
+  size_t count;
+  while((count = fread(block, 1, sizeof(block), file)) > 0)
+  {
+    data.insert(data.end(), block, block + count);
+  }
+  fclose(file);
+
+  TraceHeader header;
+  if(data.size() < sizeof(header))
+  {
+    fprintf(stderr, "%s: too short for a trace file\n", argv[1]);
+    return 1;
+  }
+  memcpy(&header, data.data(), sizeof(header));
+  if((header.magic != TRACE_MAGIC) || (header.version != TRACE_VERSION))
+  {
+    fprintf(stderr, "%s: not a version %d trace file\n", argv[1], TRACE_VERSION);
+    return 1;
+  }
+  printf("car,reading,time_ms,hot_c,cold_c,status\n");
+  TraceStart start;
+  memset(&start, 0, sizeof(start));
+  int positions = 0;
+  long samples = 0;
+  size_t pos = sizeof(header);
+  while(pos < data.size())
+  {
+    uint8_t type = data[pos];
+    size_t size = Trace_RecordSize(type);
+    if((size == 0) || (pos + size > data.size()))
+    {
+      // torn write at the end of the file, or not a record
+      fprintf(stderr, "%s: stopped at offset %zu (type %d)\n", argv[1], pos, type);
+      break;
+    }
+    if(type == TRACE_START)
+    {
+      memcpy(&start, &data[pos], sizeof(start));
+      printf("# start car %d reading %d (tire %d position %d) epoch_ms %llu method %s band %.2f..%.2f slope %.3f"
+             " kalman %.3f/%.3f delay %u buffer %u units %s\n",
+             start.carID, start.tempIdx,
+             start.positionCount > 0 ? start.tempIdx / start.positionCount : 0,
+             start.positionCount > 0 ? start.tempIdx % start.positionCount : 0,
+             (unsigned long long)start.epochMs, start.method < 3 ? methodNames[start.method] : "?",
+             start.stableBand[0], start.stableBand[1], start.stableSlope, start.kalmanNoise, start.kalmanRate,
+             start.stableDelay, start.stableBuffer, start.tempUnits ? "C" : "F");
+      positions++;
+    }
+    else if(type == TRACE_SAMPLE)
+    {
+      TraceSample sample;
+      memcpy(&sample, &data[pos], sizeof(sample));
+      printf("%d,%d,%u,%.4f,%.2f,0x%02x\n", start.carID, start.tempIdx, sample.timeMs, sample.hot,
+             sample.coldCenti / 100.0, sample.status);
+      samples++;
+    }
+    else
+    {
+      TraceEnd end;
+      memcpy(&end, &data[pos], sizeof(end));
+      printf("# end car %d reading %d time_ms %u result %s fault %d temp %.2f dropped %u\n",
+             start.carID, start.tempIdx, end.timeMs, end.result < 3 ? resultNames[end.result] : "?",
+             end.fault, end.temp, end.dropped);
+    }
+    pos += size;
+  }
+  fprintf(stderr, "%d positions, %ld samples\n", positions, samples);
+  return 0;
+}